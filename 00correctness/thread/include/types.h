@@ -0,0 +1,388 @@
+/*
+ * SortMatching
+ * Copyright 2012 Marco Mandrioli
+ *
+ * This file is part of SortMatching.
+ *
+ * SortMatching is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SortMatching is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with SortMatching.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __TYPES_H
+#define __TYPES_H
+
+
+/* This set of headers is put before everything else because pthread.h requires it, otherwise its behaviour can be undefined.
+*/
+#ifdef _MSC_VER
+#include <process.h>
+#include <Windows.h>
+
+#define THREAD_T HANDLE
+#define LOCK_T CRITICAL_SECTION
+#define COND_T CONDITION_VARIABLE
+#else // _MSC_VER
+#define _MULTI_THREADED
+#include <pthread.h>
+
+#define THREAD_T pthread_t
+#define LOCK_T pthread_mutex_t
+#define COND_T pthread_cond_t
+#endif // _MSC_VER
+
+#include <stdint.h>
+
+#include "defines.h"
+
+
+/** \file types.h
+\brief Data types definitions.
+
+This file contains all the data types definitions. The simple types are to avoid different data sizes on different platforms.
+*/
+
+
+/* Data types */
+#define _BOOL		uint_fast8_t
+#define _BYTE		uint8_t
+#define _UINT		uint32_t
+#define _INT		int32_t
+
+
+/** \brief Data type of endpoints coordinates.
+*/
+#define SPACE_TYPE_SELECT	4
+/*
+ * 1	int32_t
+ * 2	int64_t
+ * 3	float
+ * 4	double
+*/
+
+
+/* Defines min, max and minimum increment of the active SPACE_TYPE */
+#if SPACE_TYPE_SELECT == 1
+#define SPACE_TYPE		int32_t
+#define SPACE_TYPE_MIN	INT32_MIN
+#define SPACE_TYPE_MAX	INT32_MAX
+#define SPACE_TYPE_INC	1
+#elif SPACE_TYPE_SELECT == 2
+#define SPACE_TYPE		int64_t
+#define SPACE_TYPE_MIN	INT64_MIN
+#define SPACE_TYPE_MAX	INT64_MAX
+#define SPACE_TYPE_INC	1
+#elif SPACE_TYPE_SELECT == 3
+#include <float.h>
+#define SPACE_TYPE		float
+#define SPACE_TYPE_MIN	FLT_MIN
+#define SPACE_TYPE_MAX	FLT_MAX
+#define SPACE_TYPE_INC	FLT_EPSILON
+#elif SPACE_TYPE_SELECT == 4
+#include <float.h>
+#define SPACE_TYPE		double
+#define SPACE_TYPE_MIN	FLT_MIN
+#define SPACE_TYPE_MAX	FLT_MAX
+#define SPACE_TYPE_INC	DBL_EPSILON
+#endif // SPACE_TYPE
+
+
+/** \brief An element of the bit vector used for storing the matches.
+*/
+#if BITVEC_ELEM_BITS == 64
+typedef uint64_t			bitvec_elem;
+#else // BITVEC_ELEM_BITS
+typedef uint32_t			bitvec_elem;
+#endif // BITVEC_ELEM_BITS
+
+
+/** \brief The bit vector used for storing the matches.
+
+The bit vector is generally used only for allocating the bit matrix.
+*/
+typedef bitvec_elem*	bitvector;
+
+
+/** \brief The bit matrix used for storing the matches.
+
+The lines of the bit matrix correspond to the update extents, while the single bits on each line represent the subscription extents. The rows are stored in a single block, each one stride elements after the previous one, so that a row is reached without loading a pointer; the rows are aligned to BITMATRIX_ALIGNMENT bytes and the stride is padded to avoid BITMATRIX_ALIAS_STRIDE.
+*/
+typedef struct
+{
+	bitvector	base;				///< first element of the first row
+	_UINT		rows;				///< number of rows
+	_UINT		width;				///< number of elements of each row holding bits (BIT_VEC_WIDTH() of the columns)
+	_UINT		stride;				///< number of elements between the starts of two consecutive rows
+	_UINT		alignment;			///< alignment of the rows in bytes
+} bitmatrix;
+
+
+/** \brief The endpoints of an extent in a given dimension.
+*/
+typedef struct
+{
+	SPACE_TYPE	lower;		///< lower bound point
+	SPACE_TYPE	upper;		///< upper bound point
+} endpoints_t;
+
+
+/** \brief The structure representing an extent.
+
+Each element of the array represents a dimension.
+*/
+typedef struct
+{
+	_UINT		id;								///< identifier of the extent
+	endpoints_t endpoints[MAX_DIMENSIONS];		///< array containing the endpoints of the extent for each dimension
+} extent_t;
+
+
+/** \brief The problem data set.
+
+This structures contains all the data needed for the matching algorithm to check the matches.
+*/
+typedef struct
+{
+	_UINT		dimensions;			///< number of dimensions
+
+	extent_t	*update;			///< array containing update extents data
+	_UINT		size_update;		///< number of update extents
+	
+	extent_t	*subscr;			///< array containing subscription extents data
+	_UINT		size_subscr;		///< number of subscription extents
+} match_data_t;
+
+
+/** \brief An element of the list of endpoints.
+
+The identifier goes from 0 to size_subscr - 1 for subscriptions and from size_subscr to size_subscr + size_update - 1 for updates.
+
+\remarks The identifiers are kept on 32 bits, so that an endpoint still takes 16 bytes at most for the sort; the data sets are limited to MAX_EXTENTS extents accordingly.
+*/
+typedef struct
+{
+	_UINT		id;					///< identifier of the extent this endpoint belongs to
+	_BOOL		is_lower_point;		///< is this the lower bound point of the extent?
+	SPACE_TYPE	point;				///< position of the point in space
+} list_t;
+
+
+/** \brief Type definition for list_t pointer.
+*/
+typedef list_t* list_ptr;
+
+
+/** \brief The matching pairs stored as compressed sparse rows.
+
+The subscription extents matching the update extent i are subscr[first[i]] ... subscr[first[i + 1] - 1].
+*/
+typedef struct
+{
+	_UINT		size_update;		///< number of update extents (rows)
+	size_t		count;				///< number of matching pairs
+	size_t		*first;				///< position in subscr of the first match of each update extent (size_update + 1 elements)
+	_UINT		*subscr;			///< identifiers of the matching subscription extents, row after row
+} match_csr_t;
+
+
+/** \brief Iterator on the matching subscription extents of an update extent.
+
+The subscription extents are visited in ascending order, one set bit of the row at a time.
+*/
+typedef struct
+{
+	bitvector	line;				///< row of the update extent
+	_UINT		size_subscr;		///< number of subscription extents (columns of the row)
+	_UINT		last;				///< one past the last element of the row holding columns
+	_UINT		elem;				///< element of the row holding the bits of val
+	bitvec_elem	val;				///< bits of the element not visited yet
+} match_iter_t;
+
+
+/** \brief Enum for the algorithms used to sort the list of endpoints.
+*/
+typedef enum
+{
+	sort_qsort					= 0,
+	sort_radix					= 1
+} sort_algo_t;
+
+
+/** \brief Enum for the instruction sets of the bitwise kernels.
+*/
+typedef enum
+{
+	simd_auto					= 0,
+	simd_scalar					= 1,
+	simd_sse2					= 2,
+	simd_avx2					= 3,
+	simd_avx512					= 4
+} simd_t;
+
+
+/** \brief Enum for the ways the sweep is split among the threads.
+*/
+typedef enum
+{
+	sweep_dimensions			= 0,
+	sweep_columns				= 1,
+	sweep_segments				= 2,
+	sweep_tasks					= 3
+} sweep_t;
+
+
+/** \brief Enum for the pages of the big allocations.
+*/
+typedef enum
+{
+	pages_default				= 0,
+	pages_thp					= 1,
+	pages_huge					= 2
+} pages_t;
+
+
+/** \brief Enum for the NUMA placement of the big allocations.
+*/
+typedef enum
+{
+	numa_default				= 0,
+	numa_interleave				= 1,
+	numa_owner					= 2
+} numa_t;
+
+
+/** \brief Structure containing the run-time options.
+
+The options are set once by the main function and read by the algorithm.
+*/
+typedef struct
+{
+	sort_algo_t	sort_algo;			///< algorithm used to sort the list of endpoints
+	simd_t		simd;				///< instruction set of the bitwise kernels (simd_auto for the best one supported by the processor)
+	_UINT		threads;			///< number of threads (0 for one thread for each processor)
+	sweep_t		sweep;				///< how the sweep is split among the threads (default: one thread for each dimension)
+	_BOOL		transpose;			///< also build the subscription-major matrix of the result
+	_BOOL		csr;				///< also export the result as compressed sparse rows
+	pages_t		pages;				///< pages of the big allocations (default, transparent huge pages or explicit huge pages)
+	_BOOL		prefault;			///< touch all the pages of the big allocations when they are allocated
+	numa_t		numa;				///< NUMA placement of the big allocations
+	_UINT		seed;				///< seed of the random data set (0 for the default one)
+} _opt_t;
+
+
+/** \brief Enum for error codes.
+*/
+typedef enum 
+{
+	err_none					= 0,
+	err_unhandled				= 1,
+	err_generic					= 2,
+	err_alloc					= 3,
+	err_file					= 4,
+	err_invalid_input			= 5,
+	err_too_many_dim			= 6,
+	err_threads					= 7,
+	err_opencl					= 8,
+	err_opencl_device_not_found	= 9,
+	err_opencl_file				= 10,
+	err_too_many_ext			= 11
+} _ERR_CODE;
+
+
+/** \brief Structure containing error data.
+*/
+typedef struct
+{
+	_ERR_CODE code;						///< error code
+	char file[FILE_NAME_SIZE];			///< file who generated the error
+	char function[FUNCTION_NAME_SIZE];	///< function who generated the error
+	_UINT line;							///< line of the file who generated the error
+} _err_t;
+
+
+struct scheduler_s;
+
+
+/** \brief Routine of a task of the scheduler.
+
+\param sched the scheduler running the task
+\param worker the index of the worker running the task
+\param arg the argument of the task
+
+\retval error code
+*/
+typedef _ERR_CODE (*task_routine_t)(struct scheduler_s *sched, const _UINT worker, void *arg);
+
+
+/** \brief Group of tasks waited for together.
+*/
+typedef struct
+{
+	_UINT			pending;		///< tasks of the group submitted and not finished yet
+	_ERR_CODE		err;			///< first error returned by a task of the group
+} task_group_t;
+
+
+/** \brief A task of the scheduler.
+*/
+typedef struct
+{
+	task_routine_t	routine;		///< routine of the task
+	void			*arg;			///< argument of the routine
+	task_group_t	*group;			///< group of the task
+} task_t;
+
+
+/** \brief Double-ended queue of the tasks of a worker.
+
+The owner pushes and pops the tasks at the tail, the other workers steal them from the head.
+*/
+typedef struct
+{
+	task_t			*tasks;			///< array of the tasks
+	_UINT			head;			///< first task in the queue
+	_UINT			tail;			///< one past the last task in the queue
+	_UINT			capacity;		///< size of the array of the tasks
+	LOCK_T			lock;			///< lock of the queue
+} task_deque_t;
+
+
+/** \brief Arguments of a worker thread of the scheduler.
+*/
+typedef struct
+{
+	struct scheduler_s	*sched;		///< the scheduler
+	_UINT			index;			///< index of the worker
+} worker_params;
+
+
+/** \brief Work-stealing scheduler.
+
+Each worker runs the tasks of its own queue and, when it's empty, steals the oldest task of the queue of another worker. The workers are started once and reused by all the parallel steps.
+*/
+typedef struct scheduler_s
+{
+	_UINT			workers;		///< number of workers
+	THREAD_T		thread[MAX_THREADS];	///< worker threads
+	worker_params	params[MAX_THREADS];	///< arguments of the worker threads
+	task_deque_t	deque[MAX_THREADS];		///< task queues (one for each worker)
+	LOCK_T			lock;			///< lock of the counters, of the groups and of the stop flag
+	COND_T			cond;			///< signalled when a task is queued, when a group is done or when the workers must stop
+	_UINT			queued;			///< tasks in the queues
+	_UINT			next;			///< queue of the next task submitted from outside the workers
+	_BOOL			stop;			///< the workers must stop
+} scheduler_t;
+
+
+#endif // __TYPES_H
@@ -0,0 +1,72 @@
+/*
+ * SortMatching
+ * Copyright 2012 Marco Mandrioli
+ *
+ * This file is part of SortMatching.
+ *
+ * SortMatching is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SortMatching is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with SortMatching.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __UTILS_H
+#define __UTILS_H
+
+
+/** \file utils.h
+\brief Header of the file utils.c
+
+The file utils.c contains various utilities functions.
+*/
+
+
+/** \brief Global external options variable.
+*/
+extern _opt_t OPT_VAR;
+
+
+void *memory_alloc(const size_t size);
+void memory_free(void *ptr, const size_t size);
+size_t memory_physical();
+size_t bitmatrix_layout(bitmatrix *out, const bitvector base, const _UINT size_update, const _UINT size_subscr);
+_ERR_CODE create_bit_matrix(bitmatrix *out, const _UINT size_update, const _UINT size_subscr);
+void free_bit_matrix(bitmatrix *in);
+
+simd_t select_bitwise_kernels();
+void vector_bitwise_not(const bitvector vec, const size_t size);
+void vector_bitwise_or(const bitvector result, const bitvector mask, const size_t size);
+void vector_atomic_or(const bitvector result, const bitvector mask, const size_t size);
+
+void free_match_csr(match_csr_t *csr);
+void match_iter_init(match_iter_t *it, const bitmatrix m, const _UINT size_subscr, const _UINT update);
+_BOOL match_iter_next(match_iter_t *it, _UINT *subscr);
+
+void set_endpoints_range(const match_data_t data, const list_ptr out, const _UINT dimension, const _UINT first, const _UINT last);
+void set_endpoints_list(const match_data_t data, const list_ptr out, const _UINT dimension);
+
+void sort_list(const list_ptr ep_list, const _UINT size);
+
+_UINT get_cpu_count();
+_ERR_CODE parallel_set_endpoints_list(const match_data_t data, const list_ptr out, const _UINT dimension, const _UINT threads);
+_ERR_CODE parallel_sort_list(const list_ptr ep_list, const _UINT size, const _UINT threads);
+_ERR_CODE parallel_bitmatrix_transpose(const bitmatrix in, const bitmatrix out, const _UINT threads);
+_ERR_CODE parallel_bitmatrix_to_csr(const bitmatrix m, const _UINT size_subscr, match_csr_t *out, const _UINT threads);
+
+#ifdef __VERBOSE
+void print_bitmatrix(const bitmatrix in);
+void print_match_csr(const match_csr_t *in);
+#endif // __VERBOSE
+
+
+#endif // __UTILS_H
@@ -0,0 +1,389 @@
+/*
+ * SortMatching
+ * Copyright 2012 Marco Mandrioli
+ *
+ * This file is part of SortMatching.
+ *
+ * SortMatching is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SortMatching is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with SortMatching.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "../include/types.h"
+
+#include "../include/matching.h"
+#include "../include/test_generator.h"
+#include "../include/utils.h"
+#include "../include/scheduler.h"
+#include "../include/error.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef __TEST
+#ifdef _WIN32
+#include <time.h>
+#else // _WIN32
+#include <sys/time.h>
+#endif // _WIN32
+#endif // __TEST
+
+
+/** \mainpage
+\author Marco Mandrioli
+
+\section Intro1 Introdction
+
+\section Intro2 Version
+*/
+
+
+/**file main.c
+\brief File containing the main function.
+*/
+
+
+#ifndef _WIN32
+/** \brief Subtracts two timeval structures.
+
+Calculates the time difference between the two timeval structures as x - y.
+
+\param result pointer to the structure which is going to contain the result
+\param x first structure
+\param y second structure
+
+\retval 1 if x < y (result is negative)
+\retval 0 if x >= 0 (result is zero or positive)
+*/
+int timeval_subtract(struct timeval *result, struct timeval x, struct timeval y)
+{
+	int nsec;
+
+	/* Perform the carry for the later subtraction by updating y. */
+	if (x.tv_usec < y.tv_usec)
+	{
+		nsec = (y.tv_usec - x.tv_usec) / 1000000 + 1;
+		y.tv_usec -= 1000000 * nsec;
+		y.tv_sec += nsec;
+	}
+	if (x.tv_usec - y.tv_usec > 1000000)
+	{
+		nsec = (x.tv_usec - y.tv_usec) / 1000000;
+		y.tv_usec += 1000000 * nsec;
+		y.tv_sec -= nsec;
+	}
+	
+	// Compute the time remaining to wait. tv_usec is certainly positive.
+	result->tv_sec = x.tv_sec - y.tv_sec;
+	result->tv_usec = x.tv_usec - y.tv_usec;
+	
+	/* Return 1 if result is negative. */
+	return x.tv_sec < y.tv_sec;
+}
+#endif // _WIN32
+
+
+/** \brief Prints the usage of the program.
+
+\param prog_name the name of the executable
+*/
+void print_synopsis(const char *prog_name)
+{
+	printf("\nSYNOPSIS:\n\n");
+	printf("%s <updates> <subscriptions> <dimensions> [options]\n\n", FILENAME(prog_name));
+	printf("OPTIONS:\n\n");
+	printf("--sort=<radix|qsort>\talgorithm used to sort the endpoints (default: radix)\n");
+	printf("--simd=<scalar|sse2|avx2|avx512>\tinstruction set of the bitwise kernels (default: best supported)\n");
+	printf("--threads=<n>\t\tnumber of threads (default: one for each processor)\n");
+	printf("--csr\t\t\talso export the result as compressed sparse rows (the subscription extents matching each update)\n");
+	printf("--transpose\t\talso build the subscription-major matrix of the result (the update extents matching each subscription)\n");
+	printf("--sweep=<dimensions|columns|segments|tasks>\tone thread for each dimension, each thread on a range of columns of all the dimensions,\n\t\t\teach thread on a segment of the list of each dimension, or tasks on a work-stealing scheduler (default: dimensions)\n");
+	printf("--seed=<n>\t\tseed of the random data set, to generate the same data set at each run\n");
+	printf("--pages=<default|thp|huge>\tpages of the bit matrix: default, transparent huge pages or explicit huge pages (default: default)\n");
+	printf("--prefault\t\ttouch the pages of the bit matrix when it's allocated, before the timer starts\n");
+	printf("--numa=<default|interleave|owner>\tNUMA placement of the bit matrix: first touch, interleaved on all the nodes,\n\t\t\tor first touched by the workers, one band of rows each, before the timer starts (default: default)\n\n");
+}
+
+
+/** \brief Prints the memory options that differ from the default ones.
+
+\param fout the file
+*/
+void print_memory_options(FILE *fout)
+{
+	if (OPT_VAR.pages == pages_thp)
+		fprintf(fout, "\tpages=thp");
+	else if (OPT_VAR.pages == pages_huge)
+		fprintf(fout, "\tpages=huge");
+
+	if (OPT_VAR.prefault)
+		fprintf(fout, "\tprefault");
+
+	if (OPT_VAR.numa == numa_interleave)
+		fprintf(fout, "\tnuma=interleave");
+	else if (OPT_VAR.numa == numa_owner)
+		fprintf(fout, "\tnuma=owner");
+}
+
+
+/** \brief Parses the optional arguments and sets the global options.
+
+\param argc the number of optional arguments
+\param argv the array of optional arguments
+
+\retval error code
+*/
+_ERR_CODE parse_options(const int argc, char *argv[])
+{
+	int i;
+
+	for (i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--sort=radix") == 0)
+			OPT_VAR.sort_algo = sort_radix;
+		else if (strcmp(argv[i], "--sort=qsort") == 0)
+			OPT_VAR.sort_algo = sort_qsort;
+		else if (strcmp(argv[i], "--simd=scalar") == 0)
+			OPT_VAR.simd = simd_scalar;
+		else if (strcmp(argv[i], "--simd=sse2") == 0)
+			OPT_VAR.simd = simd_sse2;
+		else if (strcmp(argv[i], "--simd=avx2") == 0)
+			OPT_VAR.simd = simd_avx2;
+		else if (strcmp(argv[i], "--simd=avx512") == 0)
+			OPT_VAR.simd = simd_avx512;
+		else if (strcmp(argv[i], "--sweep=dimensions") == 0)
+			OPT_VAR.sweep = sweep_dimensions;
+		else if (strcmp(argv[i], "--sweep=columns") == 0)
+			OPT_VAR.sweep = sweep_columns;
+		else if (strcmp(argv[i], "--sweep=segments") == 0)
+			OPT_VAR.sweep = sweep_segments;
+		else if (strcmp(argv[i], "--sweep=tasks") == 0)
+			OPT_VAR.sweep = sweep_tasks;
+		else if (strcmp(argv[i], "--transpose") == 0)
+			OPT_VAR.transpose = TRUE;
+		else if (strcmp(argv[i], "--csr") == 0)
+			OPT_VAR.csr = TRUE;
+		else if (strncmp(argv[i], "--threads=", 10) == 0 && atoi(argv[i] + 10) > 0)
+			OPT_VAR.threads = atoi(argv[i] + 10);
+		else if (strncmp(argv[i], "--seed=", 7) == 0 && atoi(argv[i] + 7) > 0)
+			OPT_VAR.seed = atoi(argv[i] + 7);
+		else if (strcmp(argv[i], "--pages=default") == 0)
+			OPT_VAR.pages = pages_default;
+		else if (strcmp(argv[i], "--pages=thp") == 0)
+			OPT_VAR.pages = pages_thp;
+		else if (strcmp(argv[i], "--pages=huge") == 0)
+			OPT_VAR.pages = pages_huge;
+		else if (strcmp(argv[i], "--prefault") == 0)
+			OPT_VAR.prefault = TRUE;
+		else if (strcmp(argv[i], "--numa=default") == 0)
+			OPT_VAR.numa = numa_default;
+#ifdef __linux__
+		else if (strcmp(argv[i], "--numa=interleave") == 0)
+			OPT_VAR.numa = numa_interleave;
+#endif // __linux__
+		else if (strcmp(argv[i], "--numa=owner") == 0)
+			OPT_VAR.numa = numa_owner;
+		else
+		{
+			printf("\nNot a valid option: %s\n", argv[i]);
+			return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+		}
+	}
+
+	// by default use all the processors
+	if (OPT_VAR.threads == 0)
+		OPT_VAR.threads = get_cpu_count();
+
+	// select the bitwise kernels for this processor
+	OPT_VAR.simd = select_bitwise_kernels();
+
+	return err_none;
+}
+
+
+/** \brief Main function.
+*/
+int main(int argc, char *argv[])
+{
+	bitmatrix result;
+	bitmatrix transposed;
+	match_csr_t rows;
+	match_data_t data;
+	size_t size;
+	_INT updates;
+	_INT subscrs;
+	_INT dimensions;
+#ifdef __TEST
+	FILE *fout;
+	char fname[FILE_NAME_SIZE];
+#ifdef _WIN32
+	clock_t start, end;
+#else // _WIN32
+	struct timeval elapsed, start, end;
+#endif // _WIN32
+#endif // __TEST
+
+	if ((argc == 2 && strcmp(argv[1], "--help") == 0) || argc < 4)
+	{
+		print_synopsis(argv[0]);
+		
+		return (int)err_none;
+	}
+
+	updates = atoi(argv[1]);
+	if (updates <= 0)
+		printf("\nNot a valid number of update extents.\n");
+	subscrs = atoi(argv[2]);
+	if (subscrs <= 0)
+		printf("\nNot a valid number of subscription extents.\n");
+	dimensions = atoi(argv[3]);
+	if (dimensions <= 0)
+		printf("\nNot a valid number of dimensions.\n");
+	
+	if (updates <= 0 || subscrs <= 0 || dimensions <= 0)
+	{
+		set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+		return (int)print_error_string();
+	}
+
+	// set the options that follow the mandatory arguments
+	if (parse_options(argc - 4, &argv[4]) != err_none)
+		return (int)print_error_string();
+
+	// the bit matrix of the result must fit in the physical memory
+	size = bitmatrix_layout(&result, NULL, updates, subscrs);
+	if (size > memory_physical() && memory_physical() > 0)
+		printf("\nThe result needs %llu MB, more than the physical memory: the matching is going to swap.\n", (unsigned long long)(size / (1024 * 1024)));
+
+#ifdef __RANDOM_SET
+	// generate a random data set
+	if (test_generator_random(&data, updates, subscrs, dimensions) != err_none)
+#else // __RANDOM_SET
+	// generate a fixed data set
+	if (test_generator(&data, updates, subscrs, dimensions) != err_none)
+#endif // __RANDOM_SET
+		return (int)print_error_string();
+
+	// start the workers of the thread pool outside of the timed part
+	if (thread_pool() == NULL)
+		return (int)print_error_string();
+
+	// allocate the result bit matrix outside of the timed part (the workers can prefault it)
+	if (create_bit_matrix(&result, data.size_update, data.size_subscr) != err_none)
+		return (int)print_error_string();
+
+	// allocate the subscription-major matrix
+	if (OPT_VAR.transpose && create_bit_matrix(&transposed, data.size_subscr, data.size_update) != err_none)
+		return (int)print_error_string();
+
+#ifdef __TEST
+#ifdef _WIN32
+	// start test timer
+	start = clock();
+#else // _WIN32
+	// start test timer
+	gettimeofday(&start, NULL);
+#endif // _WIN32
+#endif // __TEST
+
+	// main algorithm
+	if (sort_matching(data, result) != err_none)
+		return (int)print_error_string();
+
+	// transpose the result (it's part of the timed matching, since it gives the other view of the same result)
+	if (OPT_VAR.transpose && parallel_bitmatrix_transpose(result, transposed, OPT_VAR.threads) != err_none)
+		return (int)print_error_string();
+
+	// export the result as compressed rows
+	if (OPT_VAR.csr && parallel_bitmatrix_to_csr(result, data.size_subscr, &rows, OPT_VAR.threads) != err_none)
+		return (int)print_error_string();
+
+#ifdef __TEST
+#ifdef _WIN32
+	// stop test timer
+	end = clock();
+
+	// format output file name and open file
+	if (sprintf_s(fname, FILE_NAME_SIZE, "%s_%d_%d_%d.txt", FILENAME(argv[0]), updates, subscrs, dimensions) == -1 || fopen_s(&fout, fname, "a+") != 0)
+	{
+		set_error(err_file, __FILE__, __FUNCTION__, __LINE__);
+		return (int)print_error_string();
+	}
+
+	// print output to file (with the memory options)
+	fprintf(fout, "%f", ((float)(end - start)) / CLOCKS_PER_SEC);
+	print_memory_options(fout);
+	fprintf(fout, "\n");
+#else // _WIN32
+	// stop test timer
+	gettimeofday(&end, NULL);
+
+	// calculate time difference
+	timeval_subtract(&elapsed, end, start);
+
+	// format output file name
+	if (sprintf(fname, "%s_%d_%d_%d.txt", FILENAME(argv[0]), updates, subscrs, dimensions) < 0)
+	{
+		set_error(err_file, __FILE__, __FUNCTION__, __LINE__);
+		return (int)print_error_string();
+	}
+
+	// open file
+	fout = fopen(fname, "a+");
+	if (fout == NULL)
+	{
+		set_error(err_file, __FILE__, __FUNCTION__, __LINE__);
+		return (int)print_error_string();
+	}
+
+	// print output to file (with the memory options)
+	fprintf(fout, "%d.%d", (int)elapsed.tv_sec, (int)elapsed.tv_usec);
+	print_memory_options(fout);
+	fprintf(fout, "\n");
+#endif // _WIN32
+
+	fclose(fout);
+
+#ifdef __DEBUG
+	getchar();
+#endif // __DEBUG
+#endif // __TEST
+
+#ifdef __VERBOSE
+	// print the result bit matrix (and its transpose and compressed rows)
+	print_bitmatrix(result);
+	if (OPT_VAR.transpose)
+		print_bitmatrix(transposed);
+	if (OPT_VAR.csr)
+		print_match_csr(&rows);
+
+#ifdef __DEBUG
+	getchar();
+#endif // __DEBUG
+#endif // __VERBOSE
+
+#ifndef __NOFREE
+	// free memory
+	free_bit_matrix(&result);
+	if (OPT_VAR.transpose)
+		free_bit_matrix(&transposed);
+	if (OPT_VAR.csr)
+		free_match_csr(&rows);
+	free(data.update);
+	free(data.subscr);
+	thread_pool_free();
+#endif // __NOFREE
+
+	return (int)err_none;
+}
@@ -0,0 +1,866 @@
+/*
+ * SortMatching
+ * Copyright 2012 Marco Mandrioli
+ *
+ * This file is part of SortMatching.
+ *
+ * SortMatching is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SortMatching is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with SortMatching.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "../include/types.h"
+
+#include "../include/scheduler.h"
+#include "../include/utils.h"
+#include "../include/error.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/** \file matching.c
+\brief File containing the main matching algorithm functions.
+*/
+
+
+/** \brief Arguments structure of the tasks of the dimensions.
+*/
+typedef struct {
+	match_data_t	data;			///< data of the problem
+	bitmatrix		out;			///< output bit matrix
+	_UINT			dimension;		///< dimension to be calculated
+	_UINT			list_threads;	///< number of tasks filling and sorting the endpoints list
+} dimension_params;
+
+
+/** \brief One-dimensional matching.
+
+This function performs the sort matching on a single dimension. It's the task submitted for each dimension by the function sort_matching().
+
+\param sched the scheduler running the task
+\param worker the index of the worker running the task
+\param arg a void pointer to the structure containing the parameters
+
+\retval error code
+*/
+static _ERR_CODE sort_matching_1D(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	_UINT i;
+	_UINT bit_pos;
+	_UINT line;
+	_UINT line_width;
+	_UINT list_size;
+	_UINT update_ep_count;
+	dimension_params params;
+	list_ptr ep_list;
+	bitvector subscr_set_before;
+	bitvector subscr_set_after;
+	_ERR_CODE err;
+
+	params = *(dimension_params *)arg;
+
+	line_width = BIT_VEC_WIDTH(params.data.size_subscr);
+
+	// two endpoints for each extent
+	list_size = (params.data.size_update + params.data.size_subscr) * 2;
+
+	// allocate the "list"
+	ep_list = (list_ptr)malloc(list_size * sizeof(list_t));
+	
+	// allocate the two subscription extents sets (setting no subscription extent to "before" with calloc)
+	subscr_set_before = (bitvector)calloc(line_width, sizeof(bitvec_elem));
+	subscr_set_after = (bitvector)malloc(line_width * sizeof(bitvec_elem));
+	
+	if (ep_list == NULL || subscr_set_before == NULL || subscr_set_after == NULL)
+	{
+		free(ep_list);
+		free(subscr_set_before);
+		free(subscr_set_after);
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	// fill the endpoints "list" with the data of the dimension to be processed and sort it
+	err = parallel_set_endpoints_list(params.data, ep_list, params.dimension, params.list_threads);
+	if (err == err_none)
+		err = parallel_sort_list(ep_list, list_size, params.list_threads);
+	if (err != err_none)
+	{
+		free(ep_list);
+		free(subscr_set_before);
+		free(subscr_set_after);
+		return err;
+	}
+
+	// number of elements on each line of the bit matrix
+	line_width = BIT_VEC_WIDTH(params.data.size_subscr);
+	// number of endpoints of update extents
+	update_ep_count = params.data.size_update * 2;
+
+	// set all the subscription extents to "after"
+	memset(subscr_set_after, 0xFF, line_width * sizeof(bitvec_elem));
+	
+	// for each endpoint in the list, but stops when all update extents endpoints are processed
+	// (only when processing update extents endpoints the algorithm writes on the matching matrix)
+	for (i = 0; update_ep_count > 0; i++)
+	{
+		// if it's the endpoint of a subscription extent
+		if (ep_list[i].id < params.data.size_subscr)
+		{
+			// calculate the element in the bit vector that contains the bit
+			bit_pos = BIT_TO_POS(ep_list[i].id);
+			
+			// if it's the lower endpoint
+			if (ep_list[i].is_lower_point)
+			{
+				// clear the bit in the bit vector (remove the subscription extent from the "after" set)
+				BIT_CLEAR(subscr_set_after[bit_pos], DBIT(BIT_POS_IN_VEC(ep_list[i].id, bit_pos)));
+			}
+			else // if it's the upper endpoint
+			{
+				// set the bit in the bit vector (add the subscription extent to the "before" set)
+				BIT_SET(subscr_set_before[bit_pos], DBIT(BIT_POS_IN_VEC(ep_list[i].id, bit_pos)));
+			}
+		}
+		else // if it's the endpoint of an update extent
+		{
+			update_ep_count--;
+
+			line = ep_list[i].id - params.data.size_subscr;
+
+			// the line can be written at the same time by the tasks of the other dimensions
+			// if it's the lower endpoint
+			if (ep_list[i].is_lower_point)
+			{
+				// atomic bitwise OR (write all the subscription extents in the "before" set in the update extent's line in the bit matrix)
+				vector_atomic_or(BITMATRIX_ROW(params.out, line), subscr_set_before, line_width);
+			}
+			else // if it's the upper endpoint
+			{
+				// atomic bitwise OR (write all the subscription extents in the "after" set in the update extent's line in the bit matrix)
+				vector_atomic_or(BITMATRIX_ROW(params.out, line), subscr_set_after, line_width);
+			}
+		}
+	}
+
+#ifndef __NOFREE
+	// free memory
+	free(ep_list);
+	free(subscr_set_before);
+	free(subscr_set_after);
+#endif // __NOFREE
+
+	return err_none;
+}
+
+
+/** \brief Arguments structure of the tasks of the column-partitioned sweep.
+*/
+typedef struct {
+	match_data_t	data;			///< data of the problem
+	list_ptr		*ep_list;		///< sorted endpoints lists (one for each dimension)
+	bitmatrix		out;			///< output bit matrix
+	_UINT			first;			///< first element of the columns owned by the thread
+	_UINT			width;			///< number of elements of the columns owned by the thread
+} column_params;
+
+
+/** \brief Sweep of a sorted list on a range of columns.
+
+Only the events of the subscription extents in the range are applied and only the slice of the lines in the range is written.
+
+\param data the data set
+\param ep_list the sorted endpoints list
+\param out the output bit matrix
+\param first the first element of the range of columns
+\param width the number of elements of the range of columns
+\param subscr_set_before the array to be used as the slice of the set of "before" subscriptions
+\param subscr_set_after the array to be used as the slice of the set of "after" subscriptions
+\param shared_lines TRUE if other threads can write the same slice of the lines at the same time
+*/
+static void sweep_column_range(const match_data_t data, const list_ptr ep_list, const bitmatrix out, const _UINT first, const _UINT width, const bitvector subscr_set_before, const bitvector subscr_set_after, const _BOOL shared_lines)
+{
+	_UINT i;
+	_UINT bit_pos;
+	_UINT line;
+	_UINT update_ep_count;
+	_UINT subscr_first;
+	_UINT subscr_last;
+	bitvector set;
+
+	// subscription extents of the range
+	subscr_first = first * BITVEC_ELEM_BITS;
+	subscr_last = MIN((first + width) * BITVEC_ELEM_BITS, data.size_subscr);
+	// number of endpoints of update extents
+	update_ep_count = data.size_update * 2;
+
+	// set no subscription extent to "before" and all of them to "after"
+	memset(subscr_set_before, 0x00, width * sizeof(bitvec_elem));
+	memset(subscr_set_after, 0xFF, width * sizeof(bitvec_elem));
+
+	// for each endpoint in the list, but stops when all update extents endpoints are processed
+	for (i = 0; update_ep_count > 0; i++)
+	{
+		// if it's the endpoint of a subscription extent
+		if (ep_list[i].id < data.size_subscr)
+		{
+			// skip the subscription extents of the other ranges
+			if (ep_list[i].id < subscr_first || ep_list[i].id >= subscr_last)
+				continue;
+
+			// calculate the element in the slice of the bit vector that contains the bit
+			bit_pos = BIT_TO_POS(ep_list[i].id);
+
+			// if it's the lower endpoint remove the subscription extent from the "after" set, else add it to the "before" set
+			if (ep_list[i].is_lower_point)
+				BIT_CLEAR(subscr_set_after[bit_pos - first], DBIT(BIT_POS_IN_VEC(ep_list[i].id, bit_pos)));
+			else
+				BIT_SET(subscr_set_before[bit_pos - first], DBIT(BIT_POS_IN_VEC(ep_list[i].id, bit_pos)));
+		}
+		else // if it's the endpoint of an update extent
+		{
+			update_ep_count--;
+
+			line = ep_list[i].id - data.size_subscr;
+			set = ep_list[i].is_lower_point ? subscr_set_before : subscr_set_after;
+
+			// bitwise OR of the "before" (lower endpoint) or "after" (upper endpoint) set in the slice of the update extent's line
+			if (shared_lines)
+				vector_atomic_or(&BITMATRIX_ROW(out, line)[first], set, width);
+			else
+				vector_bitwise_or(&BITMATRIX_ROW(out, line)[first], set, width);
+		}
+	}
+}
+
+
+/** \brief Task of the column-partitioned sweep.
+
+Every task walks all the sorted lists, but applies only the events of the subscription extents in its own columns and writes only its own slice of the lines of the bit matrix. Since the slices are disjoint, no lock is needed.
+
+\param sched the scheduler running the task
+\param worker the index of the worker running the task
+\param arg a void pointer to the structure containing the parameters
+
+\retval error code
+*/
+static _ERR_CODE sort_matching_columns_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	_UINT d;
+	bitvector subscr_set_before;
+	bitvector subscr_set_after;
+	column_params *params = (column_params *)arg;
+	_ERR_CODE err = err_none;
+
+	// allocate the slices of the two subscription extents sets
+	subscr_set_before = (bitvector)malloc(params->width * sizeof(bitvec_elem));
+	subscr_set_after = (bitvector)malloc(params->width * sizeof(bitvec_elem));
+
+	if (subscr_set_before == NULL || subscr_set_after == NULL)
+		err = set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+	else
+	{
+		// for each dimension
+		for (d = 0; d < params->data.dimensions; d++)
+			sweep_column_range(params->data, params->ep_list[d], params->out, params->first, params->width, subscr_set_before, subscr_set_after, FALSE);
+	}
+
+#ifndef __NOFREE
+	// free memory
+	free(subscr_set_before);
+	free(subscr_set_after);
+#endif // __NOFREE
+
+	return err;
+}
+
+
+/** \brief Column-partitioned matching.
+
+The lists of all the dimensions are filled and sorted using all the threads, then the columns of the bit matrix are split in ranges aligned to the cache lines and each range is given to a task, which performs the sweep of all the dimensions on it. In this way the number of threads doesn't depend on the number of dimensions and no mutex is needed.
+
+\param data the data set
+\param out the output bit matrix (initialized to zero)
+
+\retval error code
+*/
+static _ERR_CODE sort_matching_columns(const match_data_t data, const bitmatrix out)
+{
+	_UINT i;
+	_UINT line_width;
+	_UINT list_size;
+	_UINT chunk_elems;
+	_UINT chunks;
+	_UINT threads;
+	_UINT lists;
+	list_ptr ep_list[MAX_DIMENSIONS];
+	column_params params[MAX_THREADS];
+	_ERR_CODE err = err_none;
+
+	line_width = BIT_VEC_WIDTH(data.size_subscr);
+	// two endpoints for each extent
+	list_size = (data.size_update + data.size_subscr) * 2;
+
+	// the columns are split in chunks of a cache line (or of a lane, if wider), which are aligned in every row of the matrix
+	chunk_elems = MAX(CACHE_LINE_SIZE / sizeof(bitvec_elem), BITVEC_LANE_BITS / BITVEC_ELEM_BITS);
+	chunks = (line_width + chunk_elems - 1) / chunk_elems;
+	threads = MIN(MIN(OPT_VAR.threads, MAX_THREADS), chunks);
+
+	// fill and sort the lists of all the dimensions
+	for (lists = 0; lists < data.dimensions && err == err_none; lists++)
+	{
+		ep_list[lists] = (list_ptr)malloc(list_size * sizeof(list_t));
+		if (ep_list[lists] == NULL)
+			err = set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+		else
+			err = parallel_set_endpoints_list(data, ep_list[lists], lists, OPT_VAR.threads);
+
+		if (err == err_none)
+			err = parallel_sort_list(ep_list[lists], list_size, OPT_VAR.threads);
+	}
+
+	if (err == err_none)
+	{
+		// give each thread a range of whole chunks
+		for (i = 0; i < threads; i++)
+		{
+			params[i].data = data;
+			params[i].ep_list = ep_list;
+			params[i].out = out;
+			params[i].first = (chunks * i / threads) * chunk_elems;
+			params[i].width = MIN((chunks * (i + 1) / threads) * chunk_elems, line_width) - params[i].first;
+		}
+
+		err = run_tasks(sort_matching_columns_task, params, sizeof(column_params), threads);
+	}
+
+#ifndef __NOFREE
+	// free memory
+	for (i = 0; i < lists; i++)
+		free(ep_list[i]);
+#endif // __NOFREE
+
+	return err;
+}
+
+
+/** \brief Arguments structure of the tasks of the segment-parallel sweep.
+*/
+typedef struct {
+	match_data_t	data;			///< data of the problem
+	list_ptr		ep_list;		///< sorted endpoints list
+	bitmatrix		out;			///< output bit matrix
+	_UINT			first;			///< first endpoint of the segment of the thread
+	_UINT			last;			///< one past the last endpoint of the segment of the thread
+	bitvector		upper_seen;		///< subscription extents with the upper endpoint in this segment (then, after the prefix, in this and the previous segments)
+	bitvector		lower_seen;		///< subscription extents with the lower endpoint in this segment (then, after the prefix, in this and the previous segments)
+	bitvector		init_upper;		///< subscription extents with the upper endpoint in the previous segments (NULL for the first segment)
+	bitvector		init_lower;		///< subscription extents with the lower endpoint in the previous segments (NULL for the first segment)
+	bitvector		subscr_set_before;	///< "before" set of the thread
+	bitvector		subscr_set_after;	///< "after" set of the thread
+	_BOOL			lower_phase;	///< write the lines of the lower (TRUE) or of the upper (FALSE) endpoints of the update extents
+} segment_params;
+
+
+/** \brief Task computing the subscription events of its segment.
+
+\param sched the scheduler running the task
+\param worker the index of the worker running the task
+\param arg a void pointer to the structure containing the parameters
+
+\retval error code
+*/
+static _ERR_CODE segment_events_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	_UINT i;
+	_UINT bit_pos;
+	_UINT line_width;
+	segment_params *params = (segment_params *)arg;
+	list_ptr ep_list = params->ep_list;
+
+	line_width = BIT_VEC_WIDTH(params->data.size_subscr);
+
+	memset(params->upper_seen, 0x00, line_width * sizeof(bitvec_elem));
+	memset(params->lower_seen, 0x00, line_width * sizeof(bitvec_elem));
+
+	for (i = params->first; i < params->last; i++)
+	{
+		// only the endpoints of the subscription extents change the sets
+		if (ep_list[i].id < params->data.size_subscr)
+		{
+			bit_pos = BIT_TO_POS(ep_list[i].id);
+
+			if (ep_list[i].is_lower_point)
+				BIT_SET(params->lower_seen[bit_pos], DBIT(BIT_POS_IN_VEC(ep_list[i].id, bit_pos)));
+			else
+				BIT_SET(params->upper_seen[bit_pos], DBIT(BIT_POS_IN_VEC(ep_list[i].id, bit_pos)));
+		}
+	}
+
+	return err_none;
+}
+
+
+/** \brief Task sweeping its segment.
+
+The sets are initialized from the events of the previous segments, then the segment is swept as in sort_matching_1D(). Each update extent has one endpoint of each type, so if a phase writes only the lines of one type of endpoints every line is written by one task only.
+
+\param sched the scheduler running the task
+\param worker the index of the worker running the task
+\param arg a void pointer to the structure containing the parameters
+
+\retval error code
+*/
+static _ERR_CODE segment_sweep_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	_UINT i;
+	_UINT bit_pos;
+	_UINT line_width;
+	segment_params *params = (segment_params *)arg;
+	list_ptr ep_list = params->ep_list;
+
+	line_width = BIT_VEC_WIDTH(params->data.size_subscr);
+
+	// "before": the subscription extents whose upper endpoint is in the previous segments
+	if (params->init_upper == NULL)
+		memset(params->subscr_set_before, 0x00, line_width * sizeof(bitvec_elem));
+	else
+		memcpy(params->subscr_set_before, params->init_upper, line_width * sizeof(bitvec_elem));
+
+	// "after": the subscription extents whose lower endpoint is not in the previous segments
+	if (params->init_lower == NULL)
+		memset(params->subscr_set_after, 0xFF, line_width * sizeof(bitvec_elem));
+	else
+	{
+		memcpy(params->subscr_set_after, params->init_lower, line_width * sizeof(bitvec_elem));
+		vector_bitwise_not(params->subscr_set_after, line_width);
+	}
+
+	for (i = params->first; i < params->last; i++)
+	{
+		// if it's the endpoint of a subscription extent
+		if (ep_list[i].id < params->data.size_subscr)
+		{
+			bit_pos = BIT_TO_POS(ep_list[i].id);
+
+			// if it's the lower endpoint remove the subscription extent from the "after" set, else add it to the "before" set
+			if (ep_list[i].is_lower_point)
+				BIT_CLEAR(params->subscr_set_after[bit_pos], DBIT(BIT_POS_IN_VEC(ep_list[i].id, bit_pos)));
+			else
+				BIT_SET(params->subscr_set_before[bit_pos], DBIT(BIT_POS_IN_VEC(ep_list[i].id, bit_pos)));
+		}
+		// if it's the endpoint of an update extent of the type written in this phase
+		else if (ep_list[i].is_lower_point == params->lower_phase)
+		{
+			// bitwise OR of the "before" (lower endpoint) or "after" (upper endpoint) set in the update extent's line
+			vector_bitwise_or(BITMATRIX_ROW(params->out, ep_list[i].id - params->data.size_subscr), params->lower_phase ? params->subscr_set_before : params->subscr_set_after, line_width);
+		}
+	}
+
+	return err_none;
+}
+
+
+/** \brief Segment-parallel matching.
+
+The dimensions are processed one at a time and the sorted list of each dimension is split in contiguous segments, one for each thread. The sets at the start of a segment depend only on the subscription endpoints of the previous segments: each thread collects the events of its segment, an inclusive prefix OR of these events gives the initial sets of every segment, then each thread sweeps its segment on its own. The lines of the lower and of the upper endpoints of the update extents are written in two separate phases, so no lock is needed.
+
+\param data the data set
+\param out the output bit matrix (initialized to zero)
+
+\retval error code
+*/
+static _ERR_CODE sort_matching_segments(const match_data_t data, const bitmatrix out)
+{
+	_UINT i, d;
+	_UINT line_width;
+	_UINT list_size;
+	_UINT threads;
+	list_ptr ep_list;
+	bitvector sets;
+	segment_params params[MAX_THREADS];
+	_ERR_CODE err = err_none;
+
+	line_width = BIT_VEC_WIDTH(data.size_subscr);
+	// two endpoints for each extent
+	list_size = (data.size_update + data.size_subscr) * 2;
+	threads = MIN(MIN(OPT_VAR.threads, MAX_THREADS), list_size);
+
+	// the list and four sets for each thread (the events of the segment and the "before" and "after" sets)
+	ep_list = (list_ptr)malloc(list_size * sizeof(list_t));
+	sets = (bitvector)malloc((size_t)threads * 4 * line_width * sizeof(bitvec_elem));
+
+	if (ep_list == NULL || sets == NULL)
+	{
+		free(ep_list);
+		free(sets);
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	for (i = 0; i < threads; i++)
+	{
+		params[i].data = data;
+		params[i].ep_list = ep_list;
+		params[i].out = out;
+		params[i].first = (_UINT)(((uint64_t)list_size * i) / threads);
+		params[i].last = (_UINT)(((uint64_t)list_size * (i + 1)) / threads);
+		params[i].upper_seen = &sets[(size_t)(i * 4) * line_width];
+		params[i].lower_seen = &sets[(size_t)(i * 4 + 1) * line_width];
+		params[i].subscr_set_before = &sets[(size_t)(i * 4 + 2) * line_width];
+		params[i].subscr_set_after = &sets[(size_t)(i * 4 + 3) * line_width];
+		params[i].init_upper = (i > 0) ? params[i - 1].upper_seen : NULL;
+		params[i].init_lower = (i > 0) ? params[i - 1].lower_seen : NULL;
+	}
+
+	// for each dimension
+	for (d = 0; d < data.dimensions && err == err_none; d++)
+	{
+		// fill the endpoints list with the data of the dimension and sort it
+		err = parallel_set_endpoints_list(data, ep_list, d, OPT_VAR.threads);
+		if (err == err_none)
+			err = parallel_sort_list(ep_list, list_size, OPT_VAR.threads);
+
+		// events of each segment
+		if (err == err_none)
+			err = run_tasks(segment_events_task, params, sizeof(segment_params), threads);
+
+		if (err == err_none)
+		{
+			// inclusive prefix OR: the events of each segment and of all the previous ones
+			for (i = 1; i < threads; i++)
+			{
+				vector_bitwise_or(params[i].upper_seen, params[i - 1].upper_seen, line_width);
+				vector_bitwise_or(params[i].lower_seen, params[i - 1].lower_seen, line_width);
+			}
+
+			// lines of the lower endpoints, then lines of the upper endpoints
+			for (i = 0; i < threads; i++)
+				params[i].lower_phase = TRUE;
+			err = run_tasks(segment_sweep_task, params, sizeof(segment_params), threads);
+		}
+
+		if (err == err_none)
+		{
+			for (i = 0; i < threads; i++)
+				params[i].lower_phase = FALSE;
+			err = run_tasks(segment_sweep_task, params, sizeof(segment_params), threads);
+		}
+	}
+
+#ifndef __NOFREE
+	// free memory
+	free(ep_list);
+	free(sets);
+#endif // __NOFREE
+
+	return err;
+}
+
+
+/** \brief Shared state of the task-based matching.
+*/
+typedef struct task_matching_s {
+	match_data_t	data;			///< data of the problem
+	bitmatrix		out;			///< output bit matrix
+	_UINT			list_size;		///< size of each endpoints list
+	list_ptr		ep_list[MAX_DIMENSIONS];	///< endpoints lists (one for each dimension)
+	_UINT			fills_left[MAX_DIMENSIONS];	///< chunks of each list not filled yet
+	_UINT			fill_chunks;	///< number of chunks in which each list is filled
+	_UINT			tiles;			///< number of column tiles of each dimension
+	_UINT			tile_chunks;	///< number of chunks of columns (aligned to the cache lines)
+	_UINT			chunk_elems;	///< number of elements of a chunk of columns
+	_UINT			tile_width;		///< maximum number of elements of a tile
+	_UINT			not_chunks;		///< number of chunks in which the final NOT is split
+	bitvector		sets;			///< slices of the "before" and "after" sets of each worker
+	task_group_t	group;			///< group of all the tasks
+} task_matching_t;
+
+
+/** \brief Argument of a task of the task-based matching.
+*/
+typedef struct {
+	task_matching_t	*m;				///< shared state
+	_UINT			dimension;		///< dimension of the task
+	_UINT			index;			///< index of the chunk or of the tile of the task
+} matching_task_t;
+
+
+/** \brief Argument of the task of a dimension.
+
+The arguments of each dimension are stored one after another: the fill chunks, the sort, the tiles.
+*/
+#define TASK_ARG(_args, _m, _d, _i)	( &(_args)[(_d) * ((_m)->fill_chunks + 1 + (_m)->tiles) + (_i)] )
+
+
+static _ERR_CODE sort_task(scheduler_t *sched, const _UINT worker, void *arg);
+static _ERR_CODE tile_task(scheduler_t *sched, const _UINT worker, void *arg);
+
+
+/** \brief Task filling a chunk of the endpoints list of a dimension.
+
+The last chunk filled spawns the sort of the list.
+*/
+static _ERR_CODE fill_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	matching_task_t *task = (matching_task_t *)arg;
+	task_matching_t *m = task->m;
+	_UINT extents = m->data.size_subscr + m->data.size_update;
+
+	set_endpoints_range(m->data, m->ep_list[task->dimension], task->dimension,
+		(_UINT)(((uint64_t)extents * task->index) / m->fill_chunks), (_UINT)(((uint64_t)extents * (task->index + 1)) / m->fill_chunks));
+
+	if (ATOMIC_DEC(m->fills_left[task->dimension]) == 0)
+		return scheduler_submit(sched, &m->group, sort_task, task - task->index + m->fill_chunks);
+
+	return err_none;
+}
+
+
+/** \brief Task sorting the endpoints list of a dimension.
+
+The list is sorted by parallel_sort_list() on the share of the workers of its dimension: its tasks are nested in this one, which runs the queued tasks while it waits for them. When the list is sorted the sweeps of the column tiles of the dimension are spawned.
+*/
+static _ERR_CODE sort_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	_UINT i;
+	matching_task_t *task = (matching_task_t *)arg;
+	task_matching_t *m = task->m;
+	_ERR_CODE err;
+
+	err = parallel_sort_list(m->ep_list[task->dimension], m->list_size, MAX(1, sched->workers / m->data.dimensions));
+
+	for (i = 0; i < m->tiles && err == err_none; i++)
+		err = scheduler_submit(sched, &m->group, tile_task, task + 1 + i);
+
+	return err;
+}
+
+
+/** \brief Task sweeping a tile of columns of a dimension.
+
+The tiles of the other dimensions can write the same slice of the lines at the same time, so the lines are written with atomic operations.
+*/
+static _ERR_CODE tile_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	_UINT first, last;
+	_UINT line_width;
+	matching_task_t *task = (matching_task_t *)arg;
+	task_matching_t *m = task->m;
+	bitvector sets = &m->sets[(size_t)worker * 2 * m->tile_width];
+
+	line_width = BIT_VEC_WIDTH(m->data.size_subscr);
+	first = (m->tile_chunks * task->index / m->tiles) * m->chunk_elems;
+	last = MIN((m->tile_chunks * (task->index + 1) / m->tiles) * m->chunk_elems, line_width);
+
+	sweep_column_range(m->data, m->ep_list[task->dimension], m->out, first, last - first, sets, &sets[m->tile_width], TRUE);
+
+	return err_none;
+}
+
+
+/** \brief Task performing the bitwise NOT of a chunk of the bit matrix.
+*/
+static _ERR_CODE not_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	size_t first, last;
+	size_t matrix_size;
+	matching_task_t *task = (matching_task_t *)arg;
+	task_matching_t *m = task->m;
+
+	// the padding of the rows is included
+	matrix_size = BITMATRIX_SIZE(m->out);
+	first = (size_t)(((uint64_t)matrix_size * task->index) / m->not_chunks);
+	last = (size_t)(((uint64_t)matrix_size * (task->index + 1)) / m->not_chunks);
+
+	vector_bitwise_not(&m->out.base[first], last - first);
+
+	return err_none;
+}
+
+
+/** \brief Task-based matching.
+
+All the work is split in tasks run by a work-stealing scheduler: the fills of chunks of the lists, the sorts of the lists, the sweeps of the column tiles of each dimension and, at the end, the NOT of chunks of the matrix. Each task submits the ones that depend on it, so the dimensions proceed independently and the workers that run out of work steal it from the others, whatever the number of dimensions.
+
+\param data the data set
+\param out the output bit matrix (initialized to zero)
+
+\retval error code
+*/
+static _ERR_CODE sort_matching_tasks(const match_data_t data, const bitmatrix out)
+{
+	_UINT i, d;
+	_UINT line_width;
+	_UINT workers;
+	_UINT args_count;
+	task_matching_t m;
+	matching_task_t *args;
+	scheduler_t *sched;
+	_ERR_CODE wait_err;
+	_ERR_CODE err = err_none;
+
+	sched = thread_pool();
+	if (sched == NULL)
+		return set_error(err_threads, __FILE__, __FUNCTION__, __LINE__);
+
+	line_width = BIT_VEC_WIDTH(data.size_subscr);
+	workers = sched->workers;
+
+	memset(&m, 0, sizeof(task_matching_t));
+	m.data = data;
+	m.out = out;
+	// two endpoints for each extent
+	m.list_size = (data.size_update + data.size_subscr) * 2;
+	// each list is filled in chunks of at least MIN_LIST_CHUNK endpoints
+	m.fill_chunks = MAX(1, MIN(workers, m.list_size / MIN_LIST_CHUNK));
+	// the columns are split in tiles of whole cache lines (or lanes, if wider)
+	m.chunk_elems = MAX(CACHE_LINE_SIZE / sizeof(bitvec_elem), BITVEC_LANE_BITS / BITVEC_ELEM_BITS);
+	m.tile_chunks = (line_width + m.chunk_elems - 1) / m.chunk_elems;
+	m.tiles = MIN(m.tile_chunks, workers * TASK_TILES_PER_WORKER);
+	m.tile_width = ((m.tile_chunks + m.tiles - 1) / m.tiles) * m.chunk_elems;
+	m.not_chunks = MAX(1, MIN(data.size_update, workers * TASK_TILES_PER_WORKER));
+
+	args_count = data.dimensions * (m.fill_chunks + 1 + m.tiles) + m.not_chunks;
+	args = (matching_task_t *)malloc(args_count * sizeof(matching_task_t));
+	m.sets = (bitvector)malloc((size_t)workers * 2 * m.tile_width * sizeof(bitvec_elem));
+	for (d = 0; d < data.dimensions; d++)
+		m.ep_list[d] = (list_ptr)malloc(m.list_size * sizeof(list_t));
+
+	for (d = 0; d < data.dimensions && err == err_none; d++)
+	{
+		if (m.ep_list[d] == NULL)
+			err = set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+	}
+	if (err == err_none && (args == NULL || m.sets == NULL))
+		err = set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	if (err == err_none)
+	{
+		for (i = 0; i < args_count; i++)
+			args[i].m = &m;
+
+		for (d = 0; d < data.dimensions; d++)
+		{
+			m.fills_left[d] = m.fill_chunks;
+			for (i = 0; i < m.fill_chunks + 1 + m.tiles; i++)
+			{
+				TASK_ARG(args, &m, d, i)->dimension = d;
+				// fill chunks and tiles are numbered from 0
+				TASK_ARG(args, &m, d, i)->index = (i < m.fill_chunks) ? i : (i > m.fill_chunks) ? i - m.fill_chunks - 1 : 0;
+			}
+		}
+
+		// fill the lists of all the dimensions (the fills submit the sorts, which submit the sweeps)
+		task_group_init(&m.group);
+		for (d = 0; d < data.dimensions && err == err_none; d++)
+		{
+			for (i = 0; i < m.fill_chunks && err == err_none; i++)
+				err = scheduler_submit(sched, &m.group, fill_task, TASK_ARG(args, &m, d, i));
+		}
+
+		wait_err = scheduler_wait(sched, &m.group);
+		if (err == err_none)
+			err = wait_err;
+
+		// bitwise NOT of the non-matching table to obtain the matching table
+		task_group_init(&m.group);
+		for (i = 0; i < m.not_chunks && err == err_none; i++)
+		{
+			args[args_count - m.not_chunks + i].index = i;
+			err = scheduler_submit(sched, &m.group, not_task, &args[args_count - m.not_chunks + i]);
+		}
+
+		wait_err = scheduler_wait(sched, &m.group);
+		if (err == err_none)
+			err = wait_err;
+	}
+
+#ifndef __NOFREE
+	// free memory
+	for (d = 0; d < data.dimensions; d++)
+		free(m.ep_list[d]);
+	free(m.sets);
+	free(args);
+#endif // __NOFREE
+
+	return err;
+}
+
+
+/** \brief Main algorithm function.
+
+This function performs all the operations needed to feed the data one dimension at a time to the matching_1D function.
+
+\param data the data set
+\param out the output bit matrix
+
+\retval error code
+*/
+_ERR_CODE sort_matching(const match_data_t data, const bitmatrix out)
+{
+	_UINT i;
+	size_t matrix_size;
+	dimension_params params[MAX_DIMENSIONS];
+	_ERR_CODE err;
+
+	// whole matrix operations include the padding of the rows
+	matrix_size = BITMATRIX_SIZE(out);
+
+	if (data.dimensions < 1)
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+
+	if (data.dimensions > MAX_DIMENSIONS)
+		return set_error(err_too_many_dim, __FILE__, __FUNCTION__, __LINE__);
+
+	if ((uint64_t)data.size_update + data.size_subscr > MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
+	// all the work is split in tasks run by the work-stealing scheduler
+	if (OPT_VAR.sweep == sweep_tasks)
+		return sort_matching_tasks(data, out);
+
+	// the tasks work on disjoint ranges of columns or of the list, so every write is private
+	if (OPT_VAR.sweep != sweep_dimensions)
+	{
+		err = (OPT_VAR.sweep == sweep_columns) ? sort_matching_columns(data, out) : sort_matching_segments(data, out);
+		if (err != err_none)
+			return err;
+
+		// bitwise NOT of the non-matching table to obtain the matching table
+		vector_bitwise_not(out.base, matrix_size);
+
+		return err_none;
+	}
+
+	// for each dimension
+	for (i = 0; i < data.dimensions; i++)
+	{
+		// set the parameters for the i-th task
+		params[i].data = data;
+		params[i].out = out;
+		params[i].dimension = i;
+		// the workers are shared among the dimensions
+		params[i].list_threads = MAX(1, OPT_VAR.threads / data.dimensions);
+	}
+
+	// one task for each dimension
+	err = run_tasks(sort_matching_1D, params, sizeof(dimension_params), data.dimensions);
+	if (err != err_none)
+		return err;
+
+	// bitwise NOT of the non-matching table to obtain the matching table
+	vector_bitwise_not(out.base, matrix_size);
+
+	return err_none;
+}
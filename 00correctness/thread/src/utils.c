@@ -0,0 +1,1856 @@
+/*
+ * SortMatching
+ * Copyright 2012 Marco Mandrioli
+ *
+ * This file is part of SortMatching.
+ *
+ * SortMatching is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SortMatching is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with SortMatching.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "../include/types.h"
+
+#include "../include/scheduler.h"
+#include "../include/error.h"
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#endif // SIMD_X86
+#ifndef _MSC_VER
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif // __linux__
+#endif // _MSC_VER
+
+
+/** \file utils.c
+\brief File containing various utilities functions.
+*/
+
+
+/** \brief The global options variable.
+*/
+_opt_t OPT_VAR = { sort_radix, simd_auto, 0, sweep_dimensions, FALSE, FALSE, pages_default, FALSE, numa_default };
+
+
+/* Width of the radix sort key (the tie rule of compare_endpoints() is part of the key) */
+#if SPACE_TYPE_SELECT == 1 || SPACE_TYPE_SELECT == 3
+#define RADIX_POINT_BITS	32
+#else // SPACE_TYPE_SELECT
+#define RADIX_POINT_BITS	64
+#endif // SPACE_TYPE_SELECT
+
+#if defined(__SUPERSET)
+// no tie rule: the key is the point
+#define RADIX_KEY_BITS		RADIX_POINT_BITS
+#elif RADIX_POINT_BITS < 64
+// the tie rule is the least significant bit of the key
+#define RADIX_KEY_BITS		( RADIX_POINT_BITS + 1 )
+#define RADIX_TIE_IN_KEY
+#else // __SUPERSET
+// the tie rule doesn't fit in the key: it's sorted by an extra 1-bit pass before the others
+#define RADIX_KEY_BITS		RADIX_POINT_BITS
+#define RADIX_TIE_PASS
+#endif // __SUPERSET
+
+#define RADIX_PASSES		( (RADIX_KEY_BITS + RADIX_DIGIT_BITS - 1) / RADIX_DIGIT_BITS )
+
+
+/* Memory policies of the Linux system calls (numaif.h isn't always available) */
+#define MEMORY_MPOL_INTERLEAVE		3
+#define MEMORY_MPOL_F_MEMS_ALLOWED	( 1 << 2 )
+
+
+/** \brief Size of a big allocation, rounded up to whole pages (or huge pages).
+
+\param size the size requested in bytes
+
+\retval the size allocated in bytes
+*/
+static size_t memory_length(const size_t size)
+{
+	size_t page;
+
+	page = (OPT_VAR.pages == pages_default) ? MEMORY_PAGE_SIZE : MEMORY_HUGE_PAGE_SIZE;
+
+	return ((MAX(size, 1) + page - 1) / page) * page;
+}
+
+
+/** \brief Interleaves the pages of a memory block on all the NUMA nodes allowed to the process.
+
+\param ptr the memory block (not touched yet)
+\param length the size of the memory block in bytes
+
+\retval TRUE if the policy has been set
+\retval FALSE otherwise
+*/
+static _BOOL memory_interleave(void *ptr, const size_t length)
+{
+#ifdef __linux__
+	unsigned long nodes[MEMORY_MAX_NODES / (8 * sizeof(unsigned long))];
+
+	memset(nodes, 0, sizeof(nodes));
+
+	// the nodes allowed to the process, then the interleave policy on them
+	if (syscall(SYS_get_mempolicy, NULL, nodes, (unsigned long)MEMORY_MAX_NODES, NULL, (unsigned long)MEMORY_MPOL_F_MEMS_ALLOWED) != 0)
+		return FALSE;
+
+	return syscall(SYS_mbind, ptr, (unsigned long)length, (unsigned long)MEMORY_MPOL_INTERLEAVE, nodes, (unsigned long)MEMORY_MAX_NODES, 0UL) == 0;
+#else // __linux__
+	return FALSE;
+#endif // __linux__
+}
+
+
+/** \brief Arguments structure of the tasks touching the pages of a memory block.
+*/
+typedef struct {
+	char			*ptr;			///< memory block
+	size_t			first;			///< first byte of the band of the task
+	size_t			last;			///< one past the last byte of the band of the task
+} prefault_params;
+
+
+/** \brief Touches every page of a range of a memory block, so that the page faults happen now.
+
+\param ptr the memory block
+\param first the first byte of the range (at the beginning of a page)
+\param last one past the last byte of the range
+*/
+static void memory_touch(char *ptr, const size_t first, const size_t last)
+{
+	size_t i;
+
+	// the memory is already zeroed, writing a zero only faults the page in
+	for (i = first; i < last; i += MEMORY_PAGE_SIZE)
+		((volatile char *)ptr)[i] = 0;
+}
+
+
+/** \brief Task touching the pages of its band of a memory block.
+
+\param sched the scheduler running the task
+\param worker the index of the worker running the task
+\param arg a void pointer to the structure containing the parameters
+
+\retval error code
+*/
+static _ERR_CODE prefault_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	prefault_params *params = (prefault_params *)arg;
+
+	memory_touch(params->ptr, params->first, params->last);
+
+	return err_none;
+}
+
+
+/** \brief Touches every page of a memory block, so that the page faults happen now.
+
+With numa_owner the block is split in contiguous bands of whole pages, one for each worker of the thread pool, and each band is touched by a task of the pool, so that its pages are placed on the NUMA node of the worker.
+
+\param ptr the memory block
+\param length the size of the memory block in bytes
+*/
+static void memory_prefault(void *ptr, const size_t length)
+{
+	_UINT i, bands;
+	size_t pages;
+	prefault_params params[MAX_THREADS];
+
+	pages = length / MEMORY_PAGE_SIZE;
+	bands = (_UINT)MIN((size_t)MIN(OPT_VAR.threads, MAX_THREADS), pages);
+
+	if (OPT_VAR.numa == numa_owner && bands > 1)
+	{
+		for (i = 0; i < bands; i++)
+		{
+			params[i].ptr = (char *)ptr;
+			params[i].first = (pages * i / bands) * MEMORY_PAGE_SIZE;
+			params[i].last = (pages * (i + 1) / bands) * MEMORY_PAGE_SIZE;
+		}
+
+		// the pages the tasks couldn't touch are touched below
+		if (run_tasks(prefault_task, params, sizeof(prefault_params), bands) == err_none)
+			return;
+	}
+
+	memory_touch((char *)ptr, 0, length);
+}
+
+
+/** \brief Allocates a big block of zeroed memory following the memory options.
+
+The block is mapped directly from the system, so that it can use transparent or explicit huge pages, be interleaved on the NUMA nodes or first touched by the workers of the thread pool, and be prefaulted (outside the timed part of the program, since the big blocks are allocated before it).
+
+\param size the size in bytes
+
+\retval the pointer to the memory, or NULL if it couldn't be allocated with the requested options
+*/
+void *memory_alloc(const size_t size)
+{
+	void *ptr;
+	size_t length;
+
+	length = memory_length(size);
+
+#ifdef _MSC_VER
+	if (OPT_VAR.pages == pages_huge)
+	{
+		// the large pages need the "Lock pages in memory" privilege and are always committed
+		length = ((length + GetLargePageMinimum() - 1) / GetLargePageMinimum()) * GetLargePageMinimum();
+		ptr = VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+	}
+	else
+		ptr = VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+	if (ptr == NULL)
+		return NULL;
+#else // _MSC_VER
+#ifdef MAP_HUGETLB
+	if (OPT_VAR.pages == pages_huge)
+		ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	else
+#endif // MAP_HUGETLB
+		ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (ptr == MAP_FAILED)
+		return NULL;
+
+#ifdef MADV_HUGEPAGE
+	// the transparent huge pages must be requested before the pages are touched
+	if (OPT_VAR.pages == pages_thp)
+		madvise(ptr, length, MADV_HUGEPAGE);
+#endif // MADV_HUGEPAGE
+
+	// the NUMA policy must be set before the pages are touched
+	if (OPT_VAR.numa == numa_interleave && !memory_interleave(ptr, length))
+	{
+		munmap(ptr, length);
+		return NULL;
+	}
+#endif // _MSC_VER
+
+	// the first touch by the owners is a prefault done by the workers
+	if (OPT_VAR.prefault || OPT_VAR.numa == numa_owner)
+		memory_prefault(ptr, length);
+
+	return ptr;
+}
+
+
+/** \brief Frees a block of memory allocated by memory_alloc().
+
+\param ptr the memory block (can be NULL)
+\param size the size in bytes requested to memory_alloc()
+*/
+void memory_free(void *ptr, const size_t size)
+{
+	if (ptr == NULL)
+		return;
+
+#ifdef _MSC_VER
+	VirtualFree(ptr, 0, MEM_RELEASE);
+#else // _MSC_VER
+	munmap(ptr, memory_length(size));
+#endif // _MSC_VER
+}
+
+
+/** \brief Size of the physical memory of the machine.
+
+\retval the size in bytes (0 if it can't be known)
+*/
+size_t memory_physical()
+{
+#ifdef _MSC_VER
+	MEMORYSTATUSEX status;
+
+	status.dwLength = sizeof(MEMORYSTATUSEX);
+	if (!GlobalMemoryStatusEx(&status))
+		return 0;
+
+	return (size_t)status.ullTotalPhys;
+#else // _MSC_VER
+	long pages, page;
+
+	pages = sysconf(_SC_PHYS_PAGES);
+	page = sysconf(_SC_PAGESIZE);
+	if (pages <= 0 || page <= 0)
+		return 0;
+
+	return (size_t)pages * (size_t)page;
+#endif // _MSC_VER
+}
+
+
+/** \brief Sets the geometry of a bit matrix on a block of memory.
+
+\param out the bit matrix
+\param base the block of memory (aligned to BITMATRIX_ALIGNMENT bytes), or NULL to compute only its size
+\param size_update the height of the matrix
+\param size_subscr the \i minimum width in bits of the matrix
+
+\retval the size of the block of memory in bytes
+*/
+size_t bitmatrix_layout(bitmatrix *out, const bitvector base, const _UINT size_update, const _UINT size_subscr)
+{
+	_UINT align;
+
+	// elements in an aligned block
+	align = BITMATRIX_ALIGNMENT / sizeof(bitvec_elem);
+
+	out->base = base;
+	out->rows = size_update;
+	out->width = BIT_VEC_WIDTH(size_subscr);
+	out->stride = ((out->width + align - 1) / align) * align;
+	out->alignment = BITMATRIX_ALIGNMENT;
+
+#if BITMATRIX_ALIAS_STRIDE > 0
+	// pad the rows whose stride would map the same columns on the same cache sets
+	if ((out->stride * sizeof(bitvec_elem)) % BITMATRIX_ALIAS_STRIDE == 0)
+		out->stride += align;
+#endif // BITMATRIX_ALIAS_STRIDE
+
+	return (size_t)out->rows * out->stride * sizeof(bitvec_elem);
+}
+
+
+/** \brief Allocates a bit matrix of given height and width.
+
+The rows are allocated with memory_alloc(), so they follow the memory options and are zeroed.
+
+\param out pointer to the bit matrix to be allocated
+\param size_update the height of the matrix
+\param size_subscr the \i minimum width in bits of the matrix
+
+\retval error code
+*/
+_ERR_CODE create_bit_matrix(bitmatrix *out, const _UINT size_update, const _UINT size_subscr)
+{
+	// memory_alloc() returns whole pages, so the rows are aligned
+	out->base = (bitvector)memory_alloc(bitmatrix_layout(out, NULL, size_update, size_subscr));
+	if (out->base == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	return err_none;
+}
+
+
+/** \brief Frees a bit matrix allocated by create_bit_matrix().
+
+\param in the bit matrix
+*/
+void free_bit_matrix(bitmatrix *in)
+{
+	memory_free(in->base, (size_t)BITMATRIX_SIZE(*in) * sizeof(bitvec_elem));
+	in->base = NULL;
+}
+
+
+/** \brief Bitwise NOT of a bit vector (scalar version).
+
+\param vec bit vector to be inverted
+\param size number of elements of the bit vector
+*/
+static void vector_bitwise_not_scalar(const bitvector vec, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		vec[i] = ~vec[i];
+}
+
+
+/** \brief Bitwise OR of two bit vectors (scalar version).
+
+\param result first vector and also resulting vector
+\param mask second vector
+\param size number of elements in the bit vectors
+*/
+static void vector_bitwise_or_scalar(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		result[i] |= mask[i];
+}
+
+
+/** \brief Number of set bits of an element of a bit vector.
+
+\param val the element
+
+\retval the number of set bits
+*/
+static INLINE _UINT elem_popcount(bitvec_elem val)
+{
+#ifdef __GNUC__
+#if BITVEC_ELEM_BITS == 64
+	return (_UINT)__builtin_popcountll(val);
+#else // BITVEC_ELEM_BITS
+	return (_UINT)__builtin_popcount(val);
+#endif // BITVEC_ELEM_BITS
+#else // __GNUC__
+	_UINT count;
+
+	// clear the lowest set bit until none is left
+	for (count = 0; val != 0; count++)
+		val &= val - 1;
+
+	return count;
+#endif // __GNUC__
+}
+
+
+/** \brief Position of the first set bit of an element of a bit vector in descending order (the DBIT() of the bit).
+
+\param val the element (not zero)
+
+\retval the position of the bit
+*/
+static INLINE _UINT elem_first_dbit(const bitvec_elem val)
+{
+#ifdef __GNUC__
+#if BITVEC_ELEM_BITS == 64
+	return (_UINT)__builtin_clzll(val);
+#else // BITVEC_ELEM_BITS
+	return (_UINT)__builtin_clz(val);
+#endif // BITVEC_ELEM_BITS
+#else // __GNUC__
+	_UINT bit;
+
+	for (bit = 0; !(val & DBIT(bit)); bit++);
+
+	return bit;
+#endif // __GNUC__
+}
+
+
+/** \brief Positions of the set bits of a range of elements of a bit vector (scalar version).
+
+The bits of each element are found with the count of leading zeros, since bit 0 is the most significant one (as in DBIT()), so the positions are written in ascending order.
+
+\param vec the bit vector
+\param first the first element of the range
+\param last one past the last element of the range
+\param out the positions of the set bits (with room for all of them)
+
+\retval the number of set bits
+*/
+static _UINT vector_bit_positions_scalar(const bitvector vec, const _UINT first, const _UINT last, _UINT *out)
+{
+	_UINT i, bit, count;
+	bitvec_elem val;
+
+	count = 0;
+	for (i = first; i < last; i++)
+	{
+		for (val = vec[i]; val != 0; val ^= DBIT(bit))
+		{
+			bit = elem_first_dbit(val);
+			out[count++] = i * BITVEC_ELEM_BITS + bit;
+		}
+	}
+
+	return count;
+}
+
+
+/** \brief Transposes the last levels of a square block of bits, starting from the swap of sub-blocks of a given size.
+
+Each level swaps the top right and the bottom left sub-blocks of all the sub-blocks of size 2 * level, so the levels from BITVEC_ELEM_BITS / 2 down to 1 transpose the whole block (bit 0 of each element is the first column).
+
+\param block the block, an element for each row
+\param level the size of the sub-blocks swapped by the first level
+\param m the mask of the right sub-blocks of the first level
+*/
+static void transpose_block_levels(const bitvector block, _UINT level, bitvec_elem m)
+{
+	_UINT k;
+	bitvec_elem t;
+
+	for (; level != 0; level >>= 1, m ^= m << level)
+	{
+		// k runs on the top rows of each pair of sub-blocks
+		for (k = 0; k < BITVEC_ELEM_BITS; k = (k + level + 1) & ~level)
+		{
+			t = (block[k] ^ (block[k + level] >> level)) & m;
+			block[k] ^= t;
+			block[k + level] ^= t << level;
+		}
+	}
+}
+
+
+/** \brief Transposes a square block of BITVEC_ELEM_BITS x BITVEC_ELEM_BITS bits in place (scalar version).
+
+\param block the block, an element for each row
+*/
+static void transpose_block_scalar(const bitvector block)
+{
+	transpose_block_levels(block, BITVEC_ELEM_BITS / 2, ~(bitvec_elem)0 >> (BITVEC_ELEM_BITS / 2));
+}
+
+
+#ifdef SIMD_X86
+/* Number of elements of the bit vector in a 128, 256 and 512 bit register */
+#define SSE2_ELEMS			( 16 / sizeof(bitvec_elem) )
+#define AVX2_ELEMS			( 32 / sizeof(bitvec_elem) )
+#define AVX512_ELEMS		( 64 / sizeof(bitvec_elem) )
+
+/* Broadcast and shifts of the elements of the bit vector in a register */
+#if BITVEC_ELEM_BITS == 64
+#define SSE2_SET1(_x)		_mm_set1_epi64x((long long)(_x))
+#define SSE2_SRL(_v, _c)	_mm_srl_epi64(_v, _c)
+#define SSE2_SLL(_v, _c)	_mm_sll_epi64(_v, _c)
+#define AVX2_SET1(_x)		_mm256_set1_epi64x((long long)(_x))
+#define AVX2_SRL(_v, _c)	_mm256_srl_epi64(_v, _c)
+#define AVX2_SLL(_v, _c)	_mm256_sll_epi64(_v, _c)
+#else // BITVEC_ELEM_BITS
+#define SSE2_SET1(_x)		_mm_set1_epi32((int)(_x))
+#define SSE2_SRL(_v, _c)	_mm_srl_epi32(_v, _c)
+#define SSE2_SLL(_v, _c)	_mm_sll_epi32(_v, _c)
+#define AVX2_SET1(_x)		_mm256_set1_epi32((int)(_x))
+#define AVX2_SRL(_v, _c)	_mm256_srl_epi32(_v, _c)
+#define AVX2_SLL(_v, _c)	_mm256_sll_epi32(_v, _c)
+#endif // BITVEC_ELEM_BITS
+
+
+/** \brief Bitwise NOT of a bit vector (SSE2 version).
+*/
+TARGET("sse2") static void vector_bitwise_not_sse2(const bitvector vec, const size_t size)
+{
+	size_t i;
+	__m128i ones = _mm_set1_epi32(-1);
+
+	for (i = 0; i + SSE2_ELEMS <= size; i += SSE2_ELEMS)
+		_mm_storeu_si128((__m128i *)&vec[i], _mm_xor_si128(_mm_loadu_si128((__m128i *)&vec[i]), ones));
+
+	vector_bitwise_not_scalar(&vec[i], size - i);
+}
+
+
+/** \brief Bitwise OR of two bit vectors (SSE2 version).
+*/
+TARGET("sse2") static void vector_bitwise_or_sse2(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i + SSE2_ELEMS <= size; i += SSE2_ELEMS)
+		_mm_storeu_si128((__m128i *)&result[i], _mm_or_si128(_mm_loadu_si128((__m128i *)&result[i]), _mm_loadu_si128((__m128i *)&mask[i])));
+
+	vector_bitwise_or_scalar(&result[i], &mask[i], size - i);
+}
+
+
+/** \brief Transposes a square block of BITVEC_ELEM_BITS x BITVEC_ELEM_BITS bits in place (SSE2 version).
+
+The levels that swap sub-blocks of at least a register of rows are done on whole registers, the last ones by the scalar code.
+*/
+TARGET("sse2") static void transpose_block_sse2(const bitvector block)
+{
+	_UINT level, first, k;
+	bitvec_elem m;
+	__m128i a, b, t, vm, count;
+
+	m = ~(bitvec_elem)0 >> (BITVEC_ELEM_BITS / 2);
+	for (level = BITVEC_ELEM_BITS / 2; level >= SSE2_ELEMS; level >>= 1, m ^= m << level)
+	{
+		vm = SSE2_SET1(m);
+		count = _mm_cvtsi32_si128((int)level);
+
+		// for each pair of sub-blocks, the top rows are swapped with the bottom ones a register at a time
+		for (first = 0; first < BITVEC_ELEM_BITS; first += 2 * level)
+		{
+			for (k = first; k < first + level; k += SSE2_ELEMS)
+			{
+				a = _mm_loadu_si128((__m128i *)&block[k]);
+				b = _mm_loadu_si128((__m128i *)&block[k + level]);
+				t = _mm_and_si128(_mm_xor_si128(a, SSE2_SRL(b, count)), vm);
+				_mm_storeu_si128((__m128i *)&block[k], _mm_xor_si128(a, t));
+				_mm_storeu_si128((__m128i *)&block[k + level], _mm_xor_si128(b, SSE2_SLL(t, count)));
+			}
+		}
+	}
+
+	transpose_block_levels(block, level, m);
+}
+#endif // SIMD_X86
+
+
+#ifdef SIMD_AVX2
+/** \brief Bitwise NOT of a bit vector (AVX2 version).
+*/
+TARGET("avx2") static void vector_bitwise_not_avx2(const bitvector vec, const size_t size)
+{
+	size_t i;
+	__m256i ones = _mm256_set1_epi32(-1);
+
+	for (i = 0; i + AVX2_ELEMS <= size; i += AVX2_ELEMS)
+		_mm256_storeu_si256((__m256i *)&vec[i], _mm256_xor_si256(_mm256_loadu_si256((__m256i *)&vec[i]), ones));
+
+	vector_bitwise_not_scalar(&vec[i], size - i);
+}
+
+
+/** \brief Bitwise OR of two bit vectors (AVX2 version).
+*/
+TARGET("avx2") static void vector_bitwise_or_avx2(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i + AVX2_ELEMS <= size; i += AVX2_ELEMS)
+		_mm256_storeu_si256((__m256i *)&result[i], _mm256_or_si256(_mm256_loadu_si256((__m256i *)&result[i]), _mm256_loadu_si256((__m256i *)&mask[i])));
+
+	vector_bitwise_or_scalar(&result[i], &mask[i], size - i);
+}
+
+
+/** \brief Transposes a square block of BITVEC_ELEM_BITS x BITVEC_ELEM_BITS bits in place (AVX2 version).
+
+The levels that swap sub-blocks of at least a register of rows are done on whole registers, the last ones by the scalar code.
+*/
+TARGET("avx2") static void transpose_block_avx2(const bitvector block)
+{
+	_UINT level, first, k;
+	bitvec_elem m;
+	__m256i a, b, t, vm;
+	__m128i count;
+
+	m = ~(bitvec_elem)0 >> (BITVEC_ELEM_BITS / 2);
+	for (level = BITVEC_ELEM_BITS / 2; level >= AVX2_ELEMS; level >>= 1, m ^= m << level)
+	{
+		vm = AVX2_SET1(m);
+		count = _mm_cvtsi32_si128((int)level);
+
+		// for each pair of sub-blocks, the top rows are swapped with the bottom ones a register at a time
+		for (first = 0; first < BITVEC_ELEM_BITS; first += 2 * level)
+		{
+			for (k = first; k < first + level; k += AVX2_ELEMS)
+			{
+				a = _mm256_loadu_si256((__m256i *)&block[k]);
+				b = _mm256_loadu_si256((__m256i *)&block[k + level]);
+				t = _mm256_and_si256(_mm256_xor_si256(a, AVX2_SRL(b, count)), vm);
+				_mm256_storeu_si256((__m256i *)&block[k], _mm256_xor_si256(a, t));
+				_mm256_storeu_si256((__m256i *)&block[k + level], _mm256_xor_si256(b, AVX2_SLL(t, count)));
+			}
+		}
+	}
+
+	transpose_block_levels(block, level, m);
+}
+#endif // SIMD_AVX2
+
+
+#ifdef SIMD_AVX512
+/** \brief Positions of the set bits of a range of elements of a bit vector (AVX-512 version).
+
+Each group of 16 bits is compressed in a single instruction: the bit j of the group (from the least significant one) is the column 15 - j of the group, so the compressed columns are descending and one permutation of the first lanes puts them back in ascending order.
+*/
+TARGET("avx512f") static _UINT vector_bit_positions_avx512(const bitvector vec, const _UINT first, const _UINT last, _UINT *out)
+{
+	_UINT i, k, n, count;
+	__mmask16 bits;
+	__m512i columns, reverse, lanes;
+
+	// the columns of a group, from the last one
+	reverse = _mm512_set_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	lanes = _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
+	count = 0;
+	for (i = first; i < last; i++)
+	{
+		if (vec[i] == 0)
+			continue;
+
+		// for each group of 16 bits, from the most significant one
+		for (k = 0; k < BITVEC_ELEM_BITS; k += 16)
+		{
+			bits = (__mmask16)(vec[i] >> (BITVEC_ELEM_BITS - 16 - k));
+			if (bits == 0)
+				continue;
+
+			n = (_UINT)elem_popcount(bits);
+			columns = _mm512_maskz_compress_epi32(bits, _mm512_add_epi32(reverse, _mm512_set1_epi32((int)(i * BITVEC_ELEM_BITS + k))));
+			columns = _mm512_permutexvar_epi32(_mm512_sub_epi32(_mm512_set1_epi32((int)n - 1), lanes), columns);
+			_mm512_mask_storeu_epi32(&out[count], (__mmask16)((1U << n) - 1), columns);
+			count += n;
+		}
+	}
+
+	return count;
+}
+#endif // SIMD_AVX512
+
+
+#ifdef SIMD_AVX512
+/** \brief Bitwise NOT of a bit vector (AVX-512 version).
+*/
+TARGET("avx512f") static void vector_bitwise_not_avx512(const bitvector vec, const size_t size)
+{
+	size_t i;
+	__m512i ones = _mm512_set1_epi32(-1);
+
+	for (i = 0; i + AVX512_ELEMS <= size; i += AVX512_ELEMS)
+		_mm512_storeu_si512((void *)&vec[i], _mm512_xor_si512(_mm512_loadu_si512((void *)&vec[i]), ones));
+
+	vector_bitwise_not_scalar(&vec[i], size - i);
+}
+
+
+/** \brief Bitwise OR of two bit vectors (AVX-512 version).
+*/
+TARGET("avx512f") static void vector_bitwise_or_avx512(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i + AVX512_ELEMS <= size; i += AVX512_ELEMS)
+		_mm512_storeu_si512((void *)&result[i], _mm512_or_si512(_mm512_loadu_si512((void *)&result[i]), _mm512_loadu_si512((void *)&mask[i])));
+
+	vector_bitwise_or_scalar(&result[i], &mask[i], size - i);
+}
+#endif // SIMD_AVX512
+
+
+/** \brief Table of the bitwise kernels.
+*/
+typedef struct
+{
+	void (*bitwise_not)(const bitvector, const size_t);						///< bitwise NOT kernel
+	void (*bitwise_or)(const bitvector, const bitvector, const size_t);		///< bitwise OR kernel
+	void (*transpose_block)(const bitvector);								///< transpose kernel of a square block of bits
+	_UINT (*bit_positions)(const bitvector, const _UINT, const _UINT, _UINT *);	///< kernel of the positions of the set bits
+} bitwise_kernels_t;
+
+
+/** \brief The bitwise kernels in use (scalar until select_bitwise_kernels() is called).
+*/
+static bitwise_kernels_t kernels = { vector_bitwise_not_scalar, vector_bitwise_or_scalar, transpose_block_scalar, vector_bit_positions_scalar };
+
+
+/** \brief Best instruction set supported by the processor and the operating system.
+
+\retval the instruction set
+*/
+static simd_t detect_simd()
+{
+#if defined(SIMD_X86) && defined(__GNUC__)
+	__builtin_cpu_init();
+#ifdef SIMD_AVX512
+	if (__builtin_cpu_supports("avx512f"))
+		return simd_avx512;
+#endif // SIMD_AVX512
+	if (__builtin_cpu_supports("avx2"))
+		return simd_avx2;
+	if (__builtin_cpu_supports("sse2"))
+		return simd_sse2;
+#elif defined(SIMD_X86) && defined(_MSC_VER)
+	int info[4];
+	unsigned __int64 xcr0 = 0;
+
+	__cpuid(info, 0);
+	if (info[0] < 1)
+		return simd_scalar;
+
+	__cpuid(info, 1);
+	// the registers saved by the operating system (only if OSXSAVE is set)
+	if (info[2] & (1 << 27))
+		xcr0 = _xgetbv(0);
+
+#ifdef SIMD_AVX2
+	if ((xcr0 & 0x06) == 0x06)
+	{
+		__cpuidex(info, 7, 0);
+#ifdef SIMD_AVX512
+		if ((info[1] & (1 << 16)) && (xcr0 & 0xE6) == 0xE6)
+			return simd_avx512;
+#endif // SIMD_AVX512
+		if (info[1] & (1 << 5))
+			return simd_avx2;
+	}
+#endif // SIMD_AVX2
+
+	__cpuid(info, 1);
+	if (info[3] & (1 << 26))
+		return simd_sse2;
+#endif // SIMD_X86
+
+	return simd_scalar;
+}
+
+
+/** \brief Selects the bitwise kernels.
+
+The kernels are selected once at startup, using the instruction set requested in the global options if supported, otherwise the best one supported by the processor.
+
+\retval the instruction set of the selected kernels
+*/
+simd_t select_bitwise_kernels()
+{
+	simd_t simd;
+
+	simd = detect_simd();
+	if (OPT_VAR.simd != simd_auto && OPT_VAR.simd < simd)
+		simd = OPT_VAR.simd;
+
+	switch (simd)
+	{
+#ifdef SIMD_AVX512
+	case simd_avx512:
+		kernels.bitwise_not = vector_bitwise_not_avx512;
+		kernels.bitwise_or = vector_bitwise_or_avx512;
+		// the block of the transpose is too small for the 512 bit registers
+		kernels.transpose_block = transpose_block_avx2;
+		kernels.bit_positions = vector_bit_positions_avx512;
+		break;
+#endif // SIMD_AVX512
+#ifdef SIMD_AVX2
+	case simd_avx2:
+		kernels.bitwise_not = vector_bitwise_not_avx2;
+		kernels.bitwise_or = vector_bitwise_or_avx2;
+		kernels.transpose_block = transpose_block_avx2;
+		kernels.bit_positions = vector_bit_positions_scalar;
+		break;
+#endif // SIMD_AVX2
+#ifdef SIMD_X86
+	case simd_sse2:
+		kernels.bitwise_not = vector_bitwise_not_sse2;
+		kernels.bitwise_or = vector_bitwise_or_sse2;
+		kernels.transpose_block = transpose_block_sse2;
+		kernels.bit_positions = vector_bit_positions_scalar;
+		break;
+#endif // SIMD_X86
+	default:
+		simd = simd_scalar;
+		kernels.bitwise_not = vector_bitwise_not_scalar;
+		kernels.bitwise_or = vector_bitwise_or_scalar;
+		kernels.transpose_block = transpose_block_scalar;
+		kernels.bit_positions = vector_bit_positions_scalar;
+		break;
+	}
+
+	return simd;
+}
+
+
+/** \brief Bitwise NOT of a bit vector.
+
+It can also be used to do the bitwise NOT of the matrix, since it's allocated as linear memory.
+
+\param vec bit vector to be inverted
+\param size number of elements of the bit vector
+*/
+void vector_bitwise_not(const bitvector vec, const size_t size)
+{
+	kernels.bitwise_not(vec, size);
+}
+
+
+/** \brief Bitwise OR of two bit vectors.
+
+It can also be used to do the bitwise OR of the matrix, since it's allocated as linear memory.
+
+\param result first vector and also resulting vector
+\param mask second vector
+\param size number of elements in the bit vectors
+*/
+void vector_bitwise_or(const bitvector result, const bitvector mask, const size_t size)
+{
+	kernels.bitwise_or(result, mask, size);
+}
+
+
+/** \brief Bitwise OR of two bit vectors, with the first one written by more threads at the same time.
+
+Only the elements that get new bits from the mask are written, each one with an atomic OR, so no lock is needed and the elements already set by the other threads cost only a read.
+
+\param result first vector and also resulting vector
+\param mask second vector
+\param size number of elements in the bit vectors
+*/
+void vector_atomic_or(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+	{
+		if ((mask[i] & ~ATOMIC_READ(result[i])) != 0)
+			ATOMIC_BIT_SET(result[i], mask[i]);
+	}
+}
+
+
+/** \brief Frees the memory of a list of matching pairs.
+
+\param csr the list of matching pairs
+*/
+void free_match_csr(match_csr_t *csr)
+{
+	free(csr->first);
+	free(csr->subscr);
+
+	memset(csr, 0, sizeof(match_csr_t));
+}
+
+
+/** \brief Sets an iterator on the matching subscription extents of an update extent.
+
+\param it the iterator
+\param m the result bit matrix
+\param size_subscr the number of subscription extents
+\param update the update extent
+*/
+void match_iter_init(match_iter_t *it, const bitmatrix m, const _UINT size_subscr, const _UINT update)
+{
+	it->line = BITMATRIX_ROW(m, update);
+	it->size_subscr = size_subscr;
+	it->last = BIT_TO_POS((size_subscr + BITVEC_ELEM_BITS - 1));
+	it->elem = 0;
+	it->val = it->line[0];
+}
+
+
+/** \brief Moves an iterator to the next matching subscription extent.
+
+The zero elements are skipped whole and the next set bit of an element is found with the count of leading zeros, so the cost is proportional to the matches and to the zero elements, not to the bits.
+
+\param it the iterator
+\param subscr the next matching subscription extent
+
+\retval TRUE if there was another match, FALSE at the end of the row
+*/
+_BOOL match_iter_next(match_iter_t *it, _UINT *subscr)
+{
+	_UINT bit;
+
+	while (it->val == 0)
+	{
+		if (++it->elem >= it->last)
+		{
+			it->elem = it->last;
+			return FALSE;
+		}
+		it->val = it->line[it->elem];
+	}
+
+	bit = elem_first_dbit(it->val);
+	*subscr = it->elem * BITVEC_ELEM_BITS + bit;
+
+	// the bits after the last subscription extent are padding
+	if (*subscr >= it->size_subscr)
+	{
+		it->val = 0;
+		it->elem = it->last;
+		return FALSE;
+	}
+
+	it->val ^= DBIT(bit);
+
+	return TRUE;
+}
+
+
+/** \brief Counts or lists the matching subscription extents of a row of the result.
+
+\param m the result bit matrix
+\param size_subscr the number of subscription extents
+\param row the row
+\param out the matching subscription extents, in ascending order (NULL to count them only)
+
+\retval the number of matching subscription extents
+*/
+static _UINT bitmatrix_row_matches(const bitmatrix m, const _UINT size_subscr, const _UINT row, _UINT *out)
+{
+	_UINT i, bit, count;
+	_UINT full;
+	bitvec_elem val;
+	bitvector line;
+
+	line = BITMATRIX_ROW(m, row);
+	count = 0;
+
+	// the elements holding only columns
+	full = size_subscr / BITVEC_ELEM_BITS;
+	if (out == NULL)
+	{
+		for (i = 0; i < full; i++)
+			count += elem_popcount(line[i]);
+	}
+	else
+		count = kernels.bit_positions(line, 0, full, out);
+
+	// the last element holding columns is followed by padding bits
+	if (size_subscr % BITVEC_ELEM_BITS != 0)
+	{
+		val = line[full] & ~((BITVEC_ELEM_MAX_BIT >> (size_subscr % BITVEC_ELEM_BITS - 1)) - 1);
+
+		if (out == NULL)
+			count += elem_popcount(val);
+		else
+		{
+			for (; val != 0; val ^= DBIT(bit))
+			{
+				bit = elem_first_dbit(val);
+				out[count++] = full * BITVEC_ELEM_BITS + bit;
+			}
+		}
+	}
+
+	return count;
+}
+
+
+/** \brief Arguments structure of the tasks of the export to compressed rows.
+*/
+typedef struct {
+	bitmatrix		m;				///< the result bit matrix
+	_UINT			size_subscr;	///< number of subscription extents
+	match_csr_t		*csr;			///< the compressed rows
+	_UINT			first;			///< first row of the task
+	_UINT			last;			///< one past the last row of the task
+} csr_params;
+
+
+/** \brief Task counting the matches of a band of rows (first pass of the export).
+
+The number of matches of the row i is written in first[i + 1], so that the prefix sum gives the positions.
+
+\param sched the scheduler running the task
+\param worker the index of the worker running the task
+\param arg a void pointer to the structure containing the parameters
+
+\retval error code
+*/
+static _ERR_CODE csr_count_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	csr_params *params = (csr_params *)arg;
+	_UINT row;
+
+	for (row = params->first; row < params->last; row++)
+		params->csr->first[row + 1] = bitmatrix_row_matches(params->m, params->size_subscr, row, NULL);
+
+	return err_none;
+}
+
+
+/** \brief Task writing the matches of a band of rows (second pass of the export).
+
+\param sched the scheduler running the task
+\param worker the index of the worker running the task
+\param arg a void pointer to the structure containing the parameters
+
+\retval error code
+*/
+static _ERR_CODE csr_fill_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	csr_params *params = (csr_params *)arg;
+	_UINT row;
+
+	for (row = params->first; row < params->last; row++)
+		bitmatrix_row_matches(params->m, params->size_subscr, row, &params->csr->subscr[params->csr->first[row]]);
+
+	return err_none;
+}
+
+
+/** \brief Exports the result bit matrix as compressed sparse rows with more threads.
+
+The rows are read twice: in the first pass each task counts the matches of a band of rows (with the population count), then the positions of the rows are summed up and the list is allocated once; in the second pass each task writes the positions of the set bits of its band, in its own part of the list, so each row is already sorted.
+
+\param m the result bit matrix
+\param size_subscr the number of subscription extents
+\param out the list of matching pairs (allocated by the function, to be freed with free_match_csr())
+\param threads the maximum number of threads to be used
+
+\retval error code
+*/
+_ERR_CODE parallel_bitmatrix_to_csr(const bitmatrix m, const _UINT size_subscr, match_csr_t *out, const _UINT threads)
+{
+	_UINT i, count;
+	csr_params params[MAX_THREADS];
+	_ERR_CODE err;
+
+	out->size_update = m.rows;
+	out->subscr = NULL;
+	out->first = (size_t *)malloc(((size_t)m.rows + 1) * sizeof(size_t));
+	if (out->first == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	count = MAX(MIN(MIN(threads, MAX_THREADS), m.rows), 1);
+	for (i = 0; i < count; i++)
+	{
+		params[i].m = m;
+		params[i].size_subscr = size_subscr;
+		params[i].csr = out;
+		params[i].first = (_UINT)(((uint64_t)m.rows * i) / count);
+		params[i].last = (_UINT)(((uint64_t)m.rows * (i + 1)) / count);
+	}
+
+	// first pass: the number of matches of each row
+	err = run_tasks(csr_count_task, params, sizeof(csr_params), count);
+	if (err != err_none)
+		return err;
+
+	// the position of the first match of each row
+	out->first[0] = 0;
+	for (i = 0; i < m.rows; i++)
+		out->first[i + 1] += out->first[i];
+
+	out->count = out->first[m.rows];
+	out->subscr = (_UINT *)malloc(MAX(out->count, 1) * sizeof(_UINT));
+	if (out->subscr == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	// second pass: the matches of each row
+	return run_tasks(csr_fill_task, params, sizeof(csr_params), count);
+}
+
+
+/** \brief Transposes a range of block columns of a bit matrix.
+
+The matrices are split in square blocks of BITVEC_ELEM_BITS x BITVEC_ELEM_BITS bits, each one transposed in a local buffer. The blocks are visited in square tiles of BITMATRIX_TRANSPOSE_TILE blocks, so that the rows of a tile stay in the cache on both sides while the tile is read and written. The zero blocks are only written.
+
+\param in the bit matrix to be transposed
+\param out the transposed matrix, with out.rows equal to the columns of the input and out.width wide enough for in.rows columns
+\param first the first element of the input rows of the range (a multiple of BITMATRIX_TRANSPOSE_TILE)
+\param last one past the last element of the input rows of the range
+*/
+static void bitmatrix_transpose_range(const bitmatrix in, const bitmatrix out, const _UINT first, const _UINT last)
+{
+	_UINT tile_col, tile_row, col, row, i;
+	_UINT last_col, last_row;
+	bitvec_elem block[BITVEC_ELEM_BITS];
+	bitvec_elem any;
+
+	// for each tile (its columns are elements of the input rows, its rows are elements of the output rows)
+	for (tile_col = first; tile_col < last; tile_col += BITMATRIX_TRANSPOSE_TILE)
+	{
+		last_col = MIN(tile_col + BITMATRIX_TRANSPOSE_TILE, last);
+
+		for (tile_row = 0; tile_row < out.width; tile_row += BITMATRIX_TRANSPOSE_TILE)
+		{
+			last_row = MIN(tile_row + BITMATRIX_TRANSPOSE_TILE, out.width);
+
+			// for each block of the tile
+			for (col = tile_col; col < last_col && col * BITVEC_ELEM_BITS < out.rows; col++)
+			{
+				for (row = tile_row; row < last_row; row++)
+				{
+					// read the block (the rows after the last one are zero)
+					any = 0;
+					for (i = 0; i < BITVEC_ELEM_BITS; i++)
+					{
+						block[i] = (row * BITVEC_ELEM_BITS + i < in.rows) ? BITMATRIX_ROW(in, row * BITVEC_ELEM_BITS + i)[col] : 0;
+						any |= block[i];
+					}
+
+					if (any != 0)
+						kernels.transpose_block(block);
+
+					// write the block (the columns after the last one of the input are the padding)
+					for (i = 0; i < BITVEC_ELEM_BITS && col * BITVEC_ELEM_BITS + i < out.rows; i++)
+						BITMATRIX_ROW(out, col * BITVEC_ELEM_BITS + i)[row] = block[i];
+				}
+			}
+		}
+	}
+}
+
+
+/** \brief Arguments structure of the tasks of the transpose.
+*/
+typedef struct {
+	bitmatrix		in;				///< the bit matrix to be transposed
+	bitmatrix		out;			///< the transposed matrix
+	_UINT			first;			///< first element of the input rows of the task
+	_UINT			last;			///< one past the last element of the input rows of the task
+} transpose_params;
+
+
+/** \brief Task transposing a range of block columns of a bit matrix.
+
+\param sched the scheduler running the task
+\param worker the index of the worker running the task
+\param arg a void pointer to the structure containing the parameters
+
+\retval error code
+*/
+static _ERR_CODE transpose_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	transpose_params *params = (transpose_params *)arg;
+
+	bitmatrix_transpose_range(params->in, params->out, params->first, params->last);
+
+	return err_none;
+}
+
+
+/** \brief Transposes a bit matrix with more threads.
+
+The output has a row for each column of the input and a column for each row of the input, so the transpose of the result gives, for each subscription extent, the update extents that match it.
+Each task transposes a contiguous range of tiles of block columns, so the tasks write disjoint bands of rows of the output.
+
+\param in the bit matrix to be transposed
+\param out the transposed matrix, with out.rows equal to the columns of the input and out.width wide enough for in.rows columns
+\param threads the maximum number of threads to be used
+
+\retval error code
+*/
+_ERR_CODE parallel_bitmatrix_transpose(const bitmatrix in, const bitmatrix out, const _UINT threads)
+{
+	_UINT i, count, tiles;
+	transpose_params params[MAX_THREADS];
+
+	tiles = (in.width + BITMATRIX_TRANSPOSE_TILE - 1) / BITMATRIX_TRANSPOSE_TILE;
+	count = MAX(MIN(MIN(threads, MAX_THREADS), tiles), 1);
+
+	if (count == 1)
+	{
+		bitmatrix_transpose_range(in, out, 0, in.width);
+		return err_none;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		params[i].in = in;
+		params[i].out = out;
+		params[i].first = (tiles * i / count) * BITMATRIX_TRANSPOSE_TILE;
+		params[i].last = MIN((tiles * (i + 1) / count) * BITMATRIX_TRANSPOSE_TILE, in.width);
+	}
+
+	return run_tasks(transpose_task, params, sizeof(transpose_params), count);
+}
+
+
+/** \brief Fills the endpoints list with the values of a range of extents for a given dimension.
+
+The extents are numbered as in the list: from 0 to size_subscr - 1 the subscription extents, from size_subscr to size_subscr + size_update - 1 the update extents. The endpoints of the extent k are written in the positions 2k and 2k + 1 of the list, so that disjoint ranges can be filled at the same time.
+
+\param data the data set.
+\param out the pointer to the list to be filled
+\param dimension the number of the dimension to be processed
+\param first the first extent of the range
+\param last one past the last extent of the range
+*/
+void set_endpoints_range(const match_data_t data, const list_ptr out, const _UINT dimension, const _UINT first, const _UINT last)
+{
+	_UINT i, count;
+	endpoints_t ep;
+
+	count = first * 2;
+
+	for (i = first; i < last; i++)
+	{
+		// IDs of update extents in the "list" follow the IDs of subscription extents
+		// this way is possible to distinguish subscription and update extents without having to store another variable
+		if (i < data.size_subscr)
+			ep = data.subscr[i].endpoints[dimension];
+		else
+			ep = data.update[i - data.size_subscr].endpoints[dimension];
+
+		out[count].id = i;
+		out[count].is_lower_point = TRUE;
+
+#ifdef __SUPERSET
+		if (ep.lower > SPACE_TYPE_MIN)
+			out[count++].point = ep.lower - SPACE_TYPE_INC;
+		else
+#endif // __SUPERSET
+			out[count++].point = ep.lower;
+
+		out[count].id = i;
+		out[count].is_lower_point = FALSE;
+
+#ifdef __SUPERSET
+		if (ep.upper < SPACE_TYPE_MAX)
+			out[count++].point = ep.upper + SPACE_TYPE_INC;
+		else
+#endif // __SUPERSET
+			out[count++].point = ep.upper;
+	}
+}
+
+
+/** \brief Fills the endpoints list with the values for a given dimension.
+
+\param data the data set.
+\param out the pointer to the list to be filled
+\param dimension the number of the dimension to be processed
+*/
+void set_endpoints_list(const match_data_t data, const list_ptr out, const _UINT dimension)
+{
+	set_endpoints_range(data, out, dimension, 0, data.size_subscr + data.size_update);
+}
+
+
+/** \brief Rule for qsort() ordering.
+
+\remarks If two extents with zero-width have the same coordinates, they should overlap.
+
+\param a pointer to the first element to compare
+\param b pointer to the second element to compare
+
+\retval -1 if a < b or a == b and a is lower point
+\retval 1 if a > b or a == b and a is upper point
+*/
+_INT compare_endpoints(const void *a, const void *b)
+{
+	SPACE_TYPE x = (*(list_ptr)a).point;
+	SPACE_TYPE y = (*(list_ptr)b).point;
+
+#ifdef __SUPERSET
+	return (x < y) ? -1 : (x > y) ? 1 : 0;
+#else // __SUPERSET
+	return (x < y) ? -1 : (x > y) ? 1 : ((*(list_ptr)a).is_lower_point) ? -1 : 1;
+#endif // __SUPERSET
+}
+
+
+/** \brief Order-preserving key of an endpoint.
+
+Maps the point of the endpoint to an unsigned integer with the same ordering, so that comparing two keys is the same as applying compare_endpoints() to their endpoints.
+
+\remarks -0.0 and +0.0 are given the same key, since they compare equal.
+
+\param ep pointer to the endpoint
+
+\retval the key of the endpoint
+*/
+static INLINE uint64_t endpoint_key(const list_t *ep)
+{
+	uint64_t key;
+#if SPACE_TYPE_SELECT == 1
+	key = (uint32_t)ep->point ^ 0x80000000U;
+#elif SPACE_TYPE_SELECT == 2
+	key = (uint64_t)ep->point ^ 0x8000000000000000ULL;
+#elif SPACE_TYPE_SELECT == 3
+	uint32_t bits = 0;
+
+	if (ep->point != 0)
+		memcpy(&bits, &ep->point, sizeof(bits));
+	// negative values have all the bits flipped, positive values only the sign bit
+	key = (bits & 0x80000000U) ? (uint32_t)~bits : (bits | 0x80000000U);
+#elif SPACE_TYPE_SELECT == 4
+	uint64_t bits = 0;
+
+	if (ep->point != 0)
+		memcpy(&bits, &ep->point, sizeof(bits));
+	// negative values have all the bits flipped, positive values only the sign bit
+	key = (bits & 0x8000000000000000ULL) ? ~bits : (bits | 0x8000000000000000ULL);
+#endif // SPACE_TYPE_SELECT
+
+#ifdef RADIX_TIE_IN_KEY
+	// lower points go before upper points with the same coordinates
+	key = (key << 1) | (ep->is_lower_point ? 0 : 1);
+#endif // RADIX_TIE_IN_KEY
+
+	return key;
+}
+
+
+/** \brief LSD radix sort of the endpoints list.
+
+The list is sorted RADIX_DIGIT_BITS bits of endpoint_key() at a time, moving the elements between the list and a scratch list. The histograms of all the passes are computed in a single scan and the passes where all the elements have the same digit are skipped.
+
+\param ep_list the endpoints list to be ordered
+\param size the size of the list
+
+\retval TRUE if the list has been sorted
+\retval FALSE if the scratch list couldn't be allocated
+*/
+static _BOOL radix_sort_list(const list_ptr ep_list, const _UINT size)
+{
+	_UINT i, pass;
+	_UINT hist[RADIX_PASSES][RADIX_BUCKETS];
+	_UINT sum, count;
+	uint64_t key;
+	list_ptr src, dst, tmp;
+#ifdef RADIX_TIE_PASS
+	_UINT lower_count, lower_pos, upper_pos;
+#endif // RADIX_TIE_PASS
+
+	if (size < 2)
+		return TRUE;
+
+	dst = (list_ptr)malloc(size * sizeof(list_t));
+	if (dst == NULL)
+		return FALSE;
+	src = ep_list;
+
+	// compute the histograms of all the passes
+	memset(hist, 0, sizeof(hist));
+#ifdef RADIX_TIE_PASS
+	lower_count = 0;
+#endif // RADIX_TIE_PASS
+	for (i = 0; i < size; i++)
+	{
+		key = endpoint_key(&src[i]);
+		for (pass = 0; pass < RADIX_PASSES; pass++)
+			hist[pass][(key >> (pass * RADIX_DIGIT_BITS)) & (RADIX_BUCKETS - 1)]++;
+#ifdef RADIX_TIE_PASS
+		if (src[i].is_lower_point)
+			lower_count++;
+#endif // RADIX_TIE_PASS
+	}
+
+#ifdef RADIX_TIE_PASS
+	// least significant digit: stable partition of lower points before upper points
+	if (lower_count > 0 && lower_count < size)
+	{
+		lower_pos = 0;
+		upper_pos = lower_count;
+		for (i = 0; i < size; i++)
+		{
+			if (src[i].is_lower_point)
+				dst[lower_pos++] = src[i];
+			else
+				dst[upper_pos++] = src[i];
+		}
+
+		tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+#endif // RADIX_TIE_PASS
+
+	for (pass = 0; pass < RADIX_PASSES; pass++)
+	{
+		// skip the pass if every element falls in the same bucket
+		key = endpoint_key(&src[0]);
+		if (hist[pass][(key >> (pass * RADIX_DIGIT_BITS)) & (RADIX_BUCKETS - 1)] == size)
+			continue;
+
+		// exclusive prefix sum: first position of each bucket
+		sum = 0;
+		for (i = 0; i < RADIX_BUCKETS; i++)
+		{
+			count = hist[pass][i];
+			hist[pass][i] = sum;
+			sum += count;
+		}
+
+		// stable scatter of the elements in their buckets
+		for (i = 0; i < size; i++)
+		{
+			key = endpoint_key(&src[i]);
+			dst[hist[pass][(key >> (pass * RADIX_DIGIT_BITS)) & (RADIX_BUCKETS - 1)]++] = src[i];
+		}
+
+		tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	// if the sorted data is in the scratch list copy it back
+	if (src != ep_list)
+	{
+		memcpy(ep_list, src, size * sizeof(list_t));
+		dst = src;
+	}
+
+	free(dst);
+
+	return TRUE;
+}
+
+
+/** \brief Sorting function.
+
+The list is sorted with the algorithm selected in the global options: the radix sort or a call to stdlib.h's qsort() function with compare_endpoints() as ordering rule.
+
+\remarks If the radix sort can't allocate its scratch memory the list is sorted with qsort().
+
+\param ep_list the endpoints list to be ordered
+\param size the size of the list
+*/
+void sort_list(const list_ptr ep_list, const _UINT size)
+{
+	if (OPT_VAR.sort_algo == sort_radix && radix_sort_list(ep_list, size))
+		return;
+
+	qsort(ep_list, size, sizeof(list_t), compare_endpoints);
+}
+
+
+/** \brief Number of processors.
+
+\retval the number of online processors (at least 1)
+*/
+_UINT get_cpu_count()
+{
+#ifdef _MSC_VER
+	SYSTEM_INFO info;
+
+	GetSystemInfo(&info);
+
+	return MAX(1, (_UINT)info.dwNumberOfProcessors);
+#else // _MSC_VER
+	long count;
+
+	count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return (count > 0) ? (_UINT)count : 1;
+#endif // _MSC_VER
+}
+
+
+/** \brief Number of threads to be used on a list.
+
+\param size the size of the list
+\param threads the number of threads requested
+
+\retval the number of threads, so that each thread gets at least MIN_LIST_CHUNK endpoints
+*/
+static _UINT list_thread_count(const _UINT size, const _UINT threads)
+{
+	_UINT count;
+
+	count = MIN(threads, size / MIN_LIST_CHUNK);
+	count = MIN(count, MAX_LIST_THREADS);
+
+	return MAX(count, 1);
+}
+
+
+/** \brief Arguments structure of the tasks working on the endpoints list.
+*/
+typedef struct {
+	match_data_t	data;			///< data of the problem
+	_UINT			dimension;		///< dimension to be processed
+	list_ptr		src;			///< list read by the thread
+	list_ptr		dst;			///< list written by the thread
+	_UINT			first;			///< first element of the chunk of the thread
+	_UINT			last;			///< one past the last element of the chunk of the thread
+	_INT			pass;			///< radix sort pass (-1 for the tie rule pass)
+	_UINT			*hist;			///< histogram or, before the scatter, first position of each bucket for the chunk
+} list_thread_params;
+
+
+/** \brief Splits a range of elements in chunks, one for each thread.
+
+\param params array of arguments, one for each thread
+\param size the number of elements
+\param threads the number of threads
+*/
+static void split_list_chunks(list_thread_params *params, const _UINT size, const _UINT threads)
+{
+	_UINT i;
+
+	for (i = 0; i < threads; i++)
+	{
+		params[i].first = (_UINT)(((uint64_t)size * i) / threads);
+		params[i].last = (_UINT)(((uint64_t)size * (i + 1)) / threads);
+	}
+}
+
+
+/** \brief Task filling a chunk of the endpoints list.
+
+\param sched the scheduler running the task
+\param worker the index of the worker running the task
+\param arg a void pointer to the structure containing the parameters
+
+\retval error code
+*/
+static _ERR_CODE fill_list_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	list_thread_params *params = (list_thread_params *)arg;
+
+	set_endpoints_range(params->data, params->dst, params->dimension, params->first, params->last);
+
+	return err_none;
+}
+
+
+/** \brief Multi-threaded version of set_endpoints_list().
+
+Each thread fills the endpoints of a contiguous range of extents.
+
+\param data the data set.
+\param out the pointer to the list to be filled
+\param dimension the number of the dimension to be processed
+\param threads the maximum number of threads to be used
+
+\retval error code
+*/
+_ERR_CODE parallel_set_endpoints_list(const match_data_t data, const list_ptr out, const _UINT dimension, const _UINT threads)
+{
+	_UINT i, count, extents;
+	list_thread_params params[MAX_LIST_THREADS];
+
+	extents = data.size_subscr + data.size_update;
+	count = list_thread_count(extents * 2, threads);
+
+	if (count == 1)
+	{
+		set_endpoints_list(data, out, dimension);
+		return err_none;
+	}
+
+	split_list_chunks(params, extents, count);
+	for (i = 0; i < count; i++)
+	{
+		params[i].data = data;
+		params[i].dimension = dimension;
+		params[i].dst = out;
+	}
+
+	return run_tasks(fill_list_task, params, sizeof(list_thread_params), count);
+}
+
+
+/** \brief Digit of an endpoint in a given pass of the radix sort.
+
+\param ep pointer to the endpoint
+\param pass the pass of the radix sort (-1 for the tie rule pass)
+
+\retval the bucket of the endpoint
+*/
+static INLINE _UINT radix_digit(const list_t *ep, const _INT pass)
+{
+	if (pass < 0)
+		return ep->is_lower_point ? 0 : 1;
+
+	return (_UINT)(endpoint_key(ep) >> (pass * RADIX_DIGIT_BITS)) & (RADIX_BUCKETS - 1);
+}
+
+
+/** \brief Task computing the histogram of its chunk for a pass of the radix sort.
+
+\param sched the scheduler running the task
+\param worker the index of the worker running the task
+\param arg a void pointer to the structure containing the parameters
+
+\retval error code
+*/
+static _ERR_CODE radix_histogram_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	_UINT i;
+	list_thread_params *params = (list_thread_params *)arg;
+
+	memset(params->hist, 0, RADIX_BUCKETS * sizeof(_UINT));
+	for (i = params->first; i < params->last; i++)
+		params->hist[radix_digit(&params->src[i], params->pass)]++;
+
+	return err_none;
+}
+
+
+/** \brief Task moving the elements of its chunk in their buckets for a pass of the radix sort.
+
+\param sched the scheduler running the task
+\param worker the index of the worker running the task
+\param arg a void pointer to the structure containing the parameters
+
+\retval error code
+*/
+static _ERR_CODE radix_scatter_task(scheduler_t *sched, const _UINT worker, void *arg)
+{
+	_UINT i;
+	list_thread_params *params = (list_thread_params *)arg;
+
+	for (i = params->first; i < params->last; i++)
+		params->dst[params->hist[radix_digit(&params->src[i], params->pass)]++] = params->src[i];
+
+	return err_none;
+}
+
+
+/** \brief Multi-threaded version of sort_list().
+
+Each pass of the radix sort is split in two parallel steps: every thread computes the histogram of its chunk of the list, then, after the bucket positions of each chunk are computed, every thread moves its elements in the scratch list. Since the chunks are in order, and so are the positions given to them inside each bucket, each pass is stable.
+
+\remarks With qsort(), with too few elements for more than one thread, or if the scratch list can't be allocated the list is sorted by sort_list().
+
+\param ep_list the endpoints list to be ordered
+\param size the size of the list
+\param threads the maximum number of threads to be used
+
+\retval error code
+*/
+_ERR_CODE parallel_sort_list(const list_ptr ep_list, const _UINT size, const _UINT threads)
+{
+	_UINT i, t, count;
+	_UINT sum, chunk_size, bucket_size;
+	_INT pass;
+	_BOOL skip;
+	_UINT *hist;
+	list_ptr src, dst, tmp;
+	list_thread_params params[MAX_LIST_THREADS];
+	_ERR_CODE err = err_none;
+
+	count = list_thread_count(size, threads);
+
+	if (count == 1 || OPT_VAR.sort_algo != sort_radix)
+	{
+		sort_list(ep_list, size);
+		return err_none;
+	}
+
+	dst = (list_ptr)malloc(size * sizeof(list_t));
+	hist = (_UINT *)malloc(count * RADIX_BUCKETS * sizeof(_UINT));
+	if (dst == NULL || hist == NULL)
+	{
+		free(dst);
+		free(hist);
+		sort_list(ep_list, size);
+		return err_none;
+	}
+	src = ep_list;
+
+	split_list_chunks(params, size, count);
+	for (t = 0; t < count; t++)
+		params[t].hist = &hist[t * RADIX_BUCKETS];
+
+#ifdef RADIX_TIE_PASS
+	for (pass = -1; pass < RADIX_PASSES; pass++)
+#else // RADIX_TIE_PASS
+	for (pass = 0; pass < RADIX_PASSES; pass++)
+#endif // RADIX_TIE_PASS
+	{
+		for (t = 0; t < count; t++)
+		{
+			params[t].src = src;
+			params[t].dst = dst;
+			params[t].pass = pass;
+		}
+
+		err = run_tasks(radix_histogram_task, params, sizeof(list_thread_params), count);
+		if (err != err_none)
+			break;
+
+		// exclusive prefix sum in bucket-major order: first position of each bucket in each chunk
+		skip = FALSE;
+		sum = 0;
+		for (i = 0; i < RADIX_BUCKETS && !skip; i++)
+		{
+			bucket_size = 0;
+			for (t = 0; t < count; t++)
+			{
+				chunk_size = hist[t * RADIX_BUCKETS + i];
+				hist[t * RADIX_BUCKETS + i] = sum;
+				sum += chunk_size;
+				bucket_size += chunk_size;
+			}
+			// skip the pass if every element falls in the same bucket
+			skip = (bucket_size == size);
+		}
+		if (skip)
+			continue;
+
+		err = run_tasks(radix_scatter_task, params, sizeof(list_thread_params), count);
+		if (err != err_none)
+			break;
+
+		tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	// if the sorted data is in the scratch list copy it back
+	if (src != ep_list)
+	{
+		memcpy(ep_list, src, size * sizeof(list_t));
+		dst = src;
+	}
+
+	free(dst);
+	free(hist);
+
+	return err;
+}
+
+
+#ifdef __VERBOSE
+/** \brief Printing function.
+
+This function prints the bit matrix.
+
+\param in the bit matrix to be printed
+*/
+#include <stdio.h>
+void print_bitmatrix(const bitmatrix in)
+{
+	_UINT i, j, bit;
+	_BYTE element[BITVEC_ELEM_BITS + 1];
+	bitvec_elem val;
+	bitvec_elem mask;
+	bitvector row;
+
+	// escape the string
+	element[BITVEC_ELEM_BITS] = '\0';
+
+	// for each line (update extent)
+	for (i = 0; i < in.rows; i++)
+	{
+		row = BITMATRIX_ROW(in, i);
+
+		// for each element in the line (the padding of the row isn't printed)
+		for (j = 0; j < in.width; j++)
+		{
+			mask = BITVEC_ELEM_MAX_BIT;
+			val = row[j];
+
+			// for each bit in the element
+			for (bit = 0; bit < BITVEC_ELEM_BITS; bit++)
+			{
+				// if the actual bit is TRUE, set the char to '1', else set it to '0'
+				element[bit] = (val & mask ? '1' : '0');
+				// shift right
+				mask >>= 1;
+			}
+
+			// print the string
+			printf("%s ", element);
+		}
+
+		// new line
+		printf("\n");
+	}
+}
+/** \brief Printing function for the matching pairs.
+
+This function prints, for each update extent, the list of matching subscription extents.
+
+\param in the list of matching pairs
+*/
+void print_match_csr(const match_csr_t *in)
+{
+	_UINT i;
+	size_t j;
+
+	// for each line (update extent)
+	for (i = 0; i < in->size_update; i++)
+	{
+		printf("%u:", i);
+
+		// for each matching subscription extent
+		for (j = in->first[i]; j < in->first[i + 1]; j++)
+			printf(" %u", in->subscr[j]);
+
+		// new line
+		printf("\n");
+	}
+}
+#endif // __VERBOSE
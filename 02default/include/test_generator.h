@@ -32,6 +32,8 @@ This file contains the functions used to generate data sets for testing purposes
 
 _ERR_CODE test_generator(match_data_t *out, const _UINT updates, const _UINT subscrs, const _UINT dimensions);
 _ERR_CODE test_generator_random(match_data_t *out, const _UINT updates, const _UINT subscrs, const _UINT dimensions);
+_ERR_CODE test_generator_move(match_data_t *data);
+_ERR_CODE test_generator_move_extent(extent_t *extent, const _UINT dimensions);
 
 
 #endif // __HEADER_H
@@ -32,7 +32,37 @@ The file matching.c contains the main matching algorithm functions.
 
 
 _ERR_CODE sort_matching(const match_data_t data, const bitmatrix out);
-void sort_matching_1D(const list_ptr ep_list, const bitmatrix out, const bitvector subscr_set_before, const bitvector subscr_set_after, const _UINT size_update, const _UINT size_subscr);
+void sort_matching_self_1D(const list_ptr ep_list, const bitmatrix_tri_t out, const bitvector set_before, const bitvector set_after, const _UINT size);
+_ERR_CODE sort_matching_self(const match_data_t data, const bitmatrix_tri_t out);
+#ifdef __LOWMEM
+_ERR_CODE sort_matching_store(const match_data_t data, const bitmatrix out, store_header_t *header);
+#endif // __LOWMEM
+void match_context_init(match_context_t *ctx);
+_ERR_CODE match_context_reserve(match_context_t *ctx, const _UINT size_update, const _UINT size_subscr, const _UINT dimensions);
+_ERR_CODE sort_matching_context(match_context_t *ctx, const match_data_t data);
+void match_context_free(match_context_t *ctx);
+void sort_matching_1D(const list_ptr ep_list, const bitmatrix out, const bitvector skip, const bitvector subscr_set_before, const bitvector subscr_set_after, const _UINT size_update, const _UINT size_subscr);
+void sort_matching_1D_tiled(const list_ptr ep_list, const bitmatrix out, const bitvector skip, const bitvector subscr_set_before, const bitvector subscr_set_after, const _UINT size_update, const _UINT size_subscr, const _UINT tile_width);
+
+_ERR_CODE lazy_rows_build(const list_ptr ep_list, lazy_rows_t *rows, const _UINT size_update, const _UINT size_subscr, const _UINT interval);
+void lazy_rows_materialize(const lazy_rows_t *rows, const _UINT update, const bitvector line);
+void lazy_rows_free(lazy_rows_t *rows);
+_ERR_CODE sort_matching_1D_lazy(const list_ptr ep_list, const bitmatrix out, const bitvector skip, const _UINT size_update, const _UINT size_subscr, const _UINT interval);
+
+_ERR_CODE sort_matching_pairs(const match_data_t data, match_csr_t *out);
+_ERR_CODE sort_matching_sparse(const match_data_t data, match_sparse_t *out);
+
+_ERR_CODE persistent_matching_init(persistent_state_t *state, const match_data_t data, const bitmatrix out);
+_ERR_CODE persistent_matching_update(persistent_state_t *state, const match_data_t data, const bitmatrix out);
+void persistent_matching_free(persistent_state_t *state);
+
+_ERR_CODE match_index_init(match_index_t *index, const _UINT dimensions, const _UINT capacity_update, const _UINT capacity_subscr);
+_ERR_CODE match_index_add_update(match_index_t *index, const extent_t *extent, _UINT *id);
+_ERR_CODE match_index_remove_update(match_index_t *index, const _UINT id);
+_ERR_CODE match_index_add_subscr(match_index_t *index, const extent_t *extent, _UINT *id);
+_ERR_CODE match_index_remove_subscr(match_index_t *index, const _UINT id);
+_ERR_CODE match_index_modify_extent(match_index_t *index, const _BOOL is_update, const _UINT id, const extent_t *extent);
+void match_index_free(match_index_t *index);
 
 
 #endif // __MATCHING_H
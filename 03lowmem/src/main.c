@@ -49,12 +49,261 @@
 */
 
 
+/** \brief Prints the usage of the program.
+
+\param prog_name the name of the executable
+*/
+void print_synopsis(const char *prog_name)
+{
+	printf("\nSYNOPSIS:\n\n");
+	printf("%s <updates> <subscriptions> <dimensions> [options]\n\n", FILENAME(prog_name));
+	printf("OPTIONS:\n\n");
+	printf("--sort=<radix|qsort>\talgorithm used to sort the endpoints (default: radix)\n");
+	printf("--fold-not\t\tfold the NOT of the first dimension into the combine pass of the second one\n");
+	printf("--summary\t\tkeep an occupancy summary of the result to skip the lines and blocks without matches\n");
+	printf("--csr\t\t\talso export the result as compressed sparse rows (the subscription extents matching each update)\n");
+	printf("--transpose\t\talso build the subscription-major matrix of the result (the update extents matching each subscription)\n");
+	printf("--simd=<scalar|sse2|avx2|avx512>\tinstruction set of the bitwise kernels (default: best supported)\n");
+	printf("--tile=<n>\t\tsweep the subscription extents in tiles of n columns (rounded up to %d)\n", BITVEC_LANE_BITS);
+	printf("--checkpoint=<n>\tbuild the lines in row order from snapshots of the sets taken every n subscription endpoints\n");
+	printf("--engine=<matrix|pairs|sparse>\tmatching engine: bit matrix, list of matching pairs or compressed rows (default: matrix)\n");
+	printf("--ticks=<n>\t\tpersistent mode: move the extents and match them again n times\n");
+	printf("--changes=<n>\t\tincremental mode: add the extents to an index one at a time, then move them one at a time n times\n");
+	printf("--removes=<n>\t\tincremental mode: then remove n extents of each type from the index and add them back, with their identifiers\n");
+	printf("--seed=<n>\t\tseed of the random data set, to generate the same data set at each run\n");
+	printf("--self\t\t\tmatch the update extents against themselves, computing only the upper triangle of the result (updates and subscriptions must be as many)\n");
+	printf("--pages=<default|thp|huge>\tpages of the bit matrices: default, transparent huge pages or explicit huge pages (default: default)\n");
+	printf("--prefault\t\ttouch the pages of the bit matrices when they are allocated, before the timer starts\n");
+	printf("--numa=<default|interleave>\tNUMA placement of the bit matrices: first touch or interleaved on all the nodes (default: default)\n");
+#ifdef __LOWMEM
+	printf("--store=<file>\t\tkeep the result in a matrix mapped on a file and match it in bands of rows (for results bigger than the memory)\n");
+	printf("--band=<n>\t\trows of a band of the matrix mapped on a file (default: %d MB of rows)\n", STORE_BAND_SIZE / (1024 * 1024));
+	printf("--resume\t\tresume the matching of the matrix mapped on a file after its last complete band\n");
+#endif // __LOWMEM
+	printf("\n");
+}
+
+
+/** \brief Prints the memory options that differ from the default ones.
+
+\param fout the file
+*/
+void print_memory_options(FILE *fout)
+{
+	if (OPT_VAR.pages == pages_thp)
+		fprintf(fout, "\tpages=thp");
+	else if (OPT_VAR.pages == pages_huge)
+		fprintf(fout, "\tpages=huge");
+
+	if (OPT_VAR.prefault)
+		fprintf(fout, "\tprefault");
+
+	if (OPT_VAR.numa == numa_interleave)
+		fprintf(fout, "\tnuma=interleave");
+}
+
+
+/** \brief Parses the optional arguments and sets the global options.
+
+\param argc the number of optional arguments
+\param argv the array of optional arguments
+
+\retval error code
+*/
+_ERR_CODE parse_options(const int argc, char *argv[])
+{
+	int i;
+
+	for (i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--sort=radix") == 0)
+			OPT_VAR.sort_algo = sort_radix;
+		else if (strcmp(argv[i], "--sort=qsort") == 0)
+			OPT_VAR.sort_algo = sort_qsort;
+		else if (strcmp(argv[i], "--fold-not") == 0)
+			OPT_VAR.fold_not = TRUE;
+		else if (strcmp(argv[i], "--summary") == 0)
+			OPT_VAR.summary = TRUE;
+		else if (strcmp(argv[i], "--transpose") == 0)
+			OPT_VAR.transpose = TRUE;
+		else if (strcmp(argv[i], "--csr") == 0)
+			OPT_VAR.csr = TRUE;
+		else if (strcmp(argv[i], "--self") == 0)
+			OPT_VAR.self = TRUE;
+		else if (strcmp(argv[i], "--simd=scalar") == 0)
+			OPT_VAR.simd = simd_scalar;
+		else if (strcmp(argv[i], "--simd=sse2") == 0)
+			OPT_VAR.simd = simd_sse2;
+		else if (strcmp(argv[i], "--simd=avx2") == 0)
+			OPT_VAR.simd = simd_avx2;
+		else if (strcmp(argv[i], "--simd=avx512") == 0)
+			OPT_VAR.simd = simd_avx512;
+		else if (strncmp(argv[i], "--tile=", 7) == 0 && atoi(argv[i] + 7) > 0)
+			OPT_VAR.tile = BIT_VEC_WIDTH(atoi(argv[i] + 7)) * BITVEC_ELEM_BITS;
+		else if (strncmp(argv[i], "--checkpoint=", 13) == 0 && atoi(argv[i] + 13) > 0)
+			OPT_VAR.checkpoint = atoi(argv[i] + 13);
+		else if (strcmp(argv[i], "--engine=matrix") == 0)
+			OPT_VAR.engine = engine_matrix;
+		else if (strcmp(argv[i], "--engine=pairs") == 0)
+			OPT_VAR.engine = engine_pairs;
+		else if (strcmp(argv[i], "--engine=sparse") == 0)
+			OPT_VAR.engine = engine_sparse;
+		else if (strncmp(argv[i], "--ticks=", 8) == 0 && atoi(argv[i] + 8) > 0)
+			OPT_VAR.ticks = atoi(argv[i] + 8);
+		else if (strncmp(argv[i], "--changes=", 10) == 0 && atoi(argv[i] + 10) > 0)
+			OPT_VAR.changes = atoi(argv[i] + 10);
+		else if (strncmp(argv[i], "--removes=", 10) == 0 && atoi(argv[i] + 10) > 0)
+			OPT_VAR.removes = atoi(argv[i] + 10);
+		else if (strncmp(argv[i], "--seed=", 7) == 0 && atoi(argv[i] + 7) > 0)
+			OPT_VAR.seed = atoi(argv[i] + 7);
+		else if (strcmp(argv[i], "--pages=default") == 0)
+			OPT_VAR.pages = pages_default;
+		else if (strcmp(argv[i], "--pages=thp") == 0)
+			OPT_VAR.pages = pages_thp;
+		else if (strcmp(argv[i], "--pages=huge") == 0)
+			OPT_VAR.pages = pages_huge;
+		else if (strcmp(argv[i], "--prefault") == 0)
+			OPT_VAR.prefault = TRUE;
+		else if (strcmp(argv[i], "--numa=default") == 0)
+			OPT_VAR.numa = numa_default;
+#ifdef __linux__
+		else if (strcmp(argv[i], "--numa=interleave") == 0)
+			OPT_VAR.numa = numa_interleave;
+#endif // __linux__
+#ifdef __LOWMEM
+		else if (strncmp(argv[i], "--store=", 8) == 0 && argv[i][8] != '\0')
+			OPT_VAR.store = argv[i] + 8;
+		else if (strncmp(argv[i], "--band=", 7) == 0 && atoi(argv[i] + 7) > 0)
+			OPT_VAR.band = atoi(argv[i] + 7);
+		else if (strcmp(argv[i], "--resume") == 0)
+			OPT_VAR.resume = TRUE;
+#endif // __LOWMEM
+		else
+		{
+			printf("\nNot a valid option: %s\n", argv[i]);
+			return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+		}
+	}
+
+	// the persistent mode works only on the bit matrix
+	if (OPT_VAR.ticks > 0 && OPT_VAR.engine != engine_matrix)
+	{
+		printf("\nThe persistent mode needs the matrix engine.\n");
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	// the transpose and the export work only on the bit matrix
+	if ((OPT_VAR.transpose || OPT_VAR.csr) && OPT_VAR.engine != engine_matrix)
+	{
+		printf("\nThe transpose and the export need the matrix engine.\n");
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	// the out-of-core matching sweeps the bands of the bit matrix once (and the summary would be resident)
+	if (OPT_VAR.store != NULL && (OPT_VAR.engine != engine_matrix || OPT_VAR.ticks > 0 || OPT_VAR.summary))
+	{
+		printf("\nThe matrix on a file needs the matrix engine, without the persistent mode and the summary.\n");
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	if (OPT_VAR.store == NULL && (OPT_VAR.band > 0 || OPT_VAR.resume))
+	{
+		printf("\nThe bands and the resume need the matrix on a file.\n");
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	// the self-matching has its own sweep and its own result
+	if (OPT_VAR.self && (OPT_VAR.engine != engine_matrix || OPT_VAR.ticks > 0 || OPT_VAR.store != NULL || OPT_VAR.summary || OPT_VAR.fold_not
+		|| OPT_VAR.transpose || OPT_VAR.csr || OPT_VAR.tile > 0 || OPT_VAR.checkpoint > 0))
+	{
+		printf("\nThe self-matching needs the matrix engine with the standard sweep, without other modes and outputs.\n");
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	// the incremental index keeps its own result, which is matched one row or column at a time
+	if ((OPT_VAR.changes > 0 || OPT_VAR.removes > 0) && (OPT_VAR.engine != engine_matrix || OPT_VAR.ticks > 0 || OPT_VAR.store != NULL || OPT_VAR.self || OPT_VAR.summary
+		|| OPT_VAR.fold_not || OPT_VAR.tile > 0 || OPT_VAR.checkpoint > 0))
+	{
+		printf("\nThe incremental mode needs the matrix engine, without the other modes and sweeps.\n");
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	// the tiled sweep and the checkpointed sweep are alternative ways to build the lines
+	if (OPT_VAR.tile > 0 && OPT_VAR.checkpoint > 0)
+	{
+		printf("\nThe tiled sweep can't be used with the checkpointed sweep.\n");
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	// select the bitwise kernels for this processor
+	OPT_VAR.simd = select_bitwise_kernels();
+
+	return err_none;
+}
+
+
+/** \brief Removes some extents of one type from the incremental index, then adds them back in the reverse order.
+
+The identifiers of the removed extents are recycled in the reverse order of the removals, so each extent must take back its own identifier (and its row or column of the result).
+
+\param index the incremental index
+\param extents the extents of the type
+\param size the number of extents of the type
+\param is_update are the extents update extents (or subscription extents)?
+\param count the number of extents to be removed, spread over the identifiers
+
+\retval error code
+*/
+_ERR_CODE remove_extents(match_index_t *index, const extent_t *extents, const _UINT size, const _BOOL is_update, const _UINT count)
+{
+	_UINT i;
+	_UINT id, removed;
+	_UINT removes;
+	_ERR_CODE err;
+
+	removes = MIN(count, size);
+
+	for (i = 0; i < removes; i++)
+	{
+		removed = (_UINT)(((uint64_t)size * i) / removes);
+		err = is_update ? match_index_remove_update(index, removed) : match_index_remove_subscr(index, removed);
+		if (err != err_none)
+			return err;
+	}
+
+	for (i = removes; i > 0; i--)
+	{
+		removed = (_UINT)(((uint64_t)size * (i - 1)) / removes);
+		err = is_update ? match_index_add_update(index, &extents[removed], &id) : match_index_add_subscr(index, &extents[removed], &id);
+		if (err != err_none)
+			return err;
+
+		if (id != removed)
+			return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	return err_none;
+}
+
+
 /** \brief Main function.
 */
 int main(int argc, char *argv[])
 {
 	bitmatrix result;
+	bitmatrix transposed;
+	match_csr_t pairs;
+	match_csr_t rows;
+	match_sparse_t sparse;
 	match_data_t data;
+	persistent_state_t state;
+	match_index_t index;
+	match_context_t ctx;
+	bitmatrix_tri_t self;
+	store_header_t *header;
+	size_t size;
+	_UINT tick;
+	_UINT id;
 	_INT updates;
 	_INT subscrs;
 	_INT dimensions;
@@ -64,10 +313,9 @@ int main(int argc, char *argv[])
 	clock_t start, end;
 #endif // __TEST
 
-	if ((argc == 2 && strcmp(argv[1], "--help") == 0) || argc != 4)
+	if ((argc == 2 && strcmp(argv[1], "--help") == 0) || argc < 4)
 	{
-		printf("\nSYNOPSIS:\n\n");
-		printf("%s <updates> <subscriptions> <dimensions>\n\n", FILENAME(argv[0]));
+		print_synopsis(argv[0]);
 		
 		return (int)err_none;
 	}
@@ -88,6 +336,18 @@ int main(int argc, char *argv[])
 		return (int)print_error_string();
 	}
 
+	// set the options that follow the mandatory arguments
+	if (parse_options(argc - 4, &argv[4]) != err_none)
+		return (int)print_error_string();
+
+	// the self-matching is compared with the matching of as many updates and subscriptions
+	if (OPT_VAR.self && updates != subscrs)
+	{
+		printf("\nThe self-matching needs as many update extents as subscription extents.\n");
+		set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+		return (int)print_error_string();
+	}
+
 #ifdef __RANDOM_SET
 	// generate a random data set
 	if (test_generator_random(&data, updates, subscrs, dimensions) != err_none)
@@ -97,17 +357,142 @@ int main(int argc, char *argv[])
 #endif // __RANDOM_SET
 		return (int)print_error_string();
 
+	// the bit matrices of the result must fit in the physical memory, unless the result is mapped on a file
+	if (OPT_VAR.engine == engine_matrix && OPT_VAR.store == NULL && !OPT_VAR.self)
+	{
+		size = bitmatrix_layout(&result, NULL, data.size_update, data.size_subscr);
+#ifndef __LOWMEM
+		// the dimensions after the first one are matched on a second bit matrix
+		if (data.dimensions > 1)
+			size *= 2;
+#endif // __LOWMEM
+		if (size > memory_physical() && memory_physical() > 0)
+			printf("\nThe result needs %llu MB, more than the physical memory: the matching is going to swap (see --store in the lowmem builds, or --engine=sparse).\n", (unsigned long long)(size / (1024 * 1024)));
+	}
+
+	// allocate the buffers of the matching outside of the timed part
+	match_context_init(&ctx);
+	if (OPT_VAR.engine == engine_matrix && OPT_VAR.ticks == 0 && OPT_VAR.store == NULL && !OPT_VAR.self && OPT_VAR.changes == 0 && OPT_VAR.removes == 0
+		&& match_context_reserve(&ctx, data.size_update, data.size_subscr, data.dimensions) != err_none)
+		return (int)print_error_string();
+
+	// allocate the result bit matrix of the persistent mode
+	if (OPT_VAR.ticks > 0 && create_bit_matrix(&result, data.size_update, data.size_subscr) != err_none)
+		return (int)print_error_string();
+
+	// map the result bit matrix on its backing file
+	if (OPT_VAR.store != NULL && create_bit_matrix_store(&result, &header, data.size_update, data.size_subscr, OPT_VAR.store, OPT_VAR.resume) != err_none)
+		return (int)print_error_string();
+
+	// allocate the incremental index for all the extents
+	if ((OPT_VAR.changes > 0 || OPT_VAR.removes > 0) && match_index_init(&index, data.dimensions, data.size_update, data.size_subscr) != err_none)
+		return (int)print_error_string();
+
+	// allocate the triangle of the self-matching
+	if (OPT_VAR.self && create_bit_matrix_tri(&self, data.size_update) != err_none)
+		return (int)print_error_string();
+
+	// allocate the subscription-major matrix
+	if (OPT_VAR.transpose && create_bit_matrix(&transposed, data.size_subscr, data.size_update) != err_none)
+		return (int)print_error_string();
+
 #ifdef __TEST
 	// start test timer
 	start = clock();
 #endif // __TEST
 
-	// allocate the result bit matrix
-	if (create_bit_matrix(&result, data.size_update, data.size_subscr) != err_none)
-		return (int)print_error_string();
+	if (OPT_VAR.engine == engine_pairs)
+	{
+		// output-sensitive algorithm
+		if (sort_matching_pairs(data, &pairs) != err_none)
+			return (int)print_error_string();
+	}
+	else if (OPT_VAR.engine == engine_sparse)
+	{
+		// output-sensitive algorithm on compressed rows
+		if (sort_matching_sparse(data, &sparse) != err_none)
+			return (int)print_error_string();
+	}
+#ifdef __LOWMEM
+	else if (OPT_VAR.store != NULL)
+	{
+		// out-of-core algorithm, in bands of rows of the matrix mapped on the file
+		if (sort_matching_store(data, result, header) != err_none)
+			return (int)print_error_string();
+	}
+#endif // __LOWMEM
+	else if (OPT_VAR.self)
+	{
+		// self-matching of the update extents
+		if (sort_matching_self(data, self) != err_none)
+			return (int)print_error_string();
+	}
+	else if (OPT_VAR.changes > 0 || OPT_VAR.removes > 0)
+	{
+		// incremental mode: add the extents one at a time (the identifiers are given in order)
+		for (tick = 0; tick < data.size_update; tick++)
+		{
+			if (match_index_add_update(&index, &data.update[tick], &id) != err_none)
+				return (int)print_error_string();
+		}
+		for (tick = 0; tick < data.size_subscr; tick++)
+		{
+			if (match_index_add_subscr(&index, &data.subscr[tick], &id) != err_none)
+				return (int)print_error_string();
+		}
 
-	// main algorithm
-	if (sort_matching(data, result) != err_none)
+		// move the extents in turn and match each one again
+		for (tick = 0; tick < OPT_VAR.changes; tick++)
+		{
+			id = tick % (data.size_update + data.size_subscr);
+			if (id < data.size_update)
+			{
+				if (test_generator_move_extent(&data.update[id], data.dimensions) != err_none
+					|| match_index_modify_extent(&index, TRUE, id, &data.update[id]) != err_none)
+					return (int)print_error_string();
+			}
+			else
+			{
+				id -= data.size_update;
+				if (test_generator_move_extent(&data.subscr[id], data.dimensions) != err_none
+					|| match_index_modify_extent(&index, FALSE, id, &data.subscr[id]) != err_none)
+					return (int)print_error_string();
+			}
+		}
+
+		// remove some extents and add them back, which must give the same result
+		if (OPT_VAR.removes > 0 && (remove_extents(&index, data.update, data.size_update, TRUE, OPT_VAR.removes) != err_none
+			|| remove_extents(&index, data.subscr, data.size_subscr, FALSE, OPT_VAR.removes) != err_none))
+			return (int)print_error_string();
+		result = index.result;
+	}
+	else if (OPT_VAR.ticks == 0)
+	{
+		// main algorithm (on the buffers of the matching context)
+		if (sort_matching_context(&ctx, data) != err_none)
+			return (int)print_error_string();
+		result = ctx.result;
+	}
+	else
+	{
+		// persistent mode: first matching
+		if (persistent_matching_init(&state, data, result) != err_none)
+			return (int)print_error_string();
+
+		// for each tick move the extents and update the matching
+		for (tick = 0; tick < OPT_VAR.ticks; tick++)
+		{
+			if (test_generator_move(&data) != err_none || persistent_matching_update(&state, data, result) != err_none)
+				return (int)print_error_string();
+		}
+	}
+
+	// transpose the result (it's part of the timed matching, since it gives the other view of the same result)
+	if (OPT_VAR.transpose)
+		bitmatrix_transpose(result, transposed);
+
+	// export the result as compressed rows (the summary is up to date only without the persistent mode)
+	if (OPT_VAR.csr && bitmatrix_to_csr(result, data.size_subscr, (OPT_VAR.summary && OPT_VAR.ticks == 0) ? &ctx.summary : NULL, &rows) != err_none)
 		return (int)print_error_string();
 
 #ifdef __TEST
@@ -138,8 +523,18 @@ int main(int argc, char *argv[])
 	}
 #endif // _WIN32
 
-	// print output to file
-	fprintf(fout, "%f\n", ((float)(end - start)) / CLOCKS_PER_SEC);
+	// print output to file (with the tile width if the sweep is tiled and the memory options)
+	fprintf(fout, "%f", ((float)(end - start)) / CLOCKS_PER_SEC);
+	if (OPT_VAR.tile > 0)
+		fprintf(fout, "\ttile=%u", (unsigned int)OPT_VAR.tile);
+	if (OPT_VAR.self)
+		fprintf(fout, "\tself");
+	if (OPT_VAR.changes > 0)
+		fprintf(fout, "\tchanges=%u", (unsigned int)OPT_VAR.changes);
+	if (OPT_VAR.removes > 0)
+		fprintf(fout, "\tremoves=%u", (unsigned int)OPT_VAR.removes);
+	print_memory_options(fout);
+	fprintf(fout, "\n");
 
 	fclose(fout);
 
@@ -149,8 +544,19 @@ int main(int argc, char *argv[])
 #endif // __TEST
 
 #ifdef __VERBOSE
-	// print the result bit matrix
-	print_bitmatrix(result, data.size_update, data.size_subscr);
+	// print the result bit matrix, the matching pairs or the compressed rows
+	if (OPT_VAR.engine == engine_pairs)
+		print_match_csr(&pairs);
+	else if (OPT_VAR.engine == engine_sparse)
+		print_match_sparse(&sparse);
+	else if (OPT_VAR.self)
+		print_bitmatrix_tri(self);
+	else
+		print_bitmatrix(result);
+	if (OPT_VAR.transpose)
+		print_bitmatrix(transposed);
+	if (OPT_VAR.csr)
+		print_match_csr(&rows);
 
 #ifdef __DEBUG
 	getchar();
@@ -159,8 +565,26 @@ int main(int argc, char *argv[])
 
 #ifndef __NOFREE
 	// free memory
-	free(*result);
-	free(result);
+	if (OPT_VAR.ticks > 0)
+	{
+		persistent_matching_free(&state);
+		free_bit_matrix(&result);
+	}
+	if (OPT_VAR.store != NULL)
+		free_bit_matrix_store(&result);
+	if (OPT_VAR.self)
+		free_bit_matrix_tri(&self);
+	if (OPT_VAR.changes > 0 || OPT_VAR.removes > 0)
+		match_index_free(&index);
+	if (OPT_VAR.engine == engine_pairs)
+		free_match_csr(&pairs);
+	if (OPT_VAR.engine == engine_sparse)
+		free_match_sparse(&sparse);
+	if (OPT_VAR.transpose)
+		free_bit_matrix(&transposed);
+	if (OPT_VAR.csr)
+		free_match_csr(&rows);
+	match_context_free(&ctx);
 	free(data.update);
 	free(data.subscr);
 #endif // __NOFREE
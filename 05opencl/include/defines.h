@@ -111,14 +111,59 @@ Microsoft Visual Studio doesn't support inline for C functions.
 #define MAX_DIMENSIONS				3
 
 
-/** \brief The number of bits in an element of the bit vector.
+/** \brief The number of bits in an element of the bit vector (32 or 64).
+
+The bit positions are computed on elements of this size, so wider elements mean fewer iterations on each line of the bit matrix.
 */
-#define BITVEC_ELEM_BITS			32
+#ifndef BITVEC_ELEM_BITS
+#define BITVEC_ELEM_BITS			64
+#endif // BITVEC_ELEM_BITS
+
+
+/** \brief The number of bits in a lane of the bit vector (BITVEC_ELEM_BITS, 128 or 256).
+
+Each line of the bit matrix is padded to a whole number of lanes, so that the SIMD kernels work on full registers without a scalar tail.
+*/
+#ifndef BITVEC_LANE_BITS
+#define BITVEC_LANE_BITS			BITVEC_ELEM_BITS
+#endif // BITVEC_LANE_BITS
 
 
 /** \brief The value of the most significant bit in an element of the bit vector.
 */
+#if BITVEC_ELEM_BITS == 64
+#define BITVEC_ELEM_MAX_BIT			0x8000000000000000ULL
+#elif BITVEC_ELEM_BITS == 32
 #define BITVEC_ELEM_MAX_BIT			0x80000000
+#else
+#error BITVEC_ELEM_BITS must be 32 or 64
+#endif // BITVEC_ELEM_BITS
+
+#if BITVEC_LANE_BITS != BITVEC_ELEM_BITS && BITVEC_LANE_BITS != 128 && BITVEC_LANE_BITS != 256
+#error BITVEC_LANE_BITS must be BITVEC_ELEM_BITS, 128 or 256
+#endif // BITVEC_LANE_BITS
+
+
+/** \brief The number of bits of the key sorted in each pass of the radix sort.
+*/
+#define RADIX_DIGIT_BITS			8
+
+
+/** \brief The number of buckets of each pass of the radix sort.
+*/
+#define RADIX_BUCKETS				( 1 << RADIX_DIGIT_BITS )
+
+
+/** \brief Alignment in bytes of the rows of the bit matrices (a cache line, which is also a multiple of every SIMD register).
+*/
+#define BITMATRIX_ALIGNMENT			64
+
+
+/** \brief Row size in bytes that the stride of the bit matrices must avoid (0 to disable the padding).
+
+When the stride is a multiple of this size the same column of consecutive rows maps to the same cache sets, so the rows are padded with BITMATRIX_ALIGNMENT more bytes.
+*/
+#define BITMATRIX_ALIAS_STRIDE		4096
 
 
 /** \brief The max file name size.
@@ -172,9 +217,19 @@ Windows uses '\' in the path, while Linux uses '/'.
 #define MAX(_a, _b)					( (_a > _b) ? _a : _b )
 
 
-/**	\brief Calculates the number of elements of a bit vector from the number of bits.
+/**	\brief Calculates the number of elements of a bit vector from the number of bits (rounded up to a whole number of lanes).
+*/
+#define BIT_VEC_WIDTH(_bits)		( ((BITVEC_LANE_BITS + (_bits) - 1) / BITVEC_LANE_BITS) * (BITVEC_LANE_BITS / BITVEC_ELEM_BITS) )
+
+
+/** \brief Returns the pointer to the first element of a row of a bit matrix.
+*/
+#define BITMATRIX_ROW(_m, _row)		( (_m).base + (size_t)(_row) * (_m).stride )
+
+
+/** \brief Returns the number of elements of a bit matrix, padding of the rows included.
 */
-#define BIT_VEC_WIDTH(_bits)		( (BITVEC_ELEM_BITS + _bits - 1) / BITVEC_ELEM_BITS )
+#define BITMATRIX_SIZE(_m)			( (_m).rows * (_m).stride )
 
 
 /** \brief Returns the element number which contains the nth bit of the bit vector.
@@ -189,10 +244,10 @@ Windows uses '\' in the path, while Linux uses '/'.
 
 /** \brief Returns the value of the nth bit in ascending order (bit 0 == 1).
 */
-#define ABIT(_n)					( 0x00000001 << _n )
+#define ABIT(_n)					( (bitvec_elem)1 << (_n) )
 
 
-/** \brief Returns the value of the nth bit in descending order (bit 0 == 2^31).
+/** \brief Returns the value of the nth bit in descending order (bit 0 == 2^(BITVEC_ELEM_BITS - 1)).
 */
 #define DBIT(_n)					( BITVEC_ELEM_MAX_BIT >> _n )
 
@@ -214,7 +269,7 @@ Windows uses '\' in the path, while Linux uses '/'.
 
 /** \brief Checks whether the nth bit is set (ascending order).
 */
-#define BIT_ACHECK(_y, _n)			( _y & (0x00000001 >> _n) )
+#define BIT_ACHECK(_y, _n)			( _y & ABIT(_n) )
 
 
 /** \brief Checks whether the nth bit is set (descending order).
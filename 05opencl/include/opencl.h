@@ -32,8 +32,8 @@ The file opencl.c contains the functions that handle OpenCL.
 
 
 _ERR_CODE cl_init(const _UINT size_update, const _UINT size_subscr);
-void vector_bitwise_not(const bitvector vector, const _UINT size);
-void vector_bitwise_or(const bitvector vector, const bitvector mask, const _UINT size);
+_ERR_CODE vector_bitwise_not(const bitvector vector, const _UINT size);
+_ERR_CODE vector_bitwise_or(const bitvector vector, const bitvector mask, const _UINT size);
 
 #ifndef __NOFREE
 void cl_free();
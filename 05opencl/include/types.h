@@ -24,6 +24,7 @@
 #define __TYPES_H
 
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "defines.h"
@@ -82,7 +83,11 @@ This file contains all the data types definitions. The simple types are to avoid
 
 /** \brief An element of the bit vector used for storing the matches.
 */
+#if BITVEC_ELEM_BITS == 64
+typedef uint64_t			bitvec_elem;
+#else // BITVEC_ELEM_BITS
 typedef uint32_t			bitvec_elem;
+#endif // BITVEC_ELEM_BITS
 
 
 /** \brief The bit vector used for storing the matches.
@@ -94,9 +99,16 @@ typedef bitvec_elem*	bitvector;
 
 /** \brief The bit matrix used for storing the matches.
 
-The lines of the bit matrix correspond to the update extents, while the single bits on each line represent the subscription extents.
+The lines of the bit matrix correspond to the update extents, while the single bits on each line represent the subscription extents. The rows are stored in a single block, each one stride elements after the previous one, so that a row is reached without loading a pointer; the rows are aligned to BITMATRIX_ALIGNMENT bytes and the stride is padded to avoid BITMATRIX_ALIAS_STRIDE.
 */
-typedef bitvector*		bitmatrix;
+typedef struct
+{
+	bitvector	base;				///< first element of the first row
+	_UINT		rows;				///< number of rows
+	_UINT		width;				///< number of elements of each row holding bits (BIT_VEC_WIDTH() of the columns)
+	_UINT		stride;				///< number of elements between the starts of two consecutive rows
+	_UINT		alignment;			///< alignment of the rows in bytes
+} bitmatrix;
 
 
 /** \brief The endpoints of an extent in a given dimension.
@@ -152,6 +164,25 @@ typedef struct
 typedef list_t* list_ptr;
 
 
+/** \brief Enum for the algorithms used to sort the list of endpoints.
+*/
+typedef enum
+{
+	sort_qsort					= 0,
+	sort_radix					= 1
+} sort_algo_t;
+
+
+/** \brief Structure containing the run-time options.
+
+The options are set once by the main function and read by the algorithm.
+*/
+typedef struct
+{
+	sort_algo_t	sort_algo;			///< algorithm used to sort the list of endpoints
+} _opt_t;
+
+
 /** \brief Enum for error codes.
 */
 typedef enum 
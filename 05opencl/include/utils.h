@@ -31,14 +31,21 @@ The file utils.c contains various utilities functions.
 */
 
 
+/** \brief Global external options variable.
+*/
+extern _opt_t OPT_VAR;
+
+
+size_t bitmatrix_layout(bitmatrix *out, const bitvector base, const _UINT size_update, const _UINT size_subscr);
 _ERR_CODE create_bit_matrix(bitmatrix *out, const _UINT size_update, const _UINT size_subscr);
+void free_bit_matrix(bitmatrix *in);
 
 void set_endpoints_list(const match_data_t data, const list_ptr out, const _UINT dimension);
 
-INLINE void sort_list(const list_ptr ep_list, const _UINT size);
+void sort_list(const list_ptr ep_list, const _UINT size);
 
 #ifdef __VERBOSE
-void print_bitmatrix(const bitmatrix in, const _UINT size_update, const _UINT size_subscr);
+void print_bitmatrix(const bitmatrix in);
 #endif // __VERBOSE
 
 
@@ -50,6 +50,47 @@
 */
 
 
+/** \brief Prints the usage of the program.
+
+\param prog_name the name of the executable
+*/
+void print_synopsis(const char *prog_name)
+{
+	printf("\nSYNOPSIS:\n\n");
+	printf("%s <updates> <subscriptions> <dimensions> [options]\n\n", FILENAME(prog_name));
+	printf("OPTIONS:\n\n");
+	printf("--sort=<radix|qsort>\talgorithm used to sort the endpoints (default: radix)\n\n");
+}
+
+
+/** \brief Parses the optional arguments and sets the global options.
+
+\param argc the number of optional arguments
+\param argv the array of optional arguments
+
+\retval error code
+*/
+_ERR_CODE parse_options(const int argc, char *argv[])
+{
+	int i;
+
+	for (i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--sort=radix") == 0)
+			OPT_VAR.sort_algo = sort_radix;
+		else if (strcmp(argv[i], "--sort=qsort") == 0)
+			OPT_VAR.sort_algo = sort_qsort;
+		else
+		{
+			printf("\nNot a valid option: %s\n", argv[i]);
+			return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+		}
+	}
+
+	return err_none;
+}
+
+
 /** \brief Main function.
 */
 int main(int argc, char *argv[])
@@ -65,10 +106,9 @@ int main(int argc, char *argv[])
 	clock_t start, end;
 #endif // __TEST
 
-	if ((argc == 2 && strcmp(argv[1], "--help") == 0) || argc != 4)
+	if ((argc == 2 && strcmp(argv[1], "--help") == 0) || argc < 4)
 	{
-		printf("\nSYNOPSIS:\n\n");
-		printf("%s <updates> <subscriptions> <dimensions>\n\n", FILENAME(argv[0]));
+		print_synopsis(argv[0]);
 		
 		return (int)err_none;
 	}
@@ -89,6 +129,10 @@ int main(int argc, char *argv[])
 		return (int)print_error_string();
 	}
 
+	// set the options that follow the mandatory arguments
+	if (parse_options(argc - 4, &argv[4]) != err_none)
+		return (int)print_error_string();
+
 #ifdef __RANDOM_SET
 	// generate a random data set
 	if (test_generator_random(&data, updates, subscrs, dimensions) != err_none)
@@ -155,7 +199,7 @@ int main(int argc, char *argv[])
 
 #ifdef __VERBOSE
 	// print the result bit matrix
-	print_bitmatrix(result, data.size_update, data.size_subscr);
+	print_bitmatrix(result);
 
 #ifdef __DEBUG
 	getchar();
@@ -164,8 +208,7 @@ int main(int argc, char *argv[])
 
 #ifndef __NOFREE
 	// free memory
-	free(*result);
-	free(result);
+	free_bit_matrix(&result);
 	free(data.update);
 	free(data.subscr);
 	cl_free();
@@ -45,14 +45,17 @@ This function performs the sort matching on a single dimension.
 \param subscr_set_after the array to be used as the the set of "after" subscriptions
 \param size_update the number of update extents
 \param size_subscr the number of subscription extents
+
+\retval error code
 */
-void sort_matching_1D(const list_ptr ep_list, const bitmatrix out, const bitvector subscr_set_before, const bitvector subscr_set_after, const _UINT size_update, const _UINT size_subscr)
+_ERR_CODE sort_matching_1D(const list_ptr ep_list, const bitmatrix out, const bitvector subscr_set_before, const bitvector subscr_set_after, const _UINT size_update, const _UINT size_subscr)
 {
 	_UINT i;
 	_UINT bit_pos;
 	_UINT line_width;
 	_UINT list_size;
 	_UINT update_ep_count;
+	_ERR_CODE err;
 
 	// two endpoints for each extent
 	list_size = (size_update + size_subscr) * 2;
@@ -98,15 +101,21 @@ void sort_matching_1D(const list_ptr ep_list, const bitmatrix out, const bitvect
 			if (ep_list[i].is_lower_point)
 			{
 				// bitwise OR (write all the subscription extents in the "before" set in the update extent's line in the bit matrix)
-				vector_bitwise_or(out[ep_list[i].id - size_subscr], subscr_set_before, line_width);
+				err = vector_bitwise_or(BITMATRIX_ROW(out, ep_list[i].id - size_subscr), subscr_set_before, line_width);
+				if (err != err_none)
+					return err;
 			}
 			else // if it's the upper endpoint
 			{
 				// bitwise OR (write all the subscription extents in the "after" set in the update extent's line in the bit matrix)
-				vector_bitwise_or(out[ep_list[i].id - size_subscr], subscr_set_after, line_width);
+				err = vector_bitwise_or(BITMATRIX_ROW(out, ep_list[i].id - size_subscr), subscr_set_after, line_width);
+				if (err != err_none)
+					return err;
 			}
 		}
 	}
+
+	return err_none;
 }
 
 
@@ -128,9 +137,11 @@ _ERR_CODE sort_matching(const match_data_t data, const bitmatrix out)
 	list_ptr ep_list;
 	bitvector subscr_set_before;
 	bitvector subscr_set_after;
+	_ERR_CODE err;
 
 	line_width = BIT_VEC_WIDTH(data.size_subscr);
-	matrix_size = data.size_update * line_width;
+	// whole matrix operations include the padding of the rows
+	matrix_size = BITMATRIX_SIZE(out);
 
 	if (data.dimensions < 1)
 		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
@@ -152,12 +163,12 @@ _ERR_CODE sort_matching(const match_data_t data, const bitmatrix out)
 		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
 	
 	// for each dimension
-	for (i = 0; i < data.dimensions; i++)
+	for (i = 0, err = err_none; i < data.dimensions && err == err_none; i++)
 	{
 		// fill the endpoints "list" with the data of the dimension to be processed
 		set_endpoints_list(data, ep_list, i);
 
-		sort_matching_1D(ep_list, out, subscr_set_before, subscr_set_after, data.size_update, data.size_subscr);
+		err = sort_matching_1D(ep_list, out, subscr_set_before, subscr_set_after, data.size_update, data.size_subscr);
 	}
 
 #ifndef __NOFREE
@@ -167,8 +178,9 @@ _ERR_CODE sort_matching(const match_data_t data, const bitmatrix out)
 	free(subscr_set_after);
 #endif // __NOFREE
 
+	if (err != err_none)
+		return err;
+
 	// bitwise NOT of the non-matching table to obtain the matching table
-	vector_bitwise_not(out[0], matrix_size);
-	
-	return err_none;
+	return vector_bitwise_not(out.base, matrix_size);
 }
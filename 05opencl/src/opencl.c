@@ -22,6 +22,7 @@
 
 #include "../include/types.h"
 
+#include "../include/utils.h"
 #include "../include/error.h"
 
 #include <CL/cl.h>
@@ -49,22 +50,29 @@ size_t global_ws;
 This function tells OpenCL to write data to the input buffer, to enqueue the kernel and then to read data back from the output buffer.
 
 \param vector the bit vector to be inverted
-\param size the size (in number of elements, not bits) of the bit vector
+\param size the size (in number of elements, not bits) of the bit vector, at most the size of the buffers created by cl_init()
+
+\retval error code
 */
-void vector_bitwise_not(const bitvector vector, const _UINT size)
+_ERR_CODE vector_bitwise_not(const bitvector vector, const _UINT size)
 {
 	// write the input buffer
-	clEnqueueWriteBuffer(queue, vec, CL_TRUE, 0, size * sizeof(bitvec_elem), vector, 0, NULL, NULL);
+	if (clEnqueueWriteBuffer(queue, vec, CL_TRUE, 0, size * sizeof(bitvec_elem), vector, 0, NULL, NULL) != CL_SUCCESS)
+		return set_error(err_opencl, __FILE__, __FUNCTION__, __LINE__);
 
 	// calculate global size
 	global_ws = GLOBAL_WS(size);
 
-	// enqueue kernel
-	clEnqueueNDRangeKernel(queue, kernel_not, 1, NULL, &global_ws, &local_ws, 0, NULL, NULL);
+	// enqueue kernel (on the elements of the vector only)
+	if (clSetKernelArg(kernel_not, 1, sizeof(_UINT), &size) != CL_SUCCESS
+		|| clEnqueueNDRangeKernel(queue, kernel_not, 1, NULL, &global_ws, &local_ws, 0, NULL, NULL) != CL_SUCCESS)
+		return set_error(err_opencl, __FILE__, __FUNCTION__, __LINE__);
 
 	// read the output buffer
-	clEnqueueReadBuffer(queue, vec, CL_TRUE, 0, size * sizeof(bitvec_elem), vector, 0, NULL, NULL);
+	if (clEnqueueReadBuffer(queue, vec, CL_TRUE, 0, size * sizeof(bitvec_elem), vector, 0, NULL, NULL) != CL_SUCCESS)
+		return set_error(err_opencl, __FILE__, __FUNCTION__, __LINE__);
 
+	return err_none;
 }
 
 
@@ -74,22 +82,30 @@ This function tells OpenCL to write data to the input buffers, to enqueue the ke
 
 \param vector the bit vector to perform the OR on, output data can be read on it
 \param mask the bit vector used as a mask for the OR operation
-\param size the size (in number of elements, not bits) of the bit vectors
+\param size the size (in number of elements, not bits) of the bit vectors, at most the size of the buffers created by cl_init()
+
+\retval error code
 */
-void vector_bitwise_or(const bitvector vector, const bitvector mask, const _UINT size)
+_ERR_CODE vector_bitwise_or(const bitvector vector, const bitvector mask, const _UINT size)
 {
 	// write the input buffers
-	clEnqueueWriteBuffer(queue, vec, CL_TRUE, 0, size * sizeof(bitvec_elem), vector, 0, NULL, NULL);
-	clEnqueueWriteBuffer(queue, vec2, CL_TRUE, 0, size * sizeof(bitvec_elem), mask, 0, NULL, NULL);
+	if (clEnqueueWriteBuffer(queue, vec, CL_TRUE, 0, size * sizeof(bitvec_elem), vector, 0, NULL, NULL) != CL_SUCCESS
+		|| clEnqueueWriteBuffer(queue, vec2, CL_TRUE, 0, size * sizeof(bitvec_elem), mask, 0, NULL, NULL) != CL_SUCCESS)
+		return set_error(err_opencl, __FILE__, __FUNCTION__, __LINE__);
 	
 	// calculate global size
 	global_ws = GLOBAL_WS(size);
 
-	// enqueue kernel
-	clEnqueueNDRangeKernel(queue, kernel_or, 1, NULL, &global_ws, &local_ws, 0, NULL, NULL);
+	// enqueue kernel (on the elements of the vectors only)
+	if (clSetKernelArg(kernel_or, 2, sizeof(_UINT), &size) != CL_SUCCESS
+		|| clEnqueueNDRangeKernel(queue, kernel_or, 1, NULL, &global_ws, &local_ws, 0, NULL, NULL) != CL_SUCCESS)
+		return set_error(err_opencl, __FILE__, __FUNCTION__, __LINE__);
 
 	// read the output buffer
-	clEnqueueReadBuffer(queue, vec, CL_TRUE, 0, size * sizeof(bitvec_elem), vector, 0, NULL, NULL);
+	if (clEnqueueReadBuffer(queue, vec, CL_TRUE, 0, size * sizeof(bitvec_elem), vector, 0, NULL, NULL) != CL_SUCCESS)
+		return set_error(err_opencl, __FILE__, __FUNCTION__, __LINE__);
+
+	return err_none;
 }
 
 
@@ -121,6 +137,8 @@ _ERR_CODE cl_init(const _UINT size_update, const _UINT size_subscr)
 	_BYTE *program_buffer;
 	size_t program_size;
 	size_t size;
+	_UINT elements;
+	bitmatrix geometry;
 	_UINT i, j;
 	_BOOL device_found;
 
@@ -245,8 +263,8 @@ _ERR_CODE cl_init(const _UINT size_update, const _UINT size_subscr)
 	// free the buffer
 	free(program_buffer);
 
-	// build the program
-	err = clBuildProgram(program, 0, NULL, NULL, NULL, NULL);
+	// build the program, with the same bitvector element as the host
+	err = clBuildProgram(program, 0, NULL, "-DBITVEC_ELEM_BITS=" TOSTR(BITVEC_ELEM_BITS), NULL, NULL);
 
 #ifdef __VERBOSE
 	// get build log
@@ -274,12 +292,13 @@ _ERR_CODE cl_init(const _UINT size_update, const _UINT size_subscr)
 	if (err != CL_SUCCESS)
 		return set_error(err_opencl, __FILE__, __FUNCTION__, __LINE__);
 
-	// create buffers (the size of the bit matrix)
-	size = size_update * BIT_VEC_WIDTH(size_subscr) ;
-	vec = clCreateBuffer(context, CL_MEM_READ_WRITE, size * sizeof(bitvec_elem), NULL, &err);
+	// create buffers (the size of the bit matrix, padding of the rows included, since the NOT is applied to the whole matrix)
+	size = bitmatrix_layout(&geometry, NULL, size_update, size_subscr);
+	elements = (_UINT)(size / sizeof(bitvec_elem));
+	vec = clCreateBuffer(context, CL_MEM_READ_WRITE, size, NULL, &err);
 	if (err != CL_SUCCESS)
 		return set_error(err_opencl, __FILE__, __FUNCTION__, __LINE__);
-	vec2 = clCreateBuffer(context, CL_MEM_READ_ONLY, size * sizeof(bitvec_elem), NULL, &err);
+	vec2 = clCreateBuffer(context, CL_MEM_READ_ONLY, size, NULL, &err);
 	if (err != CL_SUCCESS)
 		return set_error(err_opencl, __FILE__, __FUNCTION__, __LINE__);
 
@@ -291,7 +310,7 @@ _ERR_CODE cl_init(const _UINT size_update, const _UINT size_subscr)
 	// __global const BITVECTOR_T *vec
 	clSetKernelArg(kernel_not, 0, sizeof(cl_mem), &vec);
 	// const uint size
-	clSetKernelArg(kernel_not, 1, sizeof(_UINT), &size);
+	clSetKernelArg(kernel_not, 1, sizeof(_UINT), &elements);
 	
 	// kernel_or
 	// __global const BITVECTOR_T *vec
@@ -299,7 +318,7 @@ _ERR_CODE cl_init(const _UINT size_update, const _UINT size_subscr)
 	// __global const BITVECTOR_T *mask
 	clSetKernelArg(kernel_or, 1, sizeof(cl_mem), &vec2);
 	// const uint size
-	clSetKernelArg(kernel_or, 2, sizeof(_UINT), &size);
+	clSetKernelArg(kernel_or, 2, sizeof(_UINT), &elements);
 
 	return err_none;
 }
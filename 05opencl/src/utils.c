@@ -25,6 +25,7 @@
 #include "../include/error.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 
 /** \file utils.c
@@ -32,9 +33,71 @@
 */
 
 
+/** \brief The global options variable.
+*/
+_opt_t OPT_VAR = { sort_radix };
+
+
+/* Width of the radix sort key (the tie rule of compare_endpoints() is part of the key) */
+#if SPACE_TYPE_SELECT == 1 || SPACE_TYPE_SELECT == 3
+#define RADIX_POINT_BITS	32
+#else // SPACE_TYPE_SELECT
+#define RADIX_POINT_BITS	64
+#endif // SPACE_TYPE_SELECT
+
+#if defined(__SUPERSET)
+// no tie rule: the key is the point
+#define RADIX_KEY_BITS		RADIX_POINT_BITS
+#elif RADIX_POINT_BITS < 64
+// the tie rule is the least significant bit of the key
+#define RADIX_KEY_BITS		( RADIX_POINT_BITS + 1 )
+#define RADIX_TIE_IN_KEY
+#else // __SUPERSET
+// the tie rule doesn't fit in the key: it's sorted by an extra 1-bit pass before the others
+#define RADIX_KEY_BITS		RADIX_POINT_BITS
+#define RADIX_TIE_PASS
+#endif // __SUPERSET
+
+#define RADIX_PASSES		( (RADIX_KEY_BITS + RADIX_DIGIT_BITS - 1) / RADIX_DIGIT_BITS )
+
+
+/** \brief Sets the geometry of a bit matrix on a block of memory.
+
+\param out the bit matrix
+\param base the block of memory (aligned to BITMATRIX_ALIGNMENT bytes), or NULL to compute only its size
+\param size_update the height of the matrix
+\param size_subscr the \i minimum width in bits of the matrix
+
+\retval the size of the block of memory in bytes
+*/
+size_t bitmatrix_layout(bitmatrix *out, const bitvector base, const _UINT size_update, const _UINT size_subscr)
+{
+	_UINT align;
+
+	// elements in an aligned block
+	align = BITMATRIX_ALIGNMENT / sizeof(bitvec_elem);
+
+	out->base = base;
+	out->rows = size_update;
+	out->width = BIT_VEC_WIDTH(size_subscr);
+	out->stride = ((out->width + align - 1) / align) * align;
+	out->alignment = BITMATRIX_ALIGNMENT;
+
+#if BITMATRIX_ALIAS_STRIDE > 0
+	// pad the rows whose stride would map the same columns on the same cache sets
+	if ((out->stride * sizeof(bitvec_elem)) % BITMATRIX_ALIAS_STRIDE == 0)
+		out->stride += align;
+#endif // BITMATRIX_ALIAS_STRIDE
+
+	return (size_t)out->rows * out->stride * sizeof(bitvec_elem);
+}
+
+
 /** \brief Allocates a bit matrix of given height and width.
 
-\param out pointer to the memory to be allocated
+The rows are aligned to BITMATRIX_ALIGNMENT bytes and zeroed.
+
+\param out pointer to the bit matrix to be allocated
 \param size_update the height of the matrix
 \param size_subscr the \i minimum width in bits of the matrix
 
@@ -42,27 +105,40 @@
 */
 _ERR_CODE create_bit_matrix(bitmatrix *out, const _UINT size_update, const _UINT size_subscr)
 {
-	_UINT i;
-	bitvector vec;
-	_UINT line_width;
+	size_t size;
 
-	// number of elements on each line of the bit matrix
-	line_width = BIT_VEC_WIDTH(size_subscr);
+	size = bitmatrix_layout(out, NULL, size_update, size_subscr);
 
-	// allocate one big vector and a column vector
-	vec = (bitvector)calloc(line_width * size_update, sizeof(bitvec_elem));
-	*out = (bitmatrix)malloc(size_update * sizeof(bitvector));
-	if (vec == NULL || *out == NULL)
+#ifdef _MSC_VER
+	out->base = (bitvector)_aligned_malloc(size, BITMATRIX_ALIGNMENT);
+#else // _MSC_VER
+	if (posix_memalign((void **)&out->base, BITMATRIX_ALIGNMENT, size) != 0)
+		out->base = NULL;
+#endif // _MSC_VER
+	if (out->base == NULL)
 		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
 
-	// set each element of the column vector to point to the first element of each line in the big vector
-	for (i = 0; i < size_update; i++)
-		(*out)[i] = &vec[i * line_width];
+	memset(out->base, 0, size);
 
 	return err_none;
 }
 
 
+/** \brief Frees a bit matrix allocated by create_bit_matrix().
+
+\param in the bit matrix
+*/
+void free_bit_matrix(bitmatrix *in)
+{
+#ifdef _MSC_VER
+	_aligned_free(in->base);
+#else // _MSC_VER
+	free(in->base);
+#endif // _MSC_VER
+	in->base = NULL;
+}
+
+
 /** \brief Fills the endpoints list with the values for a given dimension.
 
 \param data the data set.
@@ -150,15 +226,168 @@ _INT compare_endpoints(const void *a, const void *b)
 }
 
 
+/** \brief Order-preserving key of an endpoint.
+
+Maps the point of the endpoint to an unsigned integer with the same ordering, so that comparing two keys is the same as applying compare_endpoints() to their endpoints.
+
+\remarks -0.0 and +0.0 are given the same key, since they compare equal.
+
+\param ep pointer to the endpoint
+
+\retval the key of the endpoint
+*/
+static INLINE uint64_t endpoint_key(const list_t *ep)
+{
+	uint64_t key;
+#if SPACE_TYPE_SELECT == 1
+	key = (uint32_t)ep->point ^ 0x80000000U;
+#elif SPACE_TYPE_SELECT == 2
+	key = (uint64_t)ep->point ^ 0x8000000000000000ULL;
+#elif SPACE_TYPE_SELECT == 3
+	uint32_t bits = 0;
+
+	if (ep->point != 0)
+		memcpy(&bits, &ep->point, sizeof(bits));
+	// negative values have all the bits flipped, positive values only the sign bit
+	key = (bits & 0x80000000U) ? (uint32_t)~bits : (bits | 0x80000000U);
+#elif SPACE_TYPE_SELECT == 4
+	uint64_t bits = 0;
+
+	if (ep->point != 0)
+		memcpy(&bits, &ep->point, sizeof(bits));
+	// negative values have all the bits flipped, positive values only the sign bit
+	key = (bits & 0x8000000000000000ULL) ? ~bits : (bits | 0x8000000000000000ULL);
+#endif // SPACE_TYPE_SELECT
+
+#ifdef RADIX_TIE_IN_KEY
+	// lower points go before upper points with the same coordinates
+	key = (key << 1) | (ep->is_lower_point ? 0 : 1);
+#endif // RADIX_TIE_IN_KEY
+
+	return key;
+}
+
+
+/** \brief LSD radix sort of the endpoints list.
+
+The list is sorted RADIX_DIGIT_BITS bits of endpoint_key() at a time, moving the elements between the list and a scratch list. The histograms of all the passes are computed in a single scan and the passes where all the elements have the same digit are skipped.
+
+\param ep_list the endpoints list to be ordered
+\param size the size of the list
+
+\retval TRUE if the list has been sorted
+\retval FALSE if the scratch list couldn't be allocated
+*/
+static _BOOL radix_sort_list(const list_ptr ep_list, const _UINT size)
+{
+	_UINT i, pass;
+	_UINT hist[RADIX_PASSES][RADIX_BUCKETS];
+	_UINT sum, count;
+	uint64_t key;
+	list_ptr src, dst, tmp;
+#ifdef RADIX_TIE_PASS
+	_UINT lower_count, lower_pos, upper_pos;
+#endif // RADIX_TIE_PASS
+
+	if (size < 2)
+		return TRUE;
+
+	dst = (list_ptr)malloc(size * sizeof(list_t));
+	if (dst == NULL)
+		return FALSE;
+	src = ep_list;
+
+	// compute the histograms of all the passes
+	memset(hist, 0, sizeof(hist));
+#ifdef RADIX_TIE_PASS
+	lower_count = 0;
+#endif // RADIX_TIE_PASS
+	for (i = 0; i < size; i++)
+	{
+		key = endpoint_key(&src[i]);
+		for (pass = 0; pass < RADIX_PASSES; pass++)
+			hist[pass][(key >> (pass * RADIX_DIGIT_BITS)) & (RADIX_BUCKETS - 1)]++;
+#ifdef RADIX_TIE_PASS
+		if (src[i].is_lower_point)
+			lower_count++;
+#endif // RADIX_TIE_PASS
+	}
+
+#ifdef RADIX_TIE_PASS
+	// least significant digit: stable partition of lower points before upper points
+	if (lower_count > 0 && lower_count < size)
+	{
+		lower_pos = 0;
+		upper_pos = lower_count;
+		for (i = 0; i < size; i++)
+		{
+			if (src[i].is_lower_point)
+				dst[lower_pos++] = src[i];
+			else
+				dst[upper_pos++] = src[i];
+		}
+
+		tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+#endif // RADIX_TIE_PASS
+
+	for (pass = 0; pass < RADIX_PASSES; pass++)
+	{
+		// skip the pass if every element falls in the same bucket
+		key = endpoint_key(&src[0]);
+		if (hist[pass][(key >> (pass * RADIX_DIGIT_BITS)) & (RADIX_BUCKETS - 1)] == size)
+			continue;
+
+		// exclusive prefix sum: first position of each bucket
+		sum = 0;
+		for (i = 0; i < RADIX_BUCKETS; i++)
+		{
+			count = hist[pass][i];
+			hist[pass][i] = sum;
+			sum += count;
+		}
+
+		// stable scatter of the elements in their buckets
+		for (i = 0; i < size; i++)
+		{
+			key = endpoint_key(&src[i]);
+			dst[hist[pass][(key >> (pass * RADIX_DIGIT_BITS)) & (RADIX_BUCKETS - 1)]++] = src[i];
+		}
+
+		tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	// if the sorted data is in the scratch list copy it back
+	if (src != ep_list)
+	{
+		memcpy(ep_list, src, size * sizeof(list_t));
+		dst = src;
+	}
+
+	free(dst);
+
+	return TRUE;
+}
+
+
 /** \brief Sorting function.
 
-This function only performs a call to stdlib.h's qsort() function.
+The list is sorted with the algorithm selected in the global options: the radix sort or a call to stdlib.h's qsort() function with compare_endpoints() as ordering rule.
+
+\remarks If the radix sort can't allocate its scratch memory the list is sorted with qsort().
 
 \param ep_list the endpoints list to be ordered
 \param size the size of the list
 */
-INLINE void sort_list(const list_ptr ep_list, const _UINT size)
+void sort_list(const list_ptr ep_list, const _UINT size)
 {
+	if (OPT_VAR.sort_algo == sort_radix && radix_sort_list(ep_list, size))
+		return;
+
 	qsort(ep_list, size, sizeof(list_t), compare_endpoints);
 }
 
@@ -169,32 +398,29 @@ INLINE void sort_list(const list_ptr ep_list, const _UINT size)
 This function prints the bit matrix.
 
 \param in the bit matrix to be printed
-\param size_update the number of update extents (height of the matrix)
-\param size_subscr the number of subscription extents (\i minimum width in bits of the matrix)
 */
 #include <stdio.h>
-void print_bitmatrix(const bitmatrix in, const _UINT size_update, const _UINT size_subscr)
+void print_bitmatrix(const bitmatrix in)
 {
 	_UINT i, j, bit;
 	_BYTE element[BITVEC_ELEM_BITS + 1];
 	bitvec_elem val;
 	bitvec_elem mask;
-	_UINT line_width;
-
-	// number of elements on each line of the bit matrix
-	line_width = BIT_VEC_WIDTH(size_subscr);
+	bitvector row;
 
 	// escape the string
 	element[BITVEC_ELEM_BITS] = '\0';
 
 	// for each line (update extent)
-	for (i = 0; i < size_update; i++)
+	for (i = 0; i < in.rows; i++)
 	{
-		// for each element in the line
-		for (j = 0; j < line_width; j++)
+		row = BITMATRIX_ROW(in, i);
+
+		// for each element in the line (the padding of the row isn't printed)
+		for (j = 0; j < in.width; j++)
 		{
 			mask = BITVEC_ELEM_MAX_BIT;
-			val = in[i][j];
+			val = row[j];
 
 			// for each bit in the element
 			for (bit = 0; bit < BITVEC_ELEM_BITS; bit++)
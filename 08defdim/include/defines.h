@@ -95,6 +95,27 @@ Microsoft Visual Studio doesn't support inline for C functions.
 #endif // _MSC_VER
 
 
+/** \brief Macros for SIMD compatibility.
+
+SIMD_X86 is defined if the SSE2 intrinsics can be used, SIMD_AVX2 and SIMD_AVX512 if the compiler supports the AVX2 and AVX-512 intrinsics. TARGET(_isa) enables an instruction set for a single function (GCC only), so that the program can be compiled without architecture flags and the functions are selected at run time.
+*/
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86
+#define SIMD_AVX2
+#define SIMD_AVX512
+#define TARGET(_isa)				__attribute__((target(_isa)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define SIMD_X86
+#if _MSC_VER >= 1800
+#define SIMD_AVX2
+#endif // _MSC_VER
+#if _MSC_VER >= 1910
+#define SIMD_AVX512
+#endif // _MSC_VER
+#define TARGET(_isa)
+#endif // SIMD
+
+
 /** Boolean true value.
 */
 #define TRUE						1
@@ -112,14 +133,150 @@ Microsoft Visual Studio doesn't support inline for C functions.
 #define MAX_DIMENSIONS				16
 
 
-/** \brief The number of bits in an element of the bit vector.
+/** \brief Maximum number of extents (update and subscription extents together) allowed.
+
+\remarks The endpoints list has two endpoints for each extent and identifies them with a _UINT (see list_t), so the size of the list must fit in a _UINT. The sizes of the bit matrices, which grow with the product of the extents, are computed in size_t.
+*/
+#define MAX_EXTENTS					2147483647
+
+
+/** \brief The number of bits in an element of the bit vector (32 or 64).
+
+The bit positions are computed on elements of this size, so wider elements mean fewer iterations on each line of the bit matrix.
+*/
+#ifndef BITVEC_ELEM_BITS
+#define BITVEC_ELEM_BITS			64
+#endif // BITVEC_ELEM_BITS
+
+
+/** \brief The number of bits in a lane of the bit vector (BITVEC_ELEM_BITS, 128 or 256).
+
+Each line of the bit matrix is padded to a whole number of lanes, so that the SIMD kernels work on full registers without a scalar tail.
 */
-#define BITVEC_ELEM_BITS			32
+#ifndef BITVEC_LANE_BITS
+#define BITVEC_LANE_BITS			BITVEC_ELEM_BITS
+#endif // BITVEC_LANE_BITS
 
 
 /** \brief The value of the most significant bit in an element of the bit vector.
 */
+#if BITVEC_ELEM_BITS == 64
+#define BITVEC_ELEM_MAX_BIT			0x8000000000000000ULL
+#elif BITVEC_ELEM_BITS == 32
 #define BITVEC_ELEM_MAX_BIT			0x80000000
+#else
+#error BITVEC_ELEM_BITS must be 32 or 64
+#endif // BITVEC_ELEM_BITS
+
+#if BITVEC_LANE_BITS != BITVEC_ELEM_BITS && BITVEC_LANE_BITS != 128 && BITVEC_LANE_BITS != 256
+#error BITVEC_LANE_BITS must be BITVEC_ELEM_BITS, 128 or 256
+#endif // BITVEC_LANE_BITS
+
+
+/** \brief Maximum movement of the extents between two ticks of the persistent matching.
+
+At each tick an extent is shifted by at most 1/MOVE_FRACTION of its width.
+*/
+#define MOVE_FRACTION				100
+
+
+/** \brief The number of bits of the key sorted in each pass of the radix sort.
+*/
+#define RADIX_DIGIT_BITS			8
+
+
+/** \brief The number of buckets of each pass of the radix sort.
+*/
+#define RADIX_BUCKETS				( 1 << RADIX_DIGIT_BITS )
+
+
+/** \brief The number of subscription extents (columns) of a chunk of the compressed result.
+
+Each chunk of a row is stored in its own container, whose values are the 16 low bits of the identifiers.
+*/
+#define SPARSE_CHUNK_BITS			65536
+
+
+/** \brief The maximum number of values of an array container of the compressed result (a bitmap container is smaller above it).
+*/
+#define SPARSE_ARRAY_MAX			4096
+
+
+/** \brief The minimum number of subscription endpoints between two snapshots of the compressed matching (if not set by the options).
+*/
+#define SPARSE_CHECKPOINT_INTERVAL	1024
+
+
+/** \brief The maximum number of snapshots of each dimension of the compressed matching: above it the interval grows with the number of subscription extents, so the snapshots use O(M) memory.
+*/
+#define SPARSE_MAX_SNAPSHOTS		64
+
+
+/** \brief Size in bytes of a memory page (the step of the prefaulting).
+*/
+#define MEMORY_PAGE_SIZE			4096
+
+
+/** \brief Size in bytes of a huge page.
+
+The big allocations are rounded up to a multiple of this size when huge pages are used.
+*/
+#define MEMORY_HUGE_PAGE_SIZE		( 2 * 1024 * 1024 )
+
+
+/** \brief Maximum number of NUMA nodes of the interleaving.
+*/
+#define MEMORY_MAX_NODES			1024
+
+
+/** \brief Size in bytes of the header of the backing file of an out-of-core result matrix (the rows start after it).
+*/
+#define STORE_HEADER_SIZE			MEMORY_PAGE_SIZE
+
+
+/** \brief Magic number of the header of the backing file of an out-of-core result matrix.
+*/
+#define STORE_MAGIC					0x534D4253
+
+
+/** \brief Size in bytes of the rows of a band of the out-of-core matching (if the rows of a band aren't set by the options).
+
+Only the rows of a band are resident at a time, so it bounds the memory used by the result.
+*/
+#define STORE_BAND_SIZE				( 256 * 1024 * 1024 )
+
+
+/** \brief Alignment in bytes of the rows of the bit matrices (a cache line, which is also a multiple of every SIMD register).
+*/
+#define BITMATRIX_ALIGNMENT			64
+
+
+/** \brief Row size in bytes that the stride of the bit matrices must avoid (0 to disable the padding).
+
+When the stride is a multiple of this size the same column of consecutive rows maps to the same cache sets, so the rows are padded with BITMATRIX_ALIGNMENT more bytes.
+*/
+#define BITMATRIX_ALIAS_STRIDE		4096
+
+
+/** \brief Number of elements of a block of the occupancy summary of the bit matrices.
+
+The summary keeps, for each block of a row, whether all its elements are zero or all ones.
+*/
+#define BITMATRIX_SUMMARY_ELEMS		64
+
+
+/** \brief Number of blocks on each side of a tile of the transpose of the bit matrices.
+
+A tile reads and writes BITMATRIX_TRANSPOSE_TILE consecutive elements of each of its rows, so that with 64 bit elements it uses whole cache lines on both sides.
+*/
+#define BITMATRIX_TRANSPOSE_TILE	8
+
+
+/** \brief Alignment in bytes of the buffers inside the arena of the matching context.
+
+Each buffer starts on its own cache line, so the buffers never share a line.
+*/
+#define ARENA_ALIGNMENT				64
 
 
 /** \brief The max file name size.
@@ -173,9 +330,44 @@ Windows uses '\' in the path, while Linux uses '/'.
 #define MAX(_a, _b)					( (_a > _b) ? _a : _b )
 
 
-/**	\brief Calculates the number of elements of a bit vector from the number of bits.
+/**	\brief Calculates the number of elements of a bit vector from the number of bits (rounded up to a whole number of lanes).
+*/
+#define BIT_VEC_WIDTH(_bits)		( ((BITVEC_LANE_BITS + (_bits) - 1) / BITVEC_LANE_BITS) * (BITVEC_LANE_BITS / BITVEC_ELEM_BITS) )
+
+
+/** \brief Returns the pointer to the first element of a row of a bit matrix.
+*/
+#define BITMATRIX_ROW(_m, _row)		( (_m).base + (size_t)(_row) * (_m).stride )
+
+
+/** \brief Returns the number of elements of a bit matrix, padding of the rows included.
+*/
+#define BITMATRIX_SIZE(_m)			( (size_t)(_m).rows * (_m).stride )
+
+
+/** \brief Returns the pointer to the first element of a row of a packed triangular bit matrix (the element holding the column of the row).
+*/
+#define BITMATRIX_TRI_ROW(_m, _row)	( (_m).base + bitmatrix_tri_offset((_m).width, (_row)) )
+
+
+/** \brief Returns the number of elements of a packed triangular bit matrix.
+*/
+#define BITMATRIX_TRI_SIZE(_m)		( bitmatrix_tri_offset((_m).width, (_m).rows) )
+
+
+/** \brief Checks whether the nth bit of a bit vector is set (descending order).
+*/
+#define BITVEC_TEST(_v, _n)			( (_v)[BIT_TO_POS((_n))] & DBIT((_n) % BITVEC_ELEM_BITS) )
+
+
+/** \brief Sets the nth bit of a bit vector (descending order).
+*/
+#define BITVEC_MARK(_v, _n)			( (_v)[BIT_TO_POS((_n))] |= DBIT((_n) % BITVEC_ELEM_BITS) )
+
+
+/** \brief Clears the nth bit of a bit vector (descending order).
 */
-#define BIT_VEC_WIDTH(_bits)		( (BITVEC_ELEM_BITS + _bits - 1) / BITVEC_ELEM_BITS )
+#define BITVEC_UNMARK(_v, _n)		( (_v)[BIT_TO_POS((_n))] &= ~DBIT((_n) % BITVEC_ELEM_BITS) )
 
 
 /** \brief Returns the element number which contains the nth bit of the bit vector.
@@ -190,10 +382,10 @@ Windows uses '\' in the path, while Linux uses '/'.
 
 /** \brief Returns the value of the nth bit in ascending order (bit 0 == 1).
 */
-#define ABIT(_n)					( 0x00000001 << _n )
+#define ABIT(_n)					( (bitvec_elem)1 << (_n) )
 
 
-/** \brief Returns the value of the nth bit in descending order (bit 0 == 2^31).
+/** \brief Returns the value of the nth bit in descending order (bit 0 == 2^(BITVEC_ELEM_BITS - 1)).
 */
 #define DBIT(_n)					( BITVEC_ELEM_MAX_BIT >> _n )
 
@@ -215,7 +407,7 @@ Windows uses '\' in the path, while Linux uses '/'.
 
 /** \brief Checks whether the nth bit is set (ascending order).
 */
-#define BIT_ACHECK(_y, _n)			( _y & (0x00000001 >> _n) )
+#define BIT_ACHECK(_y, _n)			( _y & ABIT(_n) )
 
 
 /** \brief Checks whether the nth bit is set (descending order).
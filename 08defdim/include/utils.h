@@ -31,18 +31,65 @@ The file utils.c contains various utilities functions.
 */
 
 
+/** \brief Global external options variable.
+*/
+extern _opt_t OPT_VAR;
+
+
+void *memory_alloc(const size_t size);
+void memory_free(void *ptr, const size_t size);
+size_t memory_physical();
+size_t bitmatrix_layout(bitmatrix *out, const bitvector base, const _UINT size_update, const _UINT size_subscr);
 _ERR_CODE create_bit_matrix(bitmatrix *out, const _UINT size_update, const _UINT size_subscr);
+void free_bit_matrix(bitmatrix *in);
+_ERR_CODE create_bit_matrix_store(bitmatrix *out, store_header_t **header, const _UINT size_update, const _UINT size_subscr, const char *path, const _BOOL resume);
+void free_bit_matrix_store(bitmatrix *in);
+_ERR_CODE bitmatrix_band_writeback(const bitmatrix m, const _UINT first, const _UINT last);
+_ERR_CODE store_header_writeback(store_header_t *header);
+
+size_t bitmatrix_tri_offset(const _UINT width, const _UINT row);
+size_t bitmatrix_tri_layout(bitmatrix_tri_t *out, const bitvector base, const _UINT size);
+_ERR_CODE create_bit_matrix_tri(bitmatrix_tri_t *out, const _UINT size);
+void free_bit_matrix_tri(bitmatrix_tri_t *in);
+_BOOL bitmatrix_tri_test(const bitmatrix_tri_t m, const _UINT a, const _UINT b);
+void bitmatrix_tri_line(const bitmatrix_tri_t m, const _UINT row, const bitvector line);
 
-void vector_bitwise_not(const bitvector vec, const _UINT size);
-void vector_bitwise_and(const bitvector result, const bitvector mask, const _UINT size);
-void vector_bitwise_or(const bitvector result, const bitvector mask, const _UINT size);
+simd_t select_bitwise_kernels();
+void vector_bitwise_not(const bitvector vec, const size_t size);
+void vector_bitwise_and(const bitvector result, const bitvector mask, const size_t size);
+void vector_bitwise_or(const bitvector result, const bitvector mask, const size_t size);
+void vector_bitwise_andnot(const bitvector result, const bitvector mask, const size_t size);
+void vector_bitwise_nor(const bitvector result, const bitvector mask, const size_t size);
+
+size_t bitmatrix_summary_layout(bitmatrix_summary_t *summary, const bitvector base, const bitmatrix m);
+_ERR_CODE create_bitmatrix_summary(bitmatrix_summary_t *summary, const bitmatrix m);
+void free_bitmatrix_summary(bitmatrix_summary_t *summary);
+void bitmatrix_summarize(const bitmatrix m, const bitmatrix_summary_t *summary, const _BOOL inverted);
+void bitmatrix_summary_invert(const bitmatrix_summary_t *summary);
+void bitmatrix_andnot_summary(const bitmatrix result, const bitmatrix mask, const bitmatrix_summary_t *summary);
+void bitmatrix_transpose(const bitmatrix in, const bitmatrix out);
 
 void set_endpoints_list(const match_data_t data, const list_ptr out, const _UINT dimension);
+void set_self_endpoints_list(const match_data_t data, const list_ptr out, const _UINT dimension);
+void refresh_endpoints_list(const match_data_t data, const list_ptr list, const _UINT size, const _UINT dimension);
+
+void sort_list(const list_ptr ep_list, const _UINT size);
+void sort_list_scratch(const list_ptr ep_list, const _UINT size, const list_ptr scratch);
+
+void free_match_csr(match_csr_t *csr);
+void match_iter_init(match_iter_t *it, const bitmatrix m, const _UINT size_subscr, const _UINT update);
+_BOOL match_iter_next(match_iter_t *it, _UINT *subscr);
+_ERR_CODE bitmatrix_to_csr(const bitmatrix m, const _UINT size_subscr, const bitmatrix_summary_t *summary, match_csr_t *out);
 
-INLINE void sort_list(const list_ptr ep_list, const _UINT size);
+_ERR_CODE match_sparse_append_row(match_sparse_t *sparse, const _UINT update, const bitvector line);
+_BOOL match_sparse_contains(const match_sparse_t *sparse, const _UINT update, const _UINT subscr);
+void free_match_sparse(match_sparse_t *sparse);
 
 #ifdef __VERBOSE
-void print_bitmatrix(const bitmatrix in, const _UINT size_update, const _UINT size_subscr);
+void print_bitmatrix(const bitmatrix in);
+void print_bitmatrix_tri(const bitmatrix_tri_t in);
+void print_match_csr(const match_csr_t *in);
+void print_match_sparse(const match_sparse_t *in);
 #endif // __VERBOSE
 
 
@@ -25,6 +25,23 @@
 #include "../include/error.h"
 
 #include <stdlib.h>
+#include <string.h>
+#ifdef _MSC_VER
+#include <Windows.h>
+#else // _MSC_VER
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif // __linux__
+#endif // _MSC_VER
+#ifdef SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#endif // SIMD_X86
 
 
 /** \file utils.c
@@ -32,188 +49,2314 @@
 */
 
 
+/** \brief The global options variable.
+*/
+_opt_t OPT_VAR = { sort_radix, engine_matrix, FALSE, FALSE, FALSE, FALSE, simd_auto, 0, 0, 0, pages_default, FALSE, numa_default, NULL, 0, FALSE, FALSE, 0 };
+
+
+/* Width of the radix sort key (the tie rule of compare_endpoints() is part of the key) */
+#if SPACE_TYPE_SELECT == 1 || SPACE_TYPE_SELECT == 3
+#define RADIX_POINT_BITS	32
+#else // SPACE_TYPE_SELECT
+#define RADIX_POINT_BITS	64
+#endif // SPACE_TYPE_SELECT
+
+#if defined(__SUPERSET)
+// no tie rule: the key is the point
+#define RADIX_KEY_BITS		RADIX_POINT_BITS
+#elif RADIX_POINT_BITS < 64
+// the tie rule is the least significant bit of the key
+#define RADIX_KEY_BITS		( RADIX_POINT_BITS + 1 )
+#define RADIX_TIE_IN_KEY
+#else // __SUPERSET
+// the tie rule doesn't fit in the key: it's sorted by an extra 1-bit pass before the others
+#define RADIX_KEY_BITS		RADIX_POINT_BITS
+#define RADIX_TIE_PASS
+#endif // __SUPERSET
+
+#define RADIX_PASSES		( (RADIX_KEY_BITS + RADIX_DIGIT_BITS - 1) / RADIX_DIGIT_BITS )
+
+
+/* Memory policies of the Linux system calls (numaif.h isn't always available) */
+#define MEMORY_MPOL_INTERLEAVE		3
+#define MEMORY_MPOL_F_MEMS_ALLOWED	( 1 << 2 )
+
+
+/** \brief Size of a big allocation, rounded up to whole pages (or huge pages).
+
+\param size the size requested in bytes
+
+\retval the size allocated in bytes
+*/
+static size_t memory_length(const size_t size)
+{
+	size_t page;
+
+	page = (OPT_VAR.pages == pages_default) ? MEMORY_PAGE_SIZE : MEMORY_HUGE_PAGE_SIZE;
+
+	return ((MAX(size, 1) + page - 1) / page) * page;
+}
+
+
+/** \brief Interleaves the pages of a memory block on all the NUMA nodes allowed to the process.
+
+\param ptr the memory block (not touched yet)
+\param length the size of the memory block in bytes
+
+\retval TRUE if the policy has been set
+\retval FALSE otherwise
+*/
+static _BOOL memory_interleave(void *ptr, const size_t length)
+{
+#ifdef __linux__
+	unsigned long nodes[MEMORY_MAX_NODES / (8 * sizeof(unsigned long))];
+
+	memset(nodes, 0, sizeof(nodes));
+
+	// the nodes allowed to the process, then the interleave policy on them
+	if (syscall(SYS_get_mempolicy, NULL, nodes, (unsigned long)MEMORY_MAX_NODES, NULL, (unsigned long)MEMORY_MPOL_F_MEMS_ALLOWED) != 0)
+		return FALSE;
+
+	return syscall(SYS_mbind, ptr, (unsigned long)length, (unsigned long)MEMORY_MPOL_INTERLEAVE, nodes, (unsigned long)MEMORY_MAX_NODES, 0UL) == 0;
+#else // __linux__
+	return FALSE;
+#endif // __linux__
+}
+
+
+/** \brief Touches every page of a memory block, so that the page faults happen now.
+
+\param ptr the memory block
+\param length the size of the memory block in bytes
+*/
+static void memory_prefault(void *ptr, const size_t length)
+{
+	size_t i;
+
+	// the memory is already zeroed, writing a zero only faults the page in
+	for (i = 0; i < length; i += MEMORY_PAGE_SIZE)
+		((volatile char *)ptr)[i] = 0;
+}
+
+
+/** \brief Allocates a big block of zeroed memory following the memory options.
+
+The block is mapped directly from the system, so that it can use transparent or explicit huge pages, be interleaved on the NUMA nodes and be prefaulted (outside the timed part of the program, since the big blocks are allocated before it).
+
+\param size the size in bytes
+
+\retval the pointer to the memory, or NULL if it couldn't be allocated with the requested options
+*/
+void *memory_alloc(const size_t size)
+{
+	void *ptr;
+	size_t length;
+
+	length = memory_length(size);
+
+#ifdef _MSC_VER
+	if (OPT_VAR.pages == pages_huge)
+	{
+		// the large pages need the "Lock pages in memory" privilege and are always committed
+		length = ((length + GetLargePageMinimum() - 1) / GetLargePageMinimum()) * GetLargePageMinimum();
+		ptr = VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+	}
+	else
+		ptr = VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+	if (ptr == NULL)
+		return NULL;
+#else // _MSC_VER
+#ifdef MAP_HUGETLB
+	if (OPT_VAR.pages == pages_huge)
+		ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	else
+#endif // MAP_HUGETLB
+		ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (ptr == MAP_FAILED)
+		return NULL;
+
+#ifdef MADV_HUGEPAGE
+	// the transparent huge pages must be requested before the pages are touched
+	if (OPT_VAR.pages == pages_thp)
+		madvise(ptr, length, MADV_HUGEPAGE);
+#endif // MADV_HUGEPAGE
+
+	// the NUMA policy must be set before the pages are touched
+	if (OPT_VAR.numa == numa_interleave && !memory_interleave(ptr, length))
+	{
+		munmap(ptr, length);
+		return NULL;
+	}
+#endif // _MSC_VER
+
+	if (OPT_VAR.prefault)
+		memory_prefault(ptr, length);
+
+	return ptr;
+}
+
+
+/** \brief Frees a block of memory allocated by memory_alloc().
+
+\param ptr the memory block (can be NULL)
+\param size the size in bytes requested to memory_alloc()
+*/
+void memory_free(void *ptr, const size_t size)
+{
+	if (ptr == NULL)
+		return;
+
+#ifdef _MSC_VER
+	VirtualFree(ptr, 0, MEM_RELEASE);
+#else // _MSC_VER
+	munmap(ptr, memory_length(size));
+#endif // _MSC_VER
+}
+
+
+/** \brief Size of the physical memory of the machine.
+
+\retval the size in bytes (0 if it can't be known)
+*/
+size_t memory_physical()
+{
+#ifdef _MSC_VER
+	MEMORYSTATUSEX status;
+
+	status.dwLength = sizeof(MEMORYSTATUSEX);
+	if (!GlobalMemoryStatusEx(&status))
+		return 0;
+
+	return (size_t)status.ullTotalPhys;
+#else // _MSC_VER
+	long pages, page;
+
+	pages = sysconf(_SC_PHYS_PAGES);
+	page = sysconf(_SC_PAGESIZE);
+	if (pages <= 0 || page <= 0)
+		return 0;
+
+	return (size_t)pages * (size_t)page;
+#endif // _MSC_VER
+}
+
+
+/** \brief Sets the geometry of a bit matrix on a block of memory.
+
+\param out the bit matrix
+\param base the block of memory (aligned to BITMATRIX_ALIGNMENT bytes), or NULL to compute only its size
+\param size_update the height of the matrix
+\param size_subscr the \i minimum width in bits of the matrix
+
+\retval the size of the block of memory in bytes
+*/
+size_t bitmatrix_layout(bitmatrix *out, const bitvector base, const _UINT size_update, const _UINT size_subscr)
+{
+	_UINT align;
+
+	// elements in an aligned block
+	align = BITMATRIX_ALIGNMENT / sizeof(bitvec_elem);
+
+	out->base = base;
+	out->rows = size_update;
+	out->width = BIT_VEC_WIDTH(size_subscr);
+	out->stride = ((out->width + align - 1) / align) * align;
+	out->alignment = BITMATRIX_ALIGNMENT;
+
+#if BITMATRIX_ALIAS_STRIDE > 0
+	// pad the rows whose stride would map the same columns on the same cache sets
+	if ((out->stride * sizeof(bitvec_elem)) % BITMATRIX_ALIAS_STRIDE == 0)
+		out->stride += align;
+#endif // BITMATRIX_ALIAS_STRIDE
+
+	return (size_t)out->rows * out->stride * sizeof(bitvec_elem);
+}
+
+
 /** \brief Allocates a bit matrix of given height and width.
 
-\param out pointer to the memory to be allocated
+The rows are allocated with memory_alloc(), so they follow the memory options and are zeroed.
+
+\param out pointer to the bit matrix to be allocated
+\param size_update the height of the matrix
+\param size_subscr the \i minimum width in bits of the matrix
+
+\retval error code
+*/
+_ERR_CODE create_bit_matrix(bitmatrix *out, const _UINT size_update, const _UINT size_subscr)
+{
+	// memory_alloc() returns whole pages, so the rows are aligned
+	out->base = (bitvector)memory_alloc(bitmatrix_layout(out, NULL, size_update, size_subscr));
+	if (out->base == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	return err_none;
+}
+
+
+/** \brief Frees a bit matrix allocated by create_bit_matrix().
+
+\param in the bit matrix
+*/
+void free_bit_matrix(bitmatrix *in)
+{
+	memory_free(in->base, (size_t)BITMATRIX_SIZE(*in) * sizeof(bitvec_elem));
+	in->base = NULL;
+}
+
+
+/** \brief Allocates a bit matrix mapped on a backing file, for results bigger than the memory.
+
+The file holds a header of STORE_HEADER_SIZE bytes followed by the rows. It's mapped shared, so the rows written are paged out to the file instead of being kept in memory; the new parts of the file are zero.
+
+\param out pointer to the bit matrix to be allocated
+\param header pointer to the header of the file
 \param size_update the height of the matrix
 \param size_subscr the \i minimum width in bits of the matrix
+\param path the path of the backing file
+\param resume keep the content of an existing file (otherwise it's truncated)
+
+\retval error code
+*/
+_ERR_CODE create_bit_matrix_store(bitmatrix *out, store_header_t **header, const _UINT size_update, const _UINT size_subscr, const char *path, const _BOOL resume)
+{
+	void *ptr;
+	size_t length;
+#ifdef _MSC_VER
+	HANDLE file, mapping;
+#else // _MSC_VER
+	int fd;
+#endif // _MSC_VER
+
+	length = STORE_HEADER_SIZE + bitmatrix_layout(out, NULL, size_update, size_subscr);
+
+#ifdef _MSC_VER
+	file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, resume ? OPEN_ALWAYS : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return set_error(err_file, __FILE__, __FUNCTION__, __LINE__);
+
+	// the mapping extends the file to its size, and the view keeps it open after the handles are closed
+	mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, (DWORD)((uint64_t)length >> 32), (DWORD)(length & 0xFFFFFFFF), NULL);
+	ptr = (mapping != NULL) ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, length) : NULL;
+	if (mapping != NULL)
+		CloseHandle(mapping);
+	CloseHandle(file);
+
+	if (ptr == NULL)
+		return set_error(err_file, __FILE__, __FUNCTION__, __LINE__);
+#else // _MSC_VER
+	fd = open(path, resume ? (O_RDWR | O_CREAT) : (O_RDWR | O_CREAT | O_TRUNC), 0644);
+	if (fd < 0)
+		return set_error(err_file, __FILE__, __FUNCTION__, __LINE__);
+
+	// the file is extended without writing it (a file of another problem is cut, its header won't match)
+	if (ftruncate(fd, (off_t)length) != 0)
+	{
+		close(fd);
+		return set_error(err_file, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	// the mapping keeps the file open
+	ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (ptr == MAP_FAILED)
+		return set_error(err_file, __FILE__, __FUNCTION__, __LINE__);
+#endif // _MSC_VER
+
+	*header = (store_header_t *)ptr;
+	bitmatrix_layout(out, (bitvector)((char *)ptr + STORE_HEADER_SIZE), size_update, size_subscr);
+
+	return err_none;
+}
+
+
+/** \brief Frees a bit matrix allocated by create_bit_matrix_store().
+
+The file is kept: the pages not written back yet are written by the system.
+
+\param in the bit matrix
+*/
+void free_bit_matrix_store(bitmatrix *in)
+{
+	char *ptr;
+
+	ptr = (char *)in->base - STORE_HEADER_SIZE;
+
+#ifdef _MSC_VER
+	UnmapViewOfFile(ptr);
+#else // _MSC_VER
+	munmap(ptr, STORE_HEADER_SIZE + (size_t)BITMATRIX_SIZE(*in) * sizeof(bitvec_elem));
+#endif // _MSC_VER
+
+	in->base = NULL;
+}
+
+
+/** \brief Writes a range of a file mapping back to the file, and optionally releases its pages.
+
+\param ptr the first byte of the range
+\param length the size of the range in bytes
+\param release drop the pages of the range from the memory of the process once they are in the file
+
+\retval TRUE if the range has been written
+\retval FALSE otherwise
+*/
+static _BOOL memory_writeback(void *ptr, const size_t length, const _BOOL release)
+{
+#ifdef _MSC_VER
+	if (!FlushViewOfFile(ptr, length))
+		return FALSE;
+
+	// unlocking pages that aren't locked removes them from the working set
+	if (release)
+		VirtualUnlock(ptr, length);
+#else // _MSC_VER
+	size_t page;
+	char *first;
+
+	// the range must start on a page (the pages shared with the nearby ranges are written too)
+	page = (size_t)sysconf(_SC_PAGESIZE);
+	first = (char *)((uintptr_t)ptr & ~(uintptr_t)(page - 1));
+
+	if (msync(first, (char *)ptr + length - first, MS_SYNC) != 0)
+		return FALSE;
+
+#ifdef MADV_DONTNEED
+	// the pages are clean, so they are dropped without losing the content (it's read again from the file)
+	if (release)
+		madvise(first, (char *)ptr + length - first, MADV_DONTNEED);
+#endif // MADV_DONTNEED
+#endif // _MSC_VER
+
+	return TRUE;
+}
+
+
+/** \brief Writes a band of rows of a bit matrix allocated by create_bit_matrix_store() back to its file and releases its pages.
+
+\param m the bit matrix
+\param first the first row of the band
+\param last one past the last row of the band
+
+\retval error code
+*/
+_ERR_CODE bitmatrix_band_writeback(const bitmatrix m, const _UINT first, const _UINT last)
+{
+	if (!memory_writeback(BITMATRIX_ROW(m, first), (size_t)(last - first) * m.stride * sizeof(bitvec_elem), TRUE))
+		return set_error(err_file, __FILE__, __FUNCTION__, __LINE__);
+
+	return err_none;
+}
+
+
+/** \brief Writes the header of a backing file back to the file.
+
+\param header the header
+
+\retval error code
+*/
+_ERR_CODE store_header_writeback(store_header_t *header)
+{
+	if (!memory_writeback(header, sizeof(store_header_t), FALSE))
+		return set_error(err_file, __FILE__, __FUNCTION__, __LINE__);
+
+	return err_none;
+}
+
+
+/** \brief Position of the first element of a row of a packed triangular bit matrix.
+
+The rows of each group of BITVEC_ELEM_BITS rows start from the same element, one element after the rows of the group before.
+
+\param width the number of elements of a full row
+\param row the row (the number of rows for the size of the matrix)
+
+\retval the position in elements from the start of the matrix
+*/
+size_t bitmatrix_tri_offset(const _UINT width, const _UINT row)
+{
+	size_t group;
+
+	group = row / BITVEC_ELEM_BITS;
+
+	// the rows of the groups before (width, width - 1, ... elements), then the rows of its group before it
+	return BITVEC_ELEM_BITS * (group * (2 * (size_t)width - group + 1) / 2) + (size_t)(row % BITVEC_ELEM_BITS) * (width - group);
+}
+
+
+/** \brief Sets the geometry of a packed triangular bit matrix on a block of memory.
+
+\param out the packed triangular bit matrix
+\param base the block of memory, or NULL to compute only its size
+\param size the number of rows and columns
+
+\retval the size of the block of memory in bytes
+*/
+size_t bitmatrix_tri_layout(bitmatrix_tri_t *out, const bitvector base, const _UINT size)
+{
+	out->base = base;
+	out->rows = size;
+	out->width = BIT_VEC_WIDTH(size);
+
+	return BITMATRIX_TRI_SIZE(*out) * sizeof(bitvec_elem);
+}
+
+
+/** \brief Allocates a packed triangular bit matrix.
+
+The rows are allocated with memory_alloc(), so they follow the memory options and are zeroed. The rows aren't aligned.
+
+\param out pointer to the packed triangular bit matrix to be allocated
+\param size the number of rows and columns
+
+\retval error code
+*/
+_ERR_CODE create_bit_matrix_tri(bitmatrix_tri_t *out, const _UINT size)
+{
+	out->base = (bitvector)memory_alloc(bitmatrix_tri_layout(out, NULL, size));
+	if (out->base == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	return err_none;
+}
+
+
+/** \brief Frees a packed triangular bit matrix allocated by create_bit_matrix_tri().
+
+\param in the packed triangular bit matrix
+*/
+void free_bit_matrix_tri(bitmatrix_tri_t *in)
+{
+	memory_free(in->base, BITMATRIX_TRI_SIZE(*in) * sizeof(bitvec_elem));
+	in->base = NULL;
+}
+
+
+/** \brief Checks a bit of a packed triangular bit matrix, mirroring the lower triangle on the upper one.
+
+\param m the packed triangular bit matrix
+\param a the row
+\param b the column
+
+\retval TRUE if the bit is set
+\retval FALSE otherwise
+*/
+_BOOL bitmatrix_tri_test(const bitmatrix_tri_t m, const _UINT a, const _UINT b)
+{
+	_UINT row, col;
+
+	// the bit is kept on the row of the smaller of the two
+	row = MIN(a, b);
+	col = MAX(a, b);
+
+	return (BITMATRIX_TRI_ROW(m, row)[BIT_TO_POS(col) - BIT_TO_POS(row)] & DBIT(col % BITVEC_ELEM_BITS)) ? TRUE : FALSE;
+}
+
+
+/** \brief Builds a full row of a packed triangular bit matrix.
+
+The elements from the one of the row are copied, the columns before them are read on the rows before (one bit for each row), so the cost of the mirror is paid only for the rows that are needed.
+
+\param m the packed triangular bit matrix
+\param row the row
+\param line the full row (m.width elements)
+*/
+void bitmatrix_tri_line(const bitmatrix_tri_t m, const _UINT row, const bitvector line)
+{
+	_UINT first, col;
+
+	first = BIT_TO_POS(row);
+
+	// the columns of the elements from the one of the row are on the row
+	memcpy(&line[first], BITMATRIX_TRI_ROW(m, row), (m.width - first) * sizeof(bitvec_elem));
+
+	// the columns before are on the rows before
+	memset(line, 0, first * sizeof(bitvec_elem));
+	for (col = 0; col < first * BITVEC_ELEM_BITS; col++)
+	{
+		if (bitmatrix_tri_test(m, col, row))
+			BITVEC_MARK(line, col);
+	}
+}
+
+
+/** \brief Bitwise NOT of a bit vector (scalar version).
+
+\param vec bit vector to be inverted
+\param size number of elements of the bit vector
+*/
+static void vector_bitwise_not_scalar(const bitvector vec, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		vec[i] = ~vec[i];
+}
+
+
+/** \brief Bitwise AND of two bit vectors (scalar version).
+
+\param result first vector and also resulting vector
+\param mask second vector
+\param size number of elements in the bit vectors
+*/
+static void vector_bitwise_and_scalar(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		result[i] &= mask[i];
+}
+
+
+/** \brief Bitwise OR of two bit vectors (scalar version).
+
+\param result first vector and also resulting vector
+\param mask second vector
+\param size number of elements in the bit vectors
+*/
+static void vector_bitwise_or_scalar(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		result[i] |= mask[i];
+}
+
+
+/** \brief Bitwise AND of a bit vector with the NOT of another one (scalar version).
+
+\param result first vector and also resulting vector
+\param mask second vector, inverted before the AND
+\param size number of elements in the bit vectors
+*/
+static void vector_bitwise_andnot_scalar(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		result[i] &= ~mask[i];
+}
+
+
+/** \brief Bitwise NOR of two bit vectors (scalar version).
+
+\param result first vector and also resulting vector
+\param mask second vector
+\param size number of elements in the bit vectors
+*/
+static void vector_bitwise_nor_scalar(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		result[i] = ~(result[i] | mask[i]);
+}
+
+
+/** \brief Number of set bits of an element of a bit vector.
+
+\param val the element
+
+\retval the number of set bits
+*/
+static INLINE _UINT elem_popcount(bitvec_elem val)
+{
+#ifdef __GNUC__
+#if BITVEC_ELEM_BITS == 64
+	return (_UINT)__builtin_popcountll(val);
+#else // BITVEC_ELEM_BITS
+	return (_UINT)__builtin_popcount(val);
+#endif // BITVEC_ELEM_BITS
+#else // __GNUC__
+	_UINT count;
+
+	// clear the lowest set bit until none is left
+	for (count = 0; val != 0; count++)
+		val &= val - 1;
+
+	return count;
+#endif // __GNUC__
+}
+
+
+/** \brief Position of the first set bit of an element of a bit vector in descending order (the DBIT() of the bit).
+
+\param val the element (not zero)
+
+\retval the position of the bit
+*/
+static INLINE _UINT elem_first_dbit(const bitvec_elem val)
+{
+#ifdef __GNUC__
+#if BITVEC_ELEM_BITS == 64
+	return (_UINT)__builtin_clzll(val);
+#else // BITVEC_ELEM_BITS
+	return (_UINT)__builtin_clz(val);
+#endif // BITVEC_ELEM_BITS
+#else // __GNUC__
+	_UINT bit;
+
+	for (bit = 0; !(val & DBIT(bit)); bit++);
+
+	return bit;
+#endif // __GNUC__
+}
+
+
+/** \brief Positions of the set bits of a range of elements of a bit vector (scalar version).
+
+The bits of each element are found with the count of leading zeros, since bit 0 is the most significant one (as in DBIT()), so the positions are written in ascending order.
+
+\param vec the bit vector
+\param first the first element of the range
+\param last one past the last element of the range
+\param out the positions of the set bits (with room for all of them)
+
+\retval the number of set bits
+*/
+static _UINT vector_bit_positions_scalar(const bitvector vec, const _UINT first, const _UINT last, _UINT *out)
+{
+	_UINT i, bit, count;
+	bitvec_elem val;
+
+	count = 0;
+	for (i = first; i < last; i++)
+	{
+		for (val = vec[i]; val != 0; val ^= DBIT(bit))
+		{
+			bit = elem_first_dbit(val);
+			out[count++] = i * BITVEC_ELEM_BITS + bit;
+		}
+	}
+
+	return count;
+}
+
+
+/** \brief Transposes the last levels of a square block of bits, starting from the swap of sub-blocks of a given size.
+
+Each level swaps the top right and the bottom left sub-blocks of all the sub-blocks of size 2 * level, so the levels from BITVEC_ELEM_BITS / 2 down to 1 transpose the whole block (bit 0 of each element is the first column).
+
+\param block the block, an element for each row
+\param level the size of the sub-blocks swapped by the first level
+\param m the mask of the right sub-blocks of the first level
+*/
+static void transpose_block_levels(const bitvector block, _UINT level, bitvec_elem m)
+{
+	_UINT k;
+	bitvec_elem t;
+
+	for (; level != 0; level >>= 1, m ^= m << level)
+	{
+		// k runs on the top rows of each pair of sub-blocks
+		for (k = 0; k < BITVEC_ELEM_BITS; k = (k + level + 1) & ~level)
+		{
+			t = (block[k] ^ (block[k + level] >> level)) & m;
+			block[k] ^= t;
+			block[k + level] ^= t << level;
+		}
+	}
+}
+
+
+/** \brief Transposes a square block of BITVEC_ELEM_BITS x BITVEC_ELEM_BITS bits in place (scalar version).
+
+\param block the block, an element for each row
+*/
+static void transpose_block_scalar(const bitvector block)
+{
+	transpose_block_levels(block, BITVEC_ELEM_BITS / 2, ~(bitvec_elem)0 >> (BITVEC_ELEM_BITS / 2));
+}
+
+
+#ifdef SIMD_X86
+/* Number of elements of the bit vector in a 128, 256 and 512 bit register */
+#define SSE2_ELEMS			( 16 / sizeof(bitvec_elem) )
+#define AVX2_ELEMS			( 32 / sizeof(bitvec_elem) )
+#define AVX512_ELEMS		( 64 / sizeof(bitvec_elem) )
+
+/* Broadcast and shifts of the elements of the bit vector in a register */
+#if BITVEC_ELEM_BITS == 64
+#define SSE2_SET1(_x)		_mm_set1_epi64x((long long)(_x))
+#define SSE2_SRL(_v, _c)	_mm_srl_epi64(_v, _c)
+#define SSE2_SLL(_v, _c)	_mm_sll_epi64(_v, _c)
+#define AVX2_SET1(_x)		_mm256_set1_epi64x((long long)(_x))
+#define AVX2_SRL(_v, _c)	_mm256_srl_epi64(_v, _c)
+#define AVX2_SLL(_v, _c)	_mm256_sll_epi64(_v, _c)
+#else // BITVEC_ELEM_BITS
+#define SSE2_SET1(_x)		_mm_set1_epi32((int)(_x))
+#define SSE2_SRL(_v, _c)	_mm_srl_epi32(_v, _c)
+#define SSE2_SLL(_v, _c)	_mm_sll_epi32(_v, _c)
+#define AVX2_SET1(_x)		_mm256_set1_epi32((int)(_x))
+#define AVX2_SRL(_v, _c)	_mm256_srl_epi32(_v, _c)
+#define AVX2_SLL(_v, _c)	_mm256_sll_epi32(_v, _c)
+#endif // BITVEC_ELEM_BITS
+
+
+/** \brief Bitwise NOT of a bit vector (SSE2 version).
+*/
+TARGET("sse2") static void vector_bitwise_not_sse2(const bitvector vec, const size_t size)
+{
+	size_t i;
+	__m128i ones = _mm_set1_epi32(-1);
+
+	for (i = 0; i + SSE2_ELEMS <= size; i += SSE2_ELEMS)
+		_mm_storeu_si128((__m128i *)&vec[i], _mm_xor_si128(_mm_loadu_si128((__m128i *)&vec[i]), ones));
+
+	vector_bitwise_not_scalar(&vec[i], size - i);
+}
+
+
+/** \brief Bitwise AND of two bit vectors (SSE2 version).
+*/
+TARGET("sse2") static void vector_bitwise_and_sse2(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i + SSE2_ELEMS <= size; i += SSE2_ELEMS)
+		_mm_storeu_si128((__m128i *)&result[i], _mm_and_si128(_mm_loadu_si128((__m128i *)&result[i]), _mm_loadu_si128((__m128i *)&mask[i])));
+
+	vector_bitwise_and_scalar(&result[i], &mask[i], size - i);
+}
+
+
+/** \brief Bitwise OR of two bit vectors (SSE2 version).
+*/
+TARGET("sse2") static void vector_bitwise_or_sse2(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i + SSE2_ELEMS <= size; i += SSE2_ELEMS)
+		_mm_storeu_si128((__m128i *)&result[i], _mm_or_si128(_mm_loadu_si128((__m128i *)&result[i]), _mm_loadu_si128((__m128i *)&mask[i])));
+
+	vector_bitwise_or_scalar(&result[i], &mask[i], size - i);
+}
+
+
+/** \brief Bitwise AND of a bit vector with the NOT of another one (SSE2 version with streaming stores).
+*/
+TARGET("sse2") static void vector_bitwise_andnot_sse2(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	// the streaming stores need aligned addresses
+	for (i = 0; i < size && ((uintptr_t)&result[i] % 16) != 0; i++)
+		result[i] &= ~mask[i];
+
+	for (; i + SSE2_ELEMS <= size; i += SSE2_ELEMS)
+		_mm_stream_si128((__m128i *)&result[i], _mm_andnot_si128(_mm_loadu_si128((__m128i *)&mask[i]), _mm_load_si128((__m128i *)&result[i])));
+	_mm_sfence();
+
+	vector_bitwise_andnot_scalar(&result[i], &mask[i], size - i);
+}
+
+
+/** \brief Bitwise NOR of two bit vectors (SSE2 version with streaming stores).
+*/
+TARGET("sse2") static void vector_bitwise_nor_sse2(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+	__m128i ones = _mm_set1_epi32(-1);
+
+	// the streaming stores need aligned addresses
+	for (i = 0; i < size && ((uintptr_t)&result[i] % 16) != 0; i++)
+		result[i] = ~(result[i] | mask[i]);
+
+	for (; i + SSE2_ELEMS <= size; i += SSE2_ELEMS)
+		_mm_stream_si128((__m128i *)&result[i], _mm_xor_si128(_mm_or_si128(_mm_load_si128((__m128i *)&result[i]), _mm_loadu_si128((__m128i *)&mask[i])), ones));
+	_mm_sfence();
+
+	vector_bitwise_nor_scalar(&result[i], &mask[i], size - i);
+}
+
+
+/** \brief Transposes a square block of BITVEC_ELEM_BITS x BITVEC_ELEM_BITS bits in place (SSE2 version).
+
+The levels that swap sub-blocks of at least a register of rows are done on whole registers, the last ones by the scalar code.
+*/
+TARGET("sse2") static void transpose_block_sse2(const bitvector block)
+{
+	_UINT level, first, k;
+	bitvec_elem m;
+	__m128i a, b, t, vm, count;
+
+	m = ~(bitvec_elem)0 >> (BITVEC_ELEM_BITS / 2);
+	for (level = BITVEC_ELEM_BITS / 2; level >= SSE2_ELEMS; level >>= 1, m ^= m << level)
+	{
+		vm = SSE2_SET1(m);
+		count = _mm_cvtsi32_si128((int)level);
+
+		// for each pair of sub-blocks, the top rows are swapped with the bottom ones a register at a time
+		for (first = 0; first < BITVEC_ELEM_BITS; first += 2 * level)
+		{
+			for (k = first; k < first + level; k += SSE2_ELEMS)
+			{
+				a = _mm_loadu_si128((__m128i *)&block[k]);
+				b = _mm_loadu_si128((__m128i *)&block[k + level]);
+				t = _mm_and_si128(_mm_xor_si128(a, SSE2_SRL(b, count)), vm);
+				_mm_storeu_si128((__m128i *)&block[k], _mm_xor_si128(a, t));
+				_mm_storeu_si128((__m128i *)&block[k + level], _mm_xor_si128(b, SSE2_SLL(t, count)));
+			}
+		}
+	}
+
+	transpose_block_levels(block, level, m);
+}
+#endif // SIMD_X86
+
+
+#ifdef SIMD_AVX2
+/** \brief Bitwise NOT of a bit vector (AVX2 version).
+*/
+TARGET("avx2") static void vector_bitwise_not_avx2(const bitvector vec, const size_t size)
+{
+	size_t i;
+	__m256i ones = _mm256_set1_epi32(-1);
+
+	for (i = 0; i + AVX2_ELEMS <= size; i += AVX2_ELEMS)
+		_mm256_storeu_si256((__m256i *)&vec[i], _mm256_xor_si256(_mm256_loadu_si256((__m256i *)&vec[i]), ones));
+
+	vector_bitwise_not_scalar(&vec[i], size - i);
+}
+
+
+/** \brief Bitwise AND of two bit vectors (AVX2 version).
+*/
+TARGET("avx2") static void vector_bitwise_and_avx2(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i + AVX2_ELEMS <= size; i += AVX2_ELEMS)
+		_mm256_storeu_si256((__m256i *)&result[i], _mm256_and_si256(_mm256_loadu_si256((__m256i *)&result[i]), _mm256_loadu_si256((__m256i *)&mask[i])));
+
+	vector_bitwise_and_scalar(&result[i], &mask[i], size - i);
+}
+
+
+/** \brief Bitwise OR of two bit vectors (AVX2 version).
+*/
+TARGET("avx2") static void vector_bitwise_or_avx2(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i + AVX2_ELEMS <= size; i += AVX2_ELEMS)
+		_mm256_storeu_si256((__m256i *)&result[i], _mm256_or_si256(_mm256_loadu_si256((__m256i *)&result[i]), _mm256_loadu_si256((__m256i *)&mask[i])));
+
+	vector_bitwise_or_scalar(&result[i], &mask[i], size - i);
+}
+
+
+/** \brief Bitwise AND of a bit vector with the NOT of another one (AVX2 version with streaming stores).
+*/
+TARGET("avx2") static void vector_bitwise_andnot_avx2(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	// the streaming stores need aligned addresses
+	for (i = 0; i < size && ((uintptr_t)&result[i] % 32) != 0; i++)
+		result[i] &= ~mask[i];
+
+	for (; i + AVX2_ELEMS <= size; i += AVX2_ELEMS)
+		_mm256_stream_si256((__m256i *)&result[i], _mm256_andnot_si256(_mm256_loadu_si256((__m256i *)&mask[i]), _mm256_load_si256((__m256i *)&result[i])));
+	_mm_sfence();
+
+	vector_bitwise_andnot_scalar(&result[i], &mask[i], size - i);
+}
+
+
+/** \brief Bitwise NOR of two bit vectors (AVX2 version with streaming stores).
+*/
+TARGET("avx2") static void vector_bitwise_nor_avx2(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+	__m256i ones = _mm256_set1_epi32(-1);
+
+	// the streaming stores need aligned addresses
+	for (i = 0; i < size && ((uintptr_t)&result[i] % 32) != 0; i++)
+		result[i] = ~(result[i] | mask[i]);
+
+	for (; i + AVX2_ELEMS <= size; i += AVX2_ELEMS)
+		_mm256_stream_si256((__m256i *)&result[i], _mm256_xor_si256(_mm256_or_si256(_mm256_load_si256((__m256i *)&result[i]), _mm256_loadu_si256((__m256i *)&mask[i])), ones));
+	_mm_sfence();
+
+	vector_bitwise_nor_scalar(&result[i], &mask[i], size - i);
+}
+
+
+/** \brief Transposes a square block of BITVEC_ELEM_BITS x BITVEC_ELEM_BITS bits in place (AVX2 version).
+
+The levels that swap sub-blocks of at least a register of rows are done on whole registers, the last ones by the scalar code.
+*/
+TARGET("avx2") static void transpose_block_avx2(const bitvector block)
+{
+	_UINT level, first, k;
+	bitvec_elem m;
+	__m256i a, b, t, vm;
+	__m128i count;
+
+	m = ~(bitvec_elem)0 >> (BITVEC_ELEM_BITS / 2);
+	for (level = BITVEC_ELEM_BITS / 2; level >= AVX2_ELEMS; level >>= 1, m ^= m << level)
+	{
+		vm = AVX2_SET1(m);
+		count = _mm_cvtsi32_si128((int)level);
+
+		// for each pair of sub-blocks, the top rows are swapped with the bottom ones a register at a time
+		for (first = 0; first < BITVEC_ELEM_BITS; first += 2 * level)
+		{
+			for (k = first; k < first + level; k += AVX2_ELEMS)
+			{
+				a = _mm256_loadu_si256((__m256i *)&block[k]);
+				b = _mm256_loadu_si256((__m256i *)&block[k + level]);
+				t = _mm256_and_si256(_mm256_xor_si256(a, AVX2_SRL(b, count)), vm);
+				_mm256_storeu_si256((__m256i *)&block[k], _mm256_xor_si256(a, t));
+				_mm256_storeu_si256((__m256i *)&block[k + level], _mm256_xor_si256(b, AVX2_SLL(t, count)));
+			}
+		}
+	}
+
+	transpose_block_levels(block, level, m);
+}
+#endif // SIMD_AVX2
+
+
+#ifdef SIMD_AVX512
+/** \brief Positions of the set bits of a range of elements of a bit vector (AVX-512 version).
+
+Each group of 16 bits is compressed in a single instruction: the bit j of the group (from the least significant one) is the column 15 - j of the group, so the compressed columns are descending and one permutation of the first lanes puts them back in ascending order.
+*/
+TARGET("avx512f") static _UINT vector_bit_positions_avx512(const bitvector vec, const _UINT first, const _UINT last, _UINT *out)
+{
+	_UINT i, k, n, count;
+	__mmask16 bits;
+	__m512i columns, reverse, lanes;
+
+	// the columns of a group, from the last one
+	reverse = _mm512_set_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	lanes = _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
+	count = 0;
+	for (i = first; i < last; i++)
+	{
+		if (vec[i] == 0)
+			continue;
+
+		// for each group of 16 bits, from the most significant one
+		for (k = 0; k < BITVEC_ELEM_BITS; k += 16)
+		{
+			bits = (__mmask16)(vec[i] >> (BITVEC_ELEM_BITS - 16 - k));
+			if (bits == 0)
+				continue;
+
+			n = (_UINT)elem_popcount(bits);
+			columns = _mm512_maskz_compress_epi32(bits, _mm512_add_epi32(reverse, _mm512_set1_epi32((int)(i * BITVEC_ELEM_BITS + k))));
+			columns = _mm512_permutexvar_epi32(_mm512_sub_epi32(_mm512_set1_epi32((int)n - 1), lanes), columns);
+			_mm512_mask_storeu_epi32(&out[count], (__mmask16)((1U << n) - 1), columns);
+			count += n;
+		}
+	}
+
+	return count;
+}
+#endif // SIMD_AVX512
+
+
+#ifdef SIMD_AVX512
+/** \brief Bitwise NOT of a bit vector (AVX-512 version).
+*/
+TARGET("avx512f") static void vector_bitwise_not_avx512(const bitvector vec, const size_t size)
+{
+	size_t i;
+	__m512i ones = _mm512_set1_epi32(-1);
+
+	for (i = 0; i + AVX512_ELEMS <= size; i += AVX512_ELEMS)
+		_mm512_storeu_si512((void *)&vec[i], _mm512_xor_si512(_mm512_loadu_si512((void *)&vec[i]), ones));
+
+	vector_bitwise_not_scalar(&vec[i], size - i);
+}
+
+
+/** \brief Bitwise AND of two bit vectors (AVX-512 version).
+*/
+TARGET("avx512f") static void vector_bitwise_and_avx512(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i + AVX512_ELEMS <= size; i += AVX512_ELEMS)
+		_mm512_storeu_si512((void *)&result[i], _mm512_and_si512(_mm512_loadu_si512((void *)&result[i]), _mm512_loadu_si512((void *)&mask[i])));
+
+	vector_bitwise_and_scalar(&result[i], &mask[i], size - i);
+}
+
+
+/** \brief Bitwise OR of two bit vectors (AVX-512 version).
+*/
+TARGET("avx512f") static void vector_bitwise_or_avx512(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i + AVX512_ELEMS <= size; i += AVX512_ELEMS)
+		_mm512_storeu_si512((void *)&result[i], _mm512_or_si512(_mm512_loadu_si512((void *)&result[i]), _mm512_loadu_si512((void *)&mask[i])));
+
+	vector_bitwise_or_scalar(&result[i], &mask[i], size - i);
+}
+
+
+/** \brief Bitwise AND of a bit vector with the NOT of another one (AVX-512 version with streaming stores).
+*/
+TARGET("avx512f") static void vector_bitwise_andnot_avx512(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+
+	// the streaming stores need aligned addresses
+	for (i = 0; i < size && ((uintptr_t)&result[i] % 64) != 0; i++)
+		result[i] &= ~mask[i];
+
+	for (; i + AVX512_ELEMS <= size; i += AVX512_ELEMS)
+		_mm512_stream_si512((void *)&result[i], _mm512_andnot_si512(_mm512_loadu_si512((void *)&mask[i]), _mm512_load_si512((void *)&result[i])));
+	_mm_sfence();
+
+	vector_bitwise_andnot_scalar(&result[i], &mask[i], size - i);
+}
+
+
+/** \brief Bitwise NOR of two bit vectors (AVX-512 version with streaming stores).
+*/
+TARGET("avx512f") static void vector_bitwise_nor_avx512(const bitvector result, const bitvector mask, const size_t size)
+{
+	size_t i;
+	__m512i ones = _mm512_set1_epi32(-1);
+
+	// the streaming stores need aligned addresses
+	for (i = 0; i < size && ((uintptr_t)&result[i] % 64) != 0; i++)
+		result[i] = ~(result[i] | mask[i]);
+
+	for (; i + AVX512_ELEMS <= size; i += AVX512_ELEMS)
+		_mm512_stream_si512((void *)&result[i], _mm512_xor_si512(_mm512_or_si512(_mm512_load_si512((void *)&result[i]), _mm512_loadu_si512((void *)&mask[i])), ones));
+	_mm_sfence();
+
+	vector_bitwise_nor_scalar(&result[i], &mask[i], size - i);
+}
+#endif // SIMD_AVX512
+
+
+/** \brief Table of the bitwise kernels.
+*/
+typedef struct
+{
+	void (*bitwise_not)(const bitvector, const size_t);						///< bitwise NOT kernel
+	void (*bitwise_and)(const bitvector, const bitvector, const size_t);		///< bitwise AND kernel
+	void (*bitwise_or)(const bitvector, const bitvector, const size_t);		///< bitwise OR kernel
+	void (*bitwise_andnot)(const bitvector, const bitvector, const size_t);	///< bitwise AND NOT kernel
+	void (*bitwise_nor)(const bitvector, const bitvector, const size_t);		///< bitwise NOR kernel
+	void (*transpose_block)(const bitvector);								///< transpose kernel of a square block of bits
+	_UINT (*bit_positions)(const bitvector, const _UINT, const _UINT, _UINT *);	///< kernel of the positions of the set bits
+} bitwise_kernels_t;
+
+
+/** \brief The bitwise kernels in use (scalar until select_bitwise_kernels() is called).
+*/
+static bitwise_kernels_t kernels = { vector_bitwise_not_scalar, vector_bitwise_and_scalar, vector_bitwise_or_scalar, vector_bitwise_andnot_scalar, vector_bitwise_nor_scalar, transpose_block_scalar, vector_bit_positions_scalar };
+
+
+/** \brief Best instruction set supported by the processor and the operating system.
+
+\retval the instruction set
+*/
+static simd_t detect_simd()
+{
+#if defined(SIMD_X86) && defined(__GNUC__)
+	__builtin_cpu_init();
+#ifdef SIMD_AVX512
+	if (__builtin_cpu_supports("avx512f"))
+		return simd_avx512;
+#endif // SIMD_AVX512
+	if (__builtin_cpu_supports("avx2"))
+		return simd_avx2;
+	if (__builtin_cpu_supports("sse2"))
+		return simd_sse2;
+#elif defined(SIMD_X86) && defined(_MSC_VER)
+	int info[4];
+	unsigned __int64 xcr0 = 0;
+
+	__cpuid(info, 0);
+	if (info[0] < 1)
+		return simd_scalar;
+
+	__cpuid(info, 1);
+	// the registers saved by the operating system (only if OSXSAVE is set)
+	if (info[2] & (1 << 27))
+		xcr0 = _xgetbv(0);
+
+#ifdef SIMD_AVX2
+	if ((xcr0 & 0x06) == 0x06)
+	{
+		__cpuidex(info, 7, 0);
+#ifdef SIMD_AVX512
+		if ((info[1] & (1 << 16)) && (xcr0 & 0xE6) == 0xE6)
+			return simd_avx512;
+#endif // SIMD_AVX512
+		if (info[1] & (1 << 5))
+			return simd_avx2;
+	}
+#endif // SIMD_AVX2
+
+	__cpuid(info, 1);
+	if (info[3] & (1 << 26))
+		return simd_sse2;
+#endif // SIMD_X86
+
+	return simd_scalar;
+}
+
+
+/** \brief Selects the bitwise kernels.
+
+The kernels are selected once at startup, using the instruction set requested in the global options if supported, otherwise the best one supported by the processor.
+
+\retval the instruction set of the selected kernels
+*/
+simd_t select_bitwise_kernels()
+{
+	simd_t simd;
+
+	simd = detect_simd();
+	if (OPT_VAR.simd != simd_auto && OPT_VAR.simd < simd)
+		simd = OPT_VAR.simd;
+
+	switch (simd)
+	{
+#ifdef SIMD_AVX512
+	case simd_avx512:
+		kernels.bitwise_not = vector_bitwise_not_avx512;
+		kernels.bitwise_and = vector_bitwise_and_avx512;
+		kernels.bitwise_or = vector_bitwise_or_avx512;
+		kernels.bitwise_andnot = vector_bitwise_andnot_avx512;
+		kernels.bitwise_nor = vector_bitwise_nor_avx512;
+		// the block of the transpose is too small for the 512 bit registers
+		kernels.transpose_block = transpose_block_avx2;
+		kernels.bit_positions = vector_bit_positions_avx512;
+		break;
+#endif // SIMD_AVX512
+#ifdef SIMD_AVX2
+	case simd_avx2:
+		kernels.bitwise_not = vector_bitwise_not_avx2;
+		kernels.bitwise_and = vector_bitwise_and_avx2;
+		kernels.bitwise_or = vector_bitwise_or_avx2;
+		kernels.bitwise_andnot = vector_bitwise_andnot_avx2;
+		kernels.bitwise_nor = vector_bitwise_nor_avx2;
+		kernels.transpose_block = transpose_block_avx2;
+		kernels.bit_positions = vector_bit_positions_scalar;
+		break;
+#endif // SIMD_AVX2
+#ifdef SIMD_X86
+	case simd_sse2:
+		kernels.bitwise_not = vector_bitwise_not_sse2;
+		kernels.bitwise_and = vector_bitwise_and_sse2;
+		kernels.bitwise_or = vector_bitwise_or_sse2;
+		kernels.bitwise_andnot = vector_bitwise_andnot_sse2;
+		kernels.bitwise_nor = vector_bitwise_nor_sse2;
+		kernels.transpose_block = transpose_block_sse2;
+		kernels.bit_positions = vector_bit_positions_scalar;
+		break;
+#endif // SIMD_X86
+	default:
+		simd = simd_scalar;
+		kernels.bitwise_not = vector_bitwise_not_scalar;
+		kernels.bitwise_and = vector_bitwise_and_scalar;
+		kernels.bitwise_or = vector_bitwise_or_scalar;
+		kernels.bitwise_andnot = vector_bitwise_andnot_scalar;
+		kernels.bitwise_nor = vector_bitwise_nor_scalar;
+		kernels.transpose_block = transpose_block_scalar;
+		kernels.bit_positions = vector_bit_positions_scalar;
+		break;
+	}
+
+	return simd;
+}
+
+
+/** \brief Bitwise NOT of a bit vector.
+
+It can also be used to do the bitwise NOT of the matrix, since it's allocated as linear memory.
+
+\param vec bit vector to be inverted
+\param size number of elements of the bit vector
+*/
+void vector_bitwise_not(const bitvector vec, const size_t size)
+{
+	kernels.bitwise_not(vec, size);
+}
+
+
+/** \brief Bitwise AND of two bit vectors.
+
+It can also be used to do the bitwise AND of the matrix, since it's allocated as linear memory.
+
+\param result first vector and also resulting vector
+\param mask second vector
+\param size number of elements in the bit vectors
+*/
+void vector_bitwise_and(const bitvector result, const bitvector mask, const size_t size)
+{
+	kernels.bitwise_and(result, mask, size);
+}
+
+
+/** \brief Bitwise OR of two bit vectors.
+
+It can also be used to do the bitwise OR of the matrix, since it's allocated as linear memory.
+
+\param result first vector and also resulting vector
+\param mask second vector
+\param size number of elements in the bit vectors
+*/
+void vector_bitwise_or(const bitvector result, const bitvector mask, const size_t size)
+{
+	kernels.bitwise_or(result, mask, size);
+}
+
+
+/** \brief Bitwise AND of a bit vector with the NOT of another one.
+
+It's the fused form of a NOT followed by an AND, so the vectors are read and written only once.
+The SIMD versions write the result with streaming stores, since the bit matrices are usually much bigger than the cache.
+
+\param result first vector and also resulting vector
+\param mask second vector, inverted before the AND
+\param size number of elements in the bit vectors
+*/
+void vector_bitwise_andnot(const bitvector result, const bitvector mask, const size_t size)
+{
+	kernels.bitwise_andnot(result, mask, size);
+}
+
+
+/** \brief Bitwise NOR of two bit vectors.
+
+It's the fused form of the NOT of both vectors followed by an AND, so the vectors are read and written only once.
+
+\param result first vector and also resulting vector
+\param mask second vector
+\param size number of elements in the bit vectors
+*/
+void vector_bitwise_nor(const bitvector result, const bitvector mask, const size_t size)
+{
+	kernels.bitwise_nor(result, mask, size);
+}
+
+
+/** \brief Sets the geometry of the occupancy summary of a bit matrix on a block of memory.
+
+\param summary the occupancy summary
+\param base the block of memory, or NULL to compute only its size
+\param m the bit matrix
+
+\retval the size of the block of memory in bytes
+*/
+size_t bitmatrix_summary_layout(bitmatrix_summary_t *summary, const bitvector base, const bitmatrix m)
+{
+	size_t block_elems;
+
+	summary->rows = m.rows;
+	summary->blocks = (m.width + BITMATRIX_SUMMARY_ELEMS - 1) / BITMATRIX_SUMMARY_ELEMS;
+
+	// elements of the bit vectors of the blocks
+	block_elems = BIT_VEC_WIDTH((size_t)summary->rows * summary->blocks);
+
+	summary->zero = base;
+	summary->one = (base != NULL) ? base + block_elems : NULL;
+	summary->empty = (base != NULL) ? base + 2 * block_elems : NULL;
+
+	return (size_t)(2 * block_elems + BIT_VEC_WIDTH(summary->rows)) * sizeof(bitvec_elem);
+}
+
+
+/** \brief Allocates the occupancy summary of a bit matrix.
+
+\param summary the occupancy summary
+\param m the bit matrix
+
+\retval error code
+*/
+_ERR_CODE create_bitmatrix_summary(bitmatrix_summary_t *summary, const bitmatrix m)
+{
+	bitvector base;
+
+	base = (bitvector)malloc(bitmatrix_summary_layout(summary, NULL, m));
+	if (base == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	bitmatrix_summary_layout(summary, base, m);
+
+	return err_none;
+}
+
+
+/** \brief Frees the occupancy summary allocated by create_bitmatrix_summary().
+
+\param summary the occupancy summary
+*/
+void free_bitmatrix_summary(bitmatrix_summary_t *summary)
+{
+	free(summary->zero);
+
+	memset(summary, 0, sizeof(bitmatrix_summary_t));
+}
+
+
+/** \brief Records the state of a block in the occupancy summary.
+
+\param summary the occupancy summary
+\param block the number of the block (row after row)
+\param any bitwise OR of the elements of the block
+\param all bitwise AND of the elements of the block
+*/
+static INLINE void summary_set_block(const bitmatrix_summary_t *summary, const size_t block, const bitvec_elem any, const bitvec_elem all)
+{
+	if (any == 0)
+		BITVEC_MARK(summary->zero, block);
+	else
+		BITVEC_UNMARK(summary->zero, block);
+
+	if (all == ~(bitvec_elem)0)
+		BITVEC_MARK(summary->one, block);
+	else
+		BITVEC_UNMARK(summary->one, block);
+}
+
+
+/** \brief Builds the occupancy summary of a bit matrix.
+
+\param m the bit matrix
+\param summary the occupancy summary
+\param inverted TRUE if the matrix holds the non-matching subscription extents (a row is empty when all its blocks are all ones)
+*/
+void bitmatrix_summarize(const bitmatrix m, const bitmatrix_summary_t *summary, const _BOOL inverted)
+{
+	_UINT row, block, i;
+	_UINT first, last;
+	size_t n;
+	_BOOL empty;
+	bitvec_elem any, all;
+	bitvector vec;
+
+	// for each row
+	for (row = 0; row < m.rows; row++)
+	{
+		vec = BITMATRIX_ROW(m, row);
+		empty = TRUE;
+
+		// for each block of the row
+		for (block = 0; block < summary->blocks; block++)
+		{
+			first = block * BITMATRIX_SUMMARY_ELEMS;
+			last = MIN(first + BITMATRIX_SUMMARY_ELEMS, m.width);
+
+			any = 0;
+			all = ~(bitvec_elem)0;
+			for (i = first; i < last; i++)
+			{
+				any |= vec[i];
+				all &= vec[i];
+			}
+
+			n = (size_t)row * summary->blocks + block;
+			summary_set_block(summary, n, any, all);
+			empty = empty && BITVEC_TEST(inverted ? summary->one : summary->zero, n);
+		}
+
+		if (empty)
+			BITVEC_MARK(summary->empty, row);
+		else
+			BITVEC_UNMARK(summary->empty, row);
+	}
+}
+
+
+/** \brief Updates the occupancy summary after the bitwise NOT of its bit matrix: the zero blocks become all ones and vice versa.
+
+\param summary the occupancy summary
+*/
+void bitmatrix_summary_invert(const bitmatrix_summary_t *summary)
+{
+	size_t i;
+	bitvec_elem tmp;
+
+	for (i = 0; i < BIT_VEC_WIDTH((size_t)summary->rows * summary->blocks); i++)
+	{
+		tmp = summary->zero[i];
+		summary->zero[i] = summary->one[i];
+		summary->one[i] = tmp;
+	}
+}
+
+
+/** \brief Bitwise AND of a bit matrix with the NOT of another one, skipping the decided blocks.
+
+The empty rows and the zero blocks of the result can't change, so they are neither read nor written. The summary of the other blocks is updated in the same pass.
+
+\param result first matrix and also resulting matrix
+\param mask second matrix (with the same geometry), inverted before the AND
+\param summary the occupancy summary of the result
+*/
+void bitmatrix_andnot_summary(const bitmatrix result, const bitmatrix mask, const bitmatrix_summary_t *summary)
+{
+	_UINT row, block, i;
+	_UINT first, last;
+	size_t n;
+	_BOOL empty;
+	bitvec_elem val, any, all;
+	bitvector vec, mask_vec;
+
+	// for each row that can still have matches
+	for (row = 0; row < result.rows; row++)
+	{
+		if (BITVEC_TEST(summary->empty, row))
+			continue;
+
+		vec = BITMATRIX_ROW(result, row);
+		mask_vec = BITMATRIX_ROW(mask, row);
+		empty = TRUE;
+
+		// for each block of the row that isn't zero
+		for (block = 0; block < summary->blocks; block++)
+		{
+			n = (size_t)row * summary->blocks + block;
+			if (BITVEC_TEST(summary->zero, n))
+				continue;
+
+			first = block * BITMATRIX_SUMMARY_ELEMS;
+			last = MIN(first + BITMATRIX_SUMMARY_ELEMS, result.width);
+
+			any = 0;
+			all = ~(bitvec_elem)0;
+			for (i = first; i < last; i++)
+			{
+				val = vec[i] & ~mask_vec[i];
+				vec[i] = val;
+				any |= val;
+				all &= val;
+			}
+
+			summary_set_block(summary, n, any, all);
+			empty = empty && (any == 0);
+		}
+
+		if (empty)
+			BITVEC_MARK(summary->empty, row);
+	}
+}
+
+
+/** \brief Transposes a bit matrix.
+
+The output has a row for each column of the input and a column for each row of the input, so the transpose of the result gives, for each subscription extent, the update extents that match it.
+The matrices are split in square blocks of BITVEC_ELEM_BITS x BITVEC_ELEM_BITS bits, each one transposed in a local buffer. The blocks are visited in square tiles of BITMATRIX_TRANSPOSE_TILE blocks, so that the rows of a tile stay in the cache on both sides while the tile is read and written. The zero blocks are only written.
+
+\param in the bit matrix to be transposed
+\param out the transposed matrix, with out.rows equal to the columns of the input and out.width wide enough for in.rows columns
+*/
+void bitmatrix_transpose(const bitmatrix in, const bitmatrix out)
+{
+	_UINT tile_col, tile_row, col, row, i;
+	_UINT last_col, last_row;
+	bitvec_elem block[BITVEC_ELEM_BITS];
+	bitvec_elem any;
+
+	// for each tile (its columns are elements of the input rows, its rows are elements of the output rows)
+	for (tile_col = 0; tile_col < in.width; tile_col += BITMATRIX_TRANSPOSE_TILE)
+	{
+		last_col = MIN(tile_col + BITMATRIX_TRANSPOSE_TILE, in.width);
+
+		for (tile_row = 0; tile_row < out.width; tile_row += BITMATRIX_TRANSPOSE_TILE)
+		{
+			last_row = MIN(tile_row + BITMATRIX_TRANSPOSE_TILE, out.width);
+
+			// for each block of the tile
+			for (col = tile_col; col < last_col && col * BITVEC_ELEM_BITS < out.rows; col++)
+			{
+				for (row = tile_row; row < last_row; row++)
+				{
+					// read the block (the rows after the last one are zero)
+					any = 0;
+					for (i = 0; i < BITVEC_ELEM_BITS; i++)
+					{
+						block[i] = (row * BITVEC_ELEM_BITS + i < in.rows) ? BITMATRIX_ROW(in, row * BITVEC_ELEM_BITS + i)[col] : 0;
+						any |= block[i];
+					}
+
+					if (any != 0)
+						kernels.transpose_block(block);
+
+					// write the block (the columns after the last one of the input are the padding)
+					for (i = 0; i < BITVEC_ELEM_BITS && col * BITVEC_ELEM_BITS + i < out.rows; i++)
+						BITMATRIX_ROW(out, col * BITVEC_ELEM_BITS + i)[row] = block[i];
+				}
+			}
+		}
+	}
+}
+
+
+/** \brief Fills the endpoints list of the self-matching.
+
+Each update extent is listed once with its two endpoints, and its identifier is its index: it has both the roles of update and subscription extent.
+
+\param data the data set (only the update extents are used)
+\param out the endpoints list (size_update * 2 elements)
+\param dimension the dimension of the endpoints
+*/
+void set_self_endpoints_list(const match_data_t data, const list_ptr out, const _UINT dimension)
+{
+	_UINT i, count;
+
+	count = 0;
+
+	// for each extent
+	for (i = 0; i < data.size_update; i++)
+	{
+		out[count].id = i;
+		out[count].is_lower_point = TRUE;
+
+#ifdef __SUPERSET
+		if (data.update[i].endpoints[dimension].lower > SPACE_TYPE_MIN)
+			out[count++].point = data.update[i].endpoints[dimension].lower - SPACE_TYPE_INC;
+		else
+#endif // __SUPERSET
+			out[count++].point = data.update[i].endpoints[dimension].lower;
+
+		out[count].id = i;
+		out[count].is_lower_point = FALSE;
+
+#ifdef __SUPERSET
+		if (data.update[i].endpoints[dimension].upper < SPACE_TYPE_MAX)
+			out[count++].point = data.update[i].endpoints[dimension].upper + SPACE_TYPE_INC;
+		else
+#endif // __SUPERSET
+			out[count++].point = data.update[i].endpoints[dimension].upper;
+	}
+}
+
+
+/** \brief Fills the endpoints list with the values for a given dimension.
+
+\param data the data set.
+\param out the pointer to the list to be filled
+\param dimension the number of the dimension to be processed
+*/
+void set_endpoints_list(const match_data_t data, const list_ptr out, const _UINT dimension)
+{
+	_UINT i, count;
+
+	count = 0;
+
+	// for each subscription extent
+	for (i = 0; i < data.size_subscr; i++)
+	{
+		out[count].id = i;
+		out[count].is_lower_point = TRUE;
+
+#ifdef __SUPERSET
+		if (data.subscr[i].endpoints[dimension].lower > SPACE_TYPE_MIN)
+			out[count++].point = data.subscr[i].endpoints[dimension].lower - SPACE_TYPE_INC;
+		else
+#endif // __SUPERSET
+			out[count++].point = data.subscr[i].endpoints[dimension].lower;
+
+		out[count].id = i;
+		out[count].is_lower_point = FALSE;
+
+#ifdef __SUPERSET
+		if (data.subscr[i].endpoints[dimension].upper < SPACE_TYPE_MAX)
+			out[count++].point = data.subscr[i].endpoints[dimension].upper + SPACE_TYPE_INC;
+		else
+#endif // __SUPERSET
+			out[count++].point = data.subscr[i].endpoints[dimension].upper;
+	}
+
+	// for each update extent
+	for (i = 0; i < data.size_update; i++)
+	{
+		// IDs of update extents in the "list" follow the IDs of subscription extents
+		// this way is possible to distinguish subscription and update extents without having to store another variable
+		out[count].id = i + data.size_subscr;
+		out[count].is_lower_point = TRUE;
+
+#ifdef __SUPERSET
+		if (data.update[i].endpoints[dimension].lower > SPACE_TYPE_MIN)
+			out[count++].point = data.update[i].endpoints[dimension].lower - SPACE_TYPE_INC;
+		else
+#endif // __SUPERSET
+			out[count++].point = data.update[i].endpoints[dimension].lower;
+
+		out[count].id = i + data.size_subscr;
+		out[count].is_lower_point = FALSE;
+
+#ifdef __SUPERSET
+		if (data.update[i].endpoints[dimension].upper < SPACE_TYPE_MAX)
+			out[count++].point = data.update[i].endpoints[dimension].upper + SPACE_TYPE_INC;
+		else
+#endif // __SUPERSET
+			out[count++].point = data.update[i].endpoints[dimension].upper;
+	}
+}
+
+
+/** \brief Updates the points of an endpoints list for a given dimension.
+
+The list can be in any order: the point of each element is read again from the data set, using the identifier and the type of the endpoint.
+
+\param data the data set.
+\param list the list to be updated
+\param size the size of the list
+\param dimension the number of the dimension to be processed
+*/
+void refresh_endpoints_list(const match_data_t data, const list_ptr list, const _UINT size, const _UINT dimension)
+{
+	_UINT i;
+	endpoints_t ep;
+
+	for (i = 0; i < size; i++)
+	{
+		if (list[i].id < data.size_subscr)
+			ep = data.subscr[list[i].id].endpoints[dimension];
+		else
+			ep = data.update[list[i].id - data.size_subscr].endpoints[dimension];
+
+		if (list[i].is_lower_point)
+		{
+#ifdef __SUPERSET
+			if (ep.lower > SPACE_TYPE_MIN)
+				list[i].point = ep.lower - SPACE_TYPE_INC;
+			else
+#endif // __SUPERSET
+				list[i].point = ep.lower;
+		}
+		else
+		{
+#ifdef __SUPERSET
+			if (ep.upper < SPACE_TYPE_MAX)
+				list[i].point = ep.upper + SPACE_TYPE_INC;
+			else
+#endif // __SUPERSET
+				list[i].point = ep.upper;
+		}
+	}
+}
+
+
+/** \brief Rule for qsort() ordering.
+
+\remarks If two extents with zero-width have the same coordinates, they should overlap.
+
+\param a pointer to the first element to compare
+\param b pointer to the second element to compare
+
+\retval -1 if a < b or a == b and a is lower point
+\retval 1 if a > b or a == b and a is upper point
+*/
+_INT compare_endpoints(const void *a, const void *b)
+{
+	SPACE_TYPE x = (*(list_ptr)a).point;
+	SPACE_TYPE y = (*(list_ptr)b).point;
+
+#ifdef __SUPERSET
+	return (x < y) ? -1 : (x > y) ? 1 : 0;
+#else // __SUPERSET
+	return (x < y) ? -1 : (x > y) ? 1 : ((*(list_ptr)a).is_lower_point) ? -1 : 1;
+#endif // __SUPERSET
+}
+
+
+/** \brief Order-preserving key of an endpoint.
+
+Maps the point of the endpoint to an unsigned integer with the same ordering, so that comparing two keys is the same as applying compare_endpoints() to their endpoints.
+
+\remarks -0.0 and +0.0 are given the same key, since they compare equal.
+
+\param ep pointer to the endpoint
+
+\retval the key of the endpoint
+*/
+static INLINE uint64_t endpoint_key(const list_t *ep)
+{
+	uint64_t key;
+#if SPACE_TYPE_SELECT == 1
+	key = (uint32_t)ep->point ^ 0x80000000U;
+#elif SPACE_TYPE_SELECT == 2
+	key = (uint64_t)ep->point ^ 0x8000000000000000ULL;
+#elif SPACE_TYPE_SELECT == 3
+	uint32_t bits = 0;
+
+	if (ep->point != 0)
+		memcpy(&bits, &ep->point, sizeof(bits));
+	// negative values have all the bits flipped, positive values only the sign bit
+	key = (bits & 0x80000000U) ? (uint32_t)~bits : (bits | 0x80000000U);
+#elif SPACE_TYPE_SELECT == 4
+	uint64_t bits = 0;
+
+	if (ep->point != 0)
+		memcpy(&bits, &ep->point, sizeof(bits));
+	// negative values have all the bits flipped, positive values only the sign bit
+	key = (bits & 0x8000000000000000ULL) ? ~bits : (bits | 0x8000000000000000ULL);
+#endif // SPACE_TYPE_SELECT
+
+#ifdef RADIX_TIE_IN_KEY
+	// lower points go before upper points with the same coordinates
+	key = (key << 1) | (ep->is_lower_point ? 0 : 1);
+#endif // RADIX_TIE_IN_KEY
+
+	return key;
+}
+
+
+/** \brief LSD radix sort of the endpoints list.
+
+The list is sorted RADIX_DIGIT_BITS bits of endpoint_key() at a time, moving the elements between the list and a scratch list. The histograms of all the passes are computed in a single scan and the passes where all the elements have the same digit are skipped.
+
+\param ep_list the endpoints list to be ordered
+\param size the size of the list
+\param scratch the scratch list, as long as the list (NULL to allocate it)
+
+\retval TRUE if the list has been sorted
+\retval FALSE if the scratch list couldn't be allocated
+*/
+static _BOOL radix_sort_list(const list_ptr ep_list, const _UINT size, const list_ptr scratch)
+{
+	_UINT i, pass;
+	_UINT hist[RADIX_PASSES][RADIX_BUCKETS];
+	_UINT sum, count;
+	uint64_t key;
+	list_ptr src, dst, tmp;
+#ifdef RADIX_TIE_PASS
+	_UINT lower_count, lower_pos, upper_pos;
+#endif // RADIX_TIE_PASS
+
+	if (size < 2)
+		return TRUE;
+
+	dst = (scratch != NULL) ? scratch : (list_ptr)malloc(size * sizeof(list_t));
+	if (dst == NULL)
+		return FALSE;
+	src = ep_list;
+
+	// compute the histograms of all the passes
+	memset(hist, 0, sizeof(hist));
+#ifdef RADIX_TIE_PASS
+	lower_count = 0;
+#endif // RADIX_TIE_PASS
+	for (i = 0; i < size; i++)
+	{
+		key = endpoint_key(&src[i]);
+		for (pass = 0; pass < RADIX_PASSES; pass++)
+			hist[pass][(key >> (pass * RADIX_DIGIT_BITS)) & (RADIX_BUCKETS - 1)]++;
+#ifdef RADIX_TIE_PASS
+		if (src[i].is_lower_point)
+			lower_count++;
+#endif // RADIX_TIE_PASS
+	}
+
+#ifdef RADIX_TIE_PASS
+	// least significant digit: stable partition of lower points before upper points
+	if (lower_count > 0 && lower_count < size)
+	{
+		lower_pos = 0;
+		upper_pos = lower_count;
+		for (i = 0; i < size; i++)
+		{
+			if (src[i].is_lower_point)
+				dst[lower_pos++] = src[i];
+			else
+				dst[upper_pos++] = src[i];
+		}
+
+		tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+#endif // RADIX_TIE_PASS
+
+	for (pass = 0; pass < RADIX_PASSES; pass++)
+	{
+		// skip the pass if every element falls in the same bucket
+		key = endpoint_key(&src[0]);
+		if (hist[pass][(key >> (pass * RADIX_DIGIT_BITS)) & (RADIX_BUCKETS - 1)] == size)
+			continue;
+
+		// exclusive prefix sum: first position of each bucket
+		sum = 0;
+		for (i = 0; i < RADIX_BUCKETS; i++)
+		{
+			count = hist[pass][i];
+			hist[pass][i] = sum;
+			sum += count;
+		}
+
+		// stable scatter of the elements in their buckets
+		for (i = 0; i < size; i++)
+		{
+			key = endpoint_key(&src[i]);
+			dst[hist[pass][(key >> (pass * RADIX_DIGIT_BITS)) & (RADIX_BUCKETS - 1)]++] = src[i];
+		}
+
+		tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	// if the sorted data is in the scratch list copy it back
+	if (src != ep_list)
+		memcpy(ep_list, src, size * sizeof(list_t));
+
+	if (scratch == NULL)
+		free((src != ep_list) ? src : dst);
+
+	return TRUE;
+}
+
+
+/** \brief Sorting function on a preallocated scratch list.
+
+The list is sorted like sort_list(), but the radix sort uses the given scratch list instead of allocating one, so the sort doesn't allocate memory.
+
+\param ep_list the endpoints list to be ordered
+\param size the size of the list
+\param scratch the scratch list of the radix sort, as long as the list (NULL to allocate it)
+*/
+void sort_list_scratch(const list_ptr ep_list, const _UINT size, const list_ptr scratch)
+{
+	if (OPT_VAR.sort_algo == sort_radix && radix_sort_list(ep_list, size, scratch))
+		return;
+
+	qsort(ep_list, size, sizeof(list_t), compare_endpoints);
+}
+
+
+/** \brief Sorting function.
+
+The list is sorted with the algorithm selected in the global options: the radix sort or a call to stdlib.h's qsort() function with compare_endpoints() as ordering rule.
+
+\remarks If the radix sort can't allocate its scratch memory the list is sorted with qsort().
+
+\param ep_list the endpoints list to be ordered
+\param size the size of the list
+*/
+void sort_list(const list_ptr ep_list, const _UINT size)
+{
+	sort_list_scratch(ep_list, size, NULL);
+}
+
+
+/** \brief Frees the memory of a list of matching pairs.
+
+\param csr the list of matching pairs
+*/
+void free_match_csr(match_csr_t *csr)
+{
+	free(csr->first);
+	free(csr->subscr);
+
+	memset(csr, 0, sizeof(match_csr_t));
+}
+
+
+/** \brief Sets an iterator on the matching subscription extents of an update extent.
+
+\param it the iterator
+\param m the result bit matrix
+\param size_subscr the number of subscription extents
+\param update the update extent
+*/
+void match_iter_init(match_iter_t *it, const bitmatrix m, const _UINT size_subscr, const _UINT update)
+{
+	it->line = BITMATRIX_ROW(m, update);
+	it->size_subscr = size_subscr;
+	it->last = BIT_TO_POS((size_subscr + BITVEC_ELEM_BITS - 1));
+	it->elem = 0;
+	it->val = it->line[0];
+}
+
+
+/** \brief Moves an iterator to the next matching subscription extent.
+
+The zero elements are skipped whole and the next set bit of an element is found with the count of leading zeros, so the cost is proportional to the matches and to the zero elements, not to the bits.
 
-\retval error code
+\param it the iterator
+\param subscr the next matching subscription extent
+
+\retval TRUE if there was another match, FALSE at the end of the row
 */
-_ERR_CODE create_bit_matrix(bitmatrix *out, const _UINT size_update, const _UINT size_subscr)
+_BOOL match_iter_next(match_iter_t *it, _UINT *subscr)
 {
-	_UINT i;
-	bitvector vec;
-	_UINT line_width;
+	_UINT bit;
 
-	// number of elements on each line of the bit matrix
-	line_width = BIT_VEC_WIDTH(size_subscr);
-
-	// allocate one big vector and a column vector
-#ifdef __LOWMEM
-	vec = (bitvector)calloc(line_width * size_update, sizeof(bitvec_elem));
-#else // __LOWMEM
-	vec = (bitvector)malloc(line_width * size_update * sizeof(bitvec_elem));
-#endif // __LOWMEM
-	*out = (bitmatrix)malloc(size_update * sizeof(bitvector));
-	if (vec == NULL || *out == NULL)
-		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+	while (it->val == 0)
+	{
+		if (++it->elem >= it->last)
+		{
+			it->elem = it->last;
+			return FALSE;
+		}
+		it->val = it->line[it->elem];
+	}
 
-	// set each element of the column vector to point to the first element of each line in the big vector
-	for (i = 0; i < size_update; i++)
-		(*out)[i] = &vec[i * line_width];
+	bit = elem_first_dbit(it->val);
+	*subscr = it->elem * BITVEC_ELEM_BITS + bit;
 
-	return err_none;
+	// the bits after the last subscription extent are padding
+	if (*subscr >= it->size_subscr)
+	{
+		it->val = 0;
+		it->elem = it->last;
+		return FALSE;
+	}
+
+	it->val ^= DBIT(bit);
+
+	return TRUE;
 }
 
 
-/** \brief Bitwise NOT of a bit vector.
+/** \brief Counts or lists the matching subscription extents of a row of the result.
 
-It can also be used to do the bitwise NOT of the matrix, since it's allocated as linear memory.
+\param m the result bit matrix
+\param size_subscr the number of subscription extents
+\param summary the occupancy summary of the result, to skip the empty rows and the zero blocks (NULL if not used)
+\param row the row
+\param out the matching subscription extents, in ascending order (NULL to count them only)
 
-\param mat bit vector to be inverted
-\param size number of elements of the bit vector
+\retval the number of matching subscription extents
 */
-void vector_bitwise_not(const bitvector vec, const _UINT size)
+static _UINT bitmatrix_row_matches(const bitmatrix m, const _UINT size_subscr, const bitmatrix_summary_t *summary, const _UINT row, _UINT *out)
 {
-	_UINT i;
+	_UINT i, bit, count;
+	_UINT first, last, full;
+	bitvec_elem val;
+	bitvector line;
 
-	for (i = 0; i < size; i++)
-		vec[i] = ~vec[i];
+	if (summary != NULL && BITVEC_TEST(summary->empty, row))
+		return 0;
+
+	line = BITMATRIX_ROW(m, row);
+	count = 0;
+
+	// the elements holding only columns, a block of the summary at a time
+	full = size_subscr / BITVEC_ELEM_BITS;
+	for (first = 0; first < full; first = last)
+	{
+		last = MIN(first + BITMATRIX_SUMMARY_ELEMS, full);
+		if (summary != NULL && BITVEC_TEST(summary->zero, (size_t)row * summary->blocks + first / BITMATRIX_SUMMARY_ELEMS))
+			continue;
+
+		if (out == NULL)
+		{
+			for (i = first; i < last; i++)
+				count += elem_popcount(line[i]);
+		}
+		else
+			count += kernels.bit_positions(line, first, last, &out[count]);
+	}
+
+	// the last element holding columns is followed by padding bits
+	if (size_subscr % BITVEC_ELEM_BITS != 0)
+	{
+		val = line[full] & ~((BITVEC_ELEM_MAX_BIT >> (size_subscr % BITVEC_ELEM_BITS - 1)) - 1);
+
+		if (out == NULL)
+			count += elem_popcount(val);
+		else
+		{
+			for (; val != 0; val ^= DBIT(bit))
+			{
+				bit = elem_first_dbit(val);
+				out[count++] = full * BITVEC_ELEM_BITS + bit;
+			}
+		}
+	}
+
+	return count;
 }
 
 
-/** \brief Bitwise AND of two bit vectors.
+/** \brief Exports the result bit matrix as compressed sparse rows.
 
-It can also be used to do the bitwise AND of the matrix, since it's allocated as linear memory.
+The rows are read twice: the first pass counts the matches of each row (with the population count) to size the list, the second one writes the positions of the set bits, so the list is allocated once and each row is already sorted.
 
-\param result first vector and also resulting vector
-\param mask second vector
-\param size number of elements in the bit vectors
+\param m the result bit matrix
+\param size_subscr the number of subscription extents
+\param summary the occupancy summary of the result, to skip the empty rows and the zero blocks (NULL if not used)
+\param out the list of matching pairs (allocated by the function, to be freed with free_match_csr())
+
+\retval error code
 */
-void vector_bitwise_and(const bitvector result, const bitvector mask, const _UINT size)
+_ERR_CODE bitmatrix_to_csr(const bitmatrix m, const _UINT size_subscr, const bitmatrix_summary_t *summary, match_csr_t *out)
 {
-	_UINT i;
+	_UINT row;
 
-	for (i = 0; i < size; i++)
-		result[i] &= mask[i];
+	out->size_update = m.rows;
+	out->first = (size_t *)malloc(((size_t)m.rows + 1) * sizeof(size_t));
+	if (out->first == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	// first pass: the position of the first match of each row
+	out->first[0] = 0;
+	for (row = 0; row < m.rows; row++)
+		out->first[row + 1] = out->first[row] + bitmatrix_row_matches(m, size_subscr, summary, row, NULL);
+
+	out->count = out->first[m.rows];
+	out->subscr = (_UINT *)malloc(MAX(out->count, 1) * sizeof(_UINT));
+	if (out->subscr == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	// second pass: the matches of each row
+	for (row = 0; row < m.rows; row++)
+		bitmatrix_row_matches(m, size_subscr, summary, row, &out->subscr[out->first[row]]);
+
+	return err_none;
 }
 
 
-/** \brief Bitwise OR of two bit vectors.
+/** \brief Makes room for more items in a growing buffer, doubling its capacity when needed.
 
-It can also be used to do the bitwise OR of the matrix, since it's allocated as linear memory.
+\param buffer pointer to the buffer
+\param capacity pointer to the number of allocated items
+\param needed the number of items needed
+\param item_size the size of an item in bytes
 
-\param result first vector and also resulting vector
-\param mask second vector
-\param size number of elements in the bit vectors
+\retval error code
 */
-void vector_bitwise_or(const bitvector result, const bitvector mask, const _UINT size)
+static _ERR_CODE sparse_reserve(void **buffer, size_t *capacity, const size_t needed, const size_t item_size)
 {
-	_UINT i;
+	size_t new_capacity;
+	void *tmp;
 
-	for (i = 0; i < size; i++)
-		result[i] |= mask[i];
+	if (needed <= *capacity)
+		return err_none;
+
+	for (new_capacity = MAX(*capacity, 1024); new_capacity < needed; new_capacity *= 2);
+
+	tmp = realloc(*buffer, new_capacity * item_size);
+	if (tmp == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	*buffer = tmp;
+	*capacity = new_capacity;
+
+	return err_none;
 }
 
 
-/** \brief Fills the endpoints list with the values for a given dimension.
+/** \brief Appends the line of an update extent to the compressed result.
 
-\param data the data set.
-\param out the pointer to the list to be filled
-\param dimension the number of the dimension to be processed
+The line is split in chunks of SPARSE_CHUNK_BITS subscription extents. For each chunk with matches the number of matches and of runs of consecutive matches is counted, then the chunk is stored in the smallest container: runs if they take less words than the values, an array of values up to SPARSE_ARRAY_MAX of them, otherwise the elements of the line.
+
+\remarks The lines must be appended in order of update extent.
+
+\param sparse the compressed result (size_update, size_subscr and first must be set)
+\param update the update extent
+\param line the matching subscription extents of the update extent (the bits after size_subscr are ignored)
+
+\retval error code
 */
-void set_endpoints_list(const match_data_t data, const list_ptr out, const _UINT dimension)
+_ERR_CODE match_sparse_append_row(match_sparse_t *sparse, const _UINT update, const bitvector line)
 {
-	_UINT i, count;
+	_UINT i, j;
+	_UINT line_width;
+	_UINT chunk_elems;
+	_UINT elems;
+	_UINT cardinality;
+	_UINT runs;
+	_UINT value, last;
+	_UINT bit;
+	bitvec_elem val, carry;
+	match_container_t *container;
+	uint16_t *words;
+	_ERR_CODE err;
 
-	count = 0;
+	// number of elements on each line of the bit matrix, and in a chunk
+	line_width = BIT_VEC_WIDTH(sparse->size_subscr);
+	chunk_elems = SPARSE_CHUNK_BITS / BITVEC_ELEM_BITS;
 
-	// for each subscription extent
-	for (i = 0; i < data.size_subscr; i++)
+	// clear the bits after the last subscription extent
+	if (sparse->size_subscr % BITVEC_ELEM_BITS != 0)
+		line[BIT_TO_POS(sparse->size_subscr)] &= ~((BITVEC_ELEM_MAX_BIT >> (sparse->size_subscr % BITVEC_ELEM_BITS - 1)) - 1);
+	for (i = BIT_TO_POS(sparse->size_subscr - 1) + 1; i < line_width; i++)
+		line[i] = 0;
+
+	// for each chunk of the line
+	for (i = 0; i < line_width; i += chunk_elems)
 	{
-		out[count].id = i;
-		out[count].is_lower_point = TRUE;
+		elems = MIN(chunk_elems, line_width - i);
 
-#ifdef __SUPERSET
-		if (data.subscr[i].endpoints[dimension].lower > SPACE_TYPE_MIN)
-			out[count++].point = data.subscr[i].endpoints[dimension].lower - SPACE_TYPE_INC;
-		else
-#endif // __SUPERSET
-			out[count++].point = data.subscr[i].endpoints[dimension].lower;
+		// count the matches and the runs (a run starts on a bit set whose previous bit is clear)
+		cardinality = 0;
+		runs = 0;
+		carry = 0;
+		for (j = 0; j < elems; j++)
+		{
+			val = line[i + j];
+			cardinality += elem_popcount(val);
+			runs += elem_popcount(val & ~((val >> 1) | carry));
+			carry = (val & 1) ? BITVEC_ELEM_MAX_BIT : 0;
+		}
 
-		out[count].id = i;
-		out[count].is_lower_point = FALSE;
+		if (cardinality == 0)
+			continue;
 
-#ifdef __SUPERSET
-		if (data.subscr[i].endpoints[dimension].upper < SPACE_TYPE_MAX)
-			out[count++].point = data.subscr[i].endpoints[dimension].upper + SPACE_TYPE_INC;
-		else
-#endif // __SUPERSET
-			out[count++].point = data.subscr[i].endpoints[dimension].upper;
-	}
+		err = sparse_reserve((void **)&sparse->containers, &sparse->containers_capacity, sparse->containers_count + 1, sizeof(match_container_t));
+		if (err != err_none)
+			return err;
 
-	// for each update extent
-	for (i = 0; i < data.size_update; i++)
-	{
-		// IDs of update extents in the "list" follow the IDs of subscription extents
-		// this way is possible to distinguish subscription and update extents without having to store another variable
-		out[count].id = i + data.size_subscr;
-		out[count].is_lower_point = TRUE;
+		container = &sparse->containers[sparse->containers_count++];
+		container->chunk = i / chunk_elems;
+		container->cardinality = cardinality;
+		sparse->count += cardinality;
 
-#ifdef __SUPERSET
-		if (data.update[i].endpoints[dimension].lower > SPACE_TYPE_MIN)
-			out[count++].point = data.update[i].endpoints[dimension].lower - SPACE_TYPE_INC;
-		else
-#endif // __SUPERSET
-			out[count++].point = data.update[i].endpoints[dimension].lower;
+		// a bitmap if neither the runs nor the values are smaller
+		if (2 * runs >= SPARSE_ARRAY_MAX && cardinality > SPARSE_ARRAY_MAX)
+		{
+			err = sparse_reserve((void **)&sparse->bitmaps, &sparse->bitmaps_capacity, sparse->bitmaps_count + elems, sizeof(bitvec_elem));
+			if (err != err_none)
+				return err;
 
-		out[count].id = i + data.size_subscr;
-		out[count].is_lower_point = FALSE;
+			container->kind = container_bitmap;
+			container->size = elems;
+			container->offset = sparse->bitmaps_count;
+			memcpy(&sparse->bitmaps[sparse->bitmaps_count], &line[i], elems * sizeof(bitvec_elem));
+			sparse->bitmaps_count += elems;
+			continue;
+		}
 
-#ifdef __SUPERSET
-		if (data.update[i].endpoints[dimension].upper < SPACE_TYPE_MAX)
-			out[count++].point = data.update[i].endpoints[dimension].upper + SPACE_TYPE_INC;
-		else
-#endif // __SUPERSET
-			out[count++].point = data.update[i].endpoints[dimension].upper;
+		container->kind = (2 * runs < cardinality) ? container_run : container_array;
+		container->size = (container->kind == container_run) ? 2 * runs : cardinality;
+		container->offset = sparse->words_count;
+
+		err = sparse_reserve((void **)&sparse->words, &sparse->words_capacity, sparse->words_count + container->size, sizeof(uint16_t));
+		if (err != err_none)
+			return err;
+
+		words = &sparse->words[sparse->words_count];
+		sparse->words_count += container->size;
+
+		// write the values, or extend the last run while they are consecutive
+		last = 0;
+		for (j = 0; j < elems; j++)
+		{
+			for (val = line[i + j]; val != 0; val &= ~DBIT(bit))
+			{
+				bit = elem_first_dbit(val);
+				value = j * BITVEC_ELEM_BITS + bit;
+
+				if (container->kind == container_array)
+					*words++ = (uint16_t)value;
+				else if (words != &sparse->words[container->offset] && value == last + 1)
+					words[-1]++;
+				else
+				{
+					*words++ = (uint16_t)value;
+					*words++ = 0;
+				}
+
+				last = value;
+			}
+		}
 	}
-}
 
+	sparse->first[update + 1] = sparse->containers_count;
 
-/** \brief Rule for qsort() ordering.
+	return err_none;
+}
 
-\remarks If two extents with zero-width have the same coordinates, they should overlap.
 
-\param a pointer to the first element to compare
-\param b pointer to the second element to compare
+/** \brief Checks whether a pair of extents is in the compressed result.
 
-\retval -1 if a < b or a == b and a is lower point
-\retval 1 if a > b or a == b and a is upper point
+\param sparse the compressed result
+\param update the update extent
+\param subscr the subscription extent
+
+\retval TRUE if the extents match
 */
-_INT compare_endpoints(const void *a, const void *b)
+_BOOL match_sparse_contains(const match_sparse_t *sparse, const _UINT update, const _UINT subscr)
 {
-	SPACE_TYPE x = (*(list_ptr)a).point;
-	SPACE_TYPE y = (*(list_ptr)b).point;
+	size_t first, last, middle;
+	_UINT chunk, value;
+	const match_container_t *container;
+	const uint16_t *words;
 
-#ifdef __SUPERSET
-	return (x < y) ? -1 : (x > y) ? 1 : 0;
-#else // __SUPERSET
-	return (x < y) ? -1 : (x > y) ? 1 : ((*(list_ptr)a).is_lower_point) ? -1 : 1;
-#endif // __SUPERSET
-}
+	chunk = subscr / SPARSE_CHUNK_BITS;
+	value = subscr % SPARSE_CHUNK_BITS;
+
+	// binary search of the chunk among the containers of the update extent
+	first = sparse->first[update];
+	last = sparse->first[update + 1];
+	while (first < last)
+	{
+		middle = (first + last) / 2;
+		if (sparse->containers[middle].chunk < chunk)
+			first = middle + 1;
+		else
+			last = middle;
+	}
 
+	if (first == sparse->first[update + 1] || sparse->containers[first].chunk != chunk)
+		return FALSE;
 
-/** \brief Sorting function.
+	container = &sparse->containers[first];
 
-This function only performs a call to stdlib.h's qsort() function.
+	if (container->kind == container_bitmap)
+		return BIT_DCHECK(sparse->bitmaps[container->offset + BIT_TO_POS(value)], BIT_POS_IN_VEC(value, BIT_TO_POS(value))) ? TRUE : FALSE;
 
-\param ep_list the endpoints list to be ordered
-\param size the size of the list
+	words = &sparse->words[container->offset];
+
+	if (container->kind == container_array)
+	{
+		// binary search of the value
+		first = 0;
+		last = container->size;
+		while (first < last)
+		{
+			middle = (first + last) / 2;
+			if (words[middle] < value)
+				first = middle + 1;
+			else
+				last = middle;
+		}
+
+		return (first < container->size && words[first] == value);
+	}
+
+	// binary search of the last run starting before or on the value
+	first = 0;
+	last = container->size / 2;
+	while (first < last)
+	{
+		middle = (first + last) / 2;
+		if (words[2 * middle] <= value)
+			first = middle + 1;
+		else
+			last = middle;
+	}
+
+	return (first > 0 && value <= (_UINT)words[2 * (first - 1)] + words[2 * (first - 1) + 1]);
+}
+
+
+/** \brief Frees the memory of a compressed result.
+
+\param sparse the compressed result
 */
-INLINE void sort_list(const list_ptr ep_list, const _UINT size)
+void free_match_sparse(match_sparse_t *sparse)
 {
-	qsort(ep_list, size, sizeof(list_t), compare_endpoints);
+	free(sparse->first);
+	free(sparse->containers);
+	free(sparse->words);
+	free(sparse->bitmaps);
+
+	memset(sparse, 0, sizeof(match_sparse_t));
 }
 
 
@@ -223,32 +2366,29 @@ INLINE void sort_list(const list_ptr ep_list, const _UINT size)
 This function prints the bit matrix.
 
 \param in the bit matrix to be printed
-\param size_update the number of update extents (height of the matrix)
-\param size_subscr the number of subscription extents (\i minimum width in bits of the matrix)
 */
 #include <stdio.h>
-void print_bitmatrix(const bitmatrix in, const _UINT size_update, const _UINT size_subscr)
+void print_bitmatrix(const bitmatrix in)
 {
 	_UINT i, j, bit;
 	_BYTE element[BITVEC_ELEM_BITS + 1];
 	bitvec_elem val;
 	bitvec_elem mask;
-	_UINT line_width;
-
-	// number of elements on each line of the bit matrix
-	line_width = BIT_VEC_WIDTH(size_subscr);
+	bitvector row;
 
 	// escape the string
 	element[BITVEC_ELEM_BITS] = '\0';
 
 	// for each line (update extent)
-	for (i = 0; i < size_update; i++)
+	for (i = 0; i < in.rows; i++)
 	{
-		// for each element in the line
-		for (j = 0; j < line_width; j++)
+		row = BITMATRIX_ROW(in, i);
+
+		// for each element in the line (the padding of the row isn't printed)
+		for (j = 0; j < in.width; j++)
 		{
 			mask = BITVEC_ELEM_MAX_BIT;
-			val = in[i][j];
+			val = row[j];
 
 			// for each bit in the element
 			for (bit = 0; bit < BITVEC_ELEM_BITS; bit++)
@@ -267,4 +2407,136 @@ void print_bitmatrix(const bitmatrix in, const _UINT size_update, const _UINT si
 		printf("\n");
 	}
 }
+
+
+/** \brief Printing function for the matching pairs.
+
+This function prints, for each update extent, the list of matching subscription extents.
+
+\param in the list of matching pairs
+*/
+void print_match_csr(const match_csr_t *in)
+{
+	_UINT i;
+	size_t j;
+
+	// for each line (update extent)
+	for (i = 0; i < in->size_update; i++)
+	{
+		printf("%u:", i);
+
+		// for each matching subscription extent
+		for (j = in->first[i]; j < in->first[i + 1]; j++)
+			printf(" %u", in->subscr[j]);
+
+		// new line
+		printf("\n");
+	}
+}
+
+
+/** \brief Printing function for the compressed result.
+
+This function prints, for each update extent, the matching subscription extents like print_match_csr(), followed by its containers: the chunk, the kind and the number of matches.
+
+\param in the compressed result
+*/
+void print_match_sparse(const match_sparse_t *in)
+{
+	_UINT i, k, value;
+	_UINT base;
+	size_t j;
+	const match_container_t *container;
+	const uint16_t *words;
+	const char *kinds[] = { "array", "run", "bitmap" };
+
+	// for each line (update extent)
+	for (i = 0; i < in->size_update; i++)
+	{
+		printf("%u:", i);
+
+		// for each container of the line, the matching subscription extents
+		for (j = in->first[i]; j < in->first[i + 1]; j++)
+		{
+			container = &in->containers[j];
+			base = container->chunk * SPARSE_CHUNK_BITS;
+
+			if (container->kind != container_bitmap)
+				words = &in->words[container->offset];
+
+			if (container->kind == container_array)
+			{
+				for (k = 0; k < container->size; k++)
+					printf(" %u", base + words[k]);
+			}
+			else if (container->kind == container_run)
+			{
+				for (k = 0; k < container->size; k += 2)
+				{
+					for (value = words[k]; value <= (_UINT)words[k] + words[k + 1]; value++)
+						printf(" %u", base + value);
+				}
+			}
+			else
+			{
+				for (value = 0; value < container->size * BITVEC_ELEM_BITS && base + value < in->size_subscr; value++)
+				{
+					if (BIT_DCHECK(in->bitmaps[container->offset + BIT_TO_POS(value)], BIT_POS_IN_VEC(value, BIT_TO_POS(value))))
+						printf(" %u", base + value);
+				}
+			}
+		}
+
+		// the containers of the line
+		if (in->first[i] < in->first[i + 1])
+			printf(" |");
+
+		for (j = in->first[i]; j < in->first[i + 1]; j++)
+			printf(" %u/%s/%u", in->containers[j].chunk, kinds[in->containers[j].kind], in->containers[j].cardinality);
+
+		// new line
+		printf("\n");
+	}
+}
+
+
+/** \brief Printing function for the packed triangular bit matrix.
+
+This function prints the full rows of the matrix, the lower triangle mirrored from the upper one.
+
+\param in the packed triangular bit matrix to be printed
+*/
+void print_bitmatrix_tri(const bitmatrix_tri_t in)
+{
+	_UINT i, j, bit;
+	_BYTE element[BITVEC_ELEM_BITS + 1];
+	bitvector line;
+
+	line = (bitvector)malloc(in.width * sizeof(bitvec_elem));
+	if (line == NULL)
+		return;
+
+	// escape the string
+	element[BITVEC_ELEM_BITS] = '\0';
+
+	// for each line (extent)
+	for (i = 0; i < in.rows; i++)
+	{
+		bitmatrix_tri_line(in, i, line);
+
+		// for each element in the line
+		for (j = 0; j < in.width; j++)
+		{
+			for (bit = 0; bit < BITVEC_ELEM_BITS; bit++)
+				element[bit] = (line[j] & DBIT(bit)) ? '1' : '0';
+
+			printf("%s", element);
+		}
+
+		// new line
+		printf("\n");
+	}
+
+	free(line);
+}
 #endif // __VERBOSE
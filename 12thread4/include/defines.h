@@ -88,6 +88,27 @@ Microsoft Visual Studio doesn't support inline for C functions.
 #endif // _MSC_VER
 
 
+/** \brief Macros for SIMD compatibility.
+
+SIMD_X86 is defined if the SSE2 intrinsics can be used, SIMD_AVX2 and SIMD_AVX512 if the compiler supports the AVX2 and AVX-512 intrinsics. TARGET(_isa) enables an instruction set for a single function (GCC only), so that the program can be compiled without architecture flags and the functions are selected at run time.
+*/
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86
+#define SIMD_AVX2
+#define SIMD_AVX512
+#define TARGET(_isa)				__attribute__((target(_isa)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define SIMD_X86
+#if _MSC_VER >= 1800
+#define SIMD_AVX2
+#endif // _MSC_VER
+#if _MSC_VER >= 1910
+#define SIMD_AVX512
+#endif // _MSC_VER
+#define TARGET(_isa)
+#endif // SIMD
+
+
 /** Boolean true value.
 */
 #define TRUE						1
@@ -105,14 +126,126 @@ Microsoft Visual Studio doesn't support inline for C functions.
 #define MAX_DIMENSIONS				4
 
 
-/** \brief The number of bits in an element of the bit vector.
+/** \brief Maximum number of extents (update and subscription extents together) allowed.
+
+\remarks The endpoints list has two endpoints for each extent and identifies them with a _UINT (see list_t), so the size of the list must fit in a _UINT. The sizes of the bit matrices, which grow with the product of the extents, are computed in size_t.
+*/
+#define MAX_EXTENTS					2147483647
+
+
+/** \brief The number of bits in an element of the bit vector (32 or 64).
+
+The bit positions are computed on elements of this size, so wider elements mean fewer iterations on each line of the bit matrix.
+*/
+#ifndef BITVEC_ELEM_BITS
+#define BITVEC_ELEM_BITS			64
+#endif // BITVEC_ELEM_BITS
+
+
+/** \brief The number of bits in a lane of the bit vector (BITVEC_ELEM_BITS, 128 or 256).
+
+Each line of the bit matrix is padded to a whole number of lanes, so that the SIMD kernels work on full registers without a scalar tail.
 */
-#define BITVEC_ELEM_BITS			32
+#ifndef BITVEC_LANE_BITS
+#define BITVEC_LANE_BITS			BITVEC_ELEM_BITS
+#endif // BITVEC_LANE_BITS
 
 
 /** \brief The value of the most significant bit in an element of the bit vector.
 */
+#if BITVEC_ELEM_BITS == 64
+#define BITVEC_ELEM_MAX_BIT			0x8000000000000000ULL
+#elif BITVEC_ELEM_BITS == 32
 #define BITVEC_ELEM_MAX_BIT			0x80000000
+#else
+#error BITVEC_ELEM_BITS must be 32 or 64
+#endif // BITVEC_ELEM_BITS
+
+#if BITVEC_LANE_BITS != BITVEC_ELEM_BITS && BITVEC_LANE_BITS != 128 && BITVEC_LANE_BITS != 256
+#error BITVEC_LANE_BITS must be BITVEC_ELEM_BITS, 128 or 256
+#endif // BITVEC_LANE_BITS
+
+
+/** \brief The number of bits of the key sorted in each pass of the radix sort.
+*/
+#define RADIX_DIGIT_BITS			8
+
+
+/** \brief The number of buckets of each pass of the radix sort.
+*/
+#define RADIX_BUCKETS				( 1 << RADIX_DIGIT_BITS )
+
+
+/** \brief Size in bytes of a memory page (the step of the prefaulting).
+*/
+#define MEMORY_PAGE_SIZE			4096
+
+
+/** \brief Size in bytes of a huge page.
+
+The big allocations are rounded up to a multiple of this size when huge pages are used.
+*/
+#define MEMORY_HUGE_PAGE_SIZE		( 2 * 1024 * 1024 )
+
+
+/** \brief Maximum number of NUMA nodes of the interleaving.
+*/
+#define MEMORY_MAX_NODES			1024
+
+
+/** \brief Alignment in bytes of the rows of the bit matrices (a cache line, so that the chunks of columns of the threads don't share lines).
+*/
+#define BITMATRIX_ALIGNMENT			CACHE_LINE_SIZE
+
+
+/** \brief Row size in bytes that the stride of the bit matrices must avoid (0 to disable the padding).
+
+When the stride is a multiple of this size the same column of consecutive rows maps to the same cache sets, so the rows are padded with BITMATRIX_ALIGNMENT more bytes.
+*/
+#define BITMATRIX_ALIAS_STRIDE		4096
+
+
+/** \brief Number of blocks on each side of a tile of the transpose of the bit matrices.
+
+A tile reads and writes BITMATRIX_TRANSPOSE_TILE consecutive elements of each of its rows, so that with 64 bit elements it uses whole cache lines on both sides.
+*/
+#define BITMATRIX_TRANSPOSE_TILE	8
+
+
+/** \brief Maximum number of threads started together.
+*/
+#define MAX_THREADS					64
+
+
+/** \brief Maximum number of threads working on the same endpoints list.
+*/
+#define MAX_LIST_THREADS			MAX_THREADS
+
+
+/** \brief Initial size of the task queue of a worker of the scheduler.
+*/
+#define SCHEDULER_QUEUE_SIZE		64
+
+
+/** \brief Number of column tiles for each worker in the task-based matching.
+
+More tiles than workers let the workers that finish early steal the tiles left, balancing the load.
+*/
+#define TASK_TILES_PER_WORKER		4
+
+
+/** \brief Size in bytes of a cache line.
+
+The threads of the column-partitioned sweep own ranges of columns aligned to the cache lines, so that they never write the same line.
+*/
+#define CACHE_LINE_SIZE				64
+
+
+/** \brief Minimum number of endpoints given to each thread working on the endpoints list.
+
+Smaller lists are filled and sorted by fewer threads, since the cost of creating the threads would be higher than the work.
+*/
+#define MIN_LIST_CHUNK				16384
 
 
 /** \brief The max file name size.
@@ -166,9 +299,19 @@ Windows uses '\' in the path, while Linux uses '/'.
 #define MAX(_a, _b)					( (_a > _b) ? _a : _b )
 
 
-/**	\brief Calculates the number of elements of a bit vector from the number of bits.
+/**	\brief Calculates the number of elements of a bit vector from the number of bits (rounded up to a whole number of lanes).
+*/
+#define BIT_VEC_WIDTH(_bits)		( ((BITVEC_LANE_BITS + (_bits) - 1) / BITVEC_LANE_BITS) * (BITVEC_LANE_BITS / BITVEC_ELEM_BITS) )
+
+
+/** \brief Returns the pointer to the first element of a row of a bit matrix.
 */
-#define BIT_VEC_WIDTH(_bits)		( (BITVEC_ELEM_BITS + _bits - 1) / BITVEC_ELEM_BITS )
+#define BITMATRIX_ROW(_m, _row)		( (_m).base + (size_t)(_row) * (_m).stride )
+
+
+/** \brief Returns the number of elements of a bit matrix, padding of the rows included.
+*/
+#define BITMATRIX_SIZE(_m)			( (size_t)(_m).rows * (_m).stride )
 
 
 /** \brief Returns the element number which contains the nth bit of the bit vector.
@@ -183,10 +326,10 @@ Windows uses '\' in the path, while Linux uses '/'.
 
 /** \brief Returns the value of the nth bit in ascending order (bit 0 == 1).
 */
-#define ABIT(_n)					( 0x00000001 << _n )
+#define ABIT(_n)					( (bitvec_elem)1 << (_n) )
 
 
-/** \brief Returns the value of the nth bit in descending order (bit 0 == 2^31).
+/** \brief Returns the value of the nth bit in descending order (bit 0 == 2^(BITVEC_ELEM_BITS - 1)).
 */
 #define DBIT(_n)					( BITVEC_ELEM_MAX_BIT >> _n )
 
@@ -208,7 +351,7 @@ Windows uses '\' in the path, while Linux uses '/'.
 
 /** \brief Checks whether the nth bit is set (ascending order).
 */
-#define BIT_ACHECK(_y, _n)			( _y & (0x00000001 >> _n) )
+#define BIT_ACHECK(_y, _n)			( _y & ABIT(_n) )
 
 
 /** \brief Checks whether the nth bit is set (descending order).
@@ -216,4 +359,35 @@ Windows uses '\' in the path, while Linux uses '/'.
 #define BIT_DCHECK(_y, _n)			( _y & (BITVEC_ELEM_MAX_BIT >> _n) )
 
 
+/** \brief Atomic version of BIT_SET(), for the elements written by more threads at the same time.
+*/
+#ifdef _MSC_VER
+#if BITVEC_ELEM_BITS == 64
+#define ATOMIC_BIT_SET(_y, _mask)	_InterlockedOr64((volatile __int64 *)&(_y), (__int64)(_mask))
+#else // BITVEC_ELEM_BITS
+#define ATOMIC_BIT_SET(_y, _mask)	_InterlockedOr((volatile long *)&(_y), (long)(_mask))
+#endif // BITVEC_ELEM_BITS
+#else // _MSC_VER
+#define ATOMIC_BIT_SET(_y, _mask)	__atomic_fetch_or(&(_y), (_mask), __ATOMIC_RELAXED)
+#endif // _MSC_VER
+
+
+/** \brief Atomic decrement of a counter shared by more threads, returns the new value.
+*/
+#ifdef _MSC_VER
+#define ATOMIC_DEC(_y)				( (_UINT)InterlockedDecrement((volatile long *)&(_y)) )
+#else // _MSC_VER
+#define ATOMIC_DEC(_y)				__atomic_sub_fetch(&(_y), 1, __ATOMIC_ACQ_REL)
+#endif // _MSC_VER
+
+
+/** \brief Reads an element of the bit vector that can be written by other threads at the same time.
+*/
+#ifdef _MSC_VER
+#define ATOMIC_READ(_y)				( *(volatile bitvec_elem *)&(_y) )
+#else // _MSC_VER
+#define ATOMIC_READ(_y)				__atomic_load_n(&(_y), __ATOMIC_RELAXED)
+#endif // _MSC_VER
+
+
 #endif // __DEFINES_H
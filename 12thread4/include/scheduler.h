@@ -0,0 +1,49 @@
+/*
+ * SortMatching
+ * Copyright 2012 Marco Mandrioli
+ *
+ * This file is part of SortMatching.
+ *
+ * SortMatching is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SortMatching is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with SortMatching.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __SCHEDULER_H
+#define __SCHEDULER_H
+
+
+/** \file scheduler.h
+\brief Header of the file scheduler.c
+
+The file scheduler.c contains the work-stealing scheduler of the tasks.
+*/
+
+
+/** \brief Worker index of the threads that aren't workers of the scheduler.
+*/
+#define SCHEDULER_EXTERNAL			((_UINT)-1)
+
+
+_ERR_CODE scheduler_init(scheduler_t *sched, const _UINT workers);
+_ERR_CODE scheduler_submit(scheduler_t *sched, task_group_t *group, const task_routine_t routine, void *arg);
+_ERR_CODE scheduler_wait(scheduler_t *sched, task_group_t *group);
+void scheduler_free(scheduler_t *sched);
+void task_group_init(task_group_t *group);
+scheduler_t *thread_pool();
+void thread_pool_free();
+_ERR_CODE run_tasks(const task_routine_t routine, void *params, const size_t param_size, const _UINT count);
+
+
+#endif // __SCHEDULER_H
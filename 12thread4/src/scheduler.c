@@ -0,0 +1,561 @@
+/*
+ * SortMatching
+ * Copyright 2012 Marco Mandrioli
+ *
+ * This file is part of SortMatching.
+ *
+ * SortMatching is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SortMatching is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with SortMatching.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "../include/types.h"
+
+#include "../include/scheduler.h"
+#include "../include/error.h"
+#include "../include/utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/** \file scheduler.c
+\brief File containing the work-stealing scheduler of the tasks.
+
+The scheduler runs the tasks on a fixed group of worker threads. The tasks spawned by a worker go in its own queue, where they are taken in LIFO order while the data they use is still in the cache; a worker with an empty queue steals the oldest task of another worker, which usually is the biggest piece of work left.
+
+The workers of the thread pool are started once, before the matching, and all the parallel steps submit their tasks to it, so no thread is created or joined while matching.
+*/
+
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else // _MSC_VER
+#define THREAD_LOCAL __thread
+#endif // _MSC_VER
+
+
+/** \brief Index of the worker running on the current thread (SCHEDULER_EXTERNAL outside the workers).
+*/
+static THREAD_LOCAL _UINT current_worker = SCHEDULER_EXTERNAL;
+
+/** \brief Thread pool shared by all the parallel steps.
+*/
+static scheduler_t pool;
+
+/** \brief TRUE if the workers of the thread pool are running.
+*/
+static _BOOL pool_started = FALSE;
+
+
+/** \brief Initializes a lock.
+*/
+static void lock_init(LOCK_T *lock)
+{
+#ifdef _MSC_VER
+	InitializeCriticalSection(lock);
+#else // _MSC_VER
+	pthread_mutex_init(lock, NULL);
+#endif // _MSC_VER
+}
+
+
+/** \brief Destroys a lock.
+*/
+static void lock_destroy(LOCK_T *lock)
+{
+#ifdef _MSC_VER
+	DeleteCriticalSection(lock);
+#else // _MSC_VER
+	pthread_mutex_destroy(lock);
+#endif // _MSC_VER
+}
+
+
+/** \brief Acquires a lock.
+*/
+static void lock_acquire(LOCK_T *lock)
+{
+#ifdef _MSC_VER
+	EnterCriticalSection(lock);
+#else // _MSC_VER
+	pthread_mutex_lock(lock);
+#endif // _MSC_VER
+}
+
+
+/** \brief Releases a lock.
+*/
+static void lock_release(LOCK_T *lock)
+{
+#ifdef _MSC_VER
+	LeaveCriticalSection(lock);
+#else // _MSC_VER
+	pthread_mutex_unlock(lock);
+#endif // _MSC_VER
+}
+
+
+/** \brief Initializes a condition variable.
+*/
+static void cond_init(COND_T *cond)
+{
+#ifdef _MSC_VER
+	InitializeConditionVariable(cond);
+#else // _MSC_VER
+	pthread_cond_init(cond, NULL);
+#endif // _MSC_VER
+}
+
+
+/** \brief Destroys a condition variable.
+*/
+static void cond_destroy(COND_T *cond)
+{
+#ifndef _MSC_VER
+	pthread_cond_destroy(cond);
+#endif // _MSC_VER
+}
+
+
+/** \brief Releases the lock and waits for the condition variable to be signalled, then acquires the lock again.
+*/
+static void cond_wait(COND_T *cond, LOCK_T *lock)
+{
+#ifdef _MSC_VER
+	SleepConditionVariableCS(cond, lock, INFINITE);
+#else // _MSC_VER
+	pthread_cond_wait(cond, lock);
+#endif // _MSC_VER
+}
+
+
+/** \brief Wakes all the threads waiting for the condition variable.
+*/
+static void cond_broadcast(COND_T *cond)
+{
+#ifdef _MSC_VER
+	WakeAllConditionVariable(cond);
+#else // _MSC_VER
+	pthread_cond_broadcast(cond);
+#endif // _MSC_VER
+}
+
+
+/** \brief Pushes a task at the tail of a queue.
+
+\param deque the queue
+\param task the task
+
+\retval TRUE if the task has been queued
+\retval FALSE if the queue couldn't be enlarged
+*/
+static _BOOL deque_push(task_deque_t *deque, const task_t task)
+{
+	_UINT capacity;
+	task_t *tasks;
+
+	lock_acquire(&deque->lock);
+
+	if (deque->tail == deque->capacity)
+	{
+		if (deque->head > 0)
+		{
+			// move the tasks at the beginning of the array
+			memmove(deque->tasks, &deque->tasks[deque->head], (deque->tail - deque->head) * sizeof(task_t));
+			deque->tail -= deque->head;
+			deque->head = 0;
+		}
+		else
+		{
+			// enlarge the array
+			capacity = MAX(deque->capacity * 2, SCHEDULER_QUEUE_SIZE);
+			tasks = (task_t *)realloc(deque->tasks, capacity * sizeof(task_t));
+			if (tasks == NULL)
+			{
+				lock_release(&deque->lock);
+				return FALSE;
+			}
+			deque->tasks = tasks;
+			deque->capacity = capacity;
+		}
+	}
+
+	deque->tasks[deque->tail++] = task;
+
+	lock_release(&deque->lock);
+
+	return TRUE;
+}
+
+
+/** \brief Takes a task from a queue.
+
+\param deque the queue
+\param task the pointer to the task taken
+\param steal TRUE to take the oldest task (head), FALSE to take the newest one (tail)
+
+\retval TRUE if a task has been taken
+\retval FALSE if the queue is empty
+*/
+static _BOOL deque_take(task_deque_t *deque, task_t *task, const _BOOL steal)
+{
+	_BOOL taken = FALSE;
+
+	lock_acquire(&deque->lock);
+
+	if (deque->head < deque->tail)
+	{
+		*task = steal ? deque->tasks[deque->head++] : deque->tasks[--deque->tail];
+		taken = TRUE;
+
+		// reuse the array from the beginning when it's empty
+		if (deque->head == deque->tail)
+			deque->head = deque->tail = 0;
+	}
+
+	lock_release(&deque->lock);
+
+	return taken;
+}
+
+
+/** \brief Takes a task for a worker: from its own queue if possible, otherwise from the queue of another worker.
+
+\param sched the scheduler
+\param worker the index of the worker
+\param task the pointer to the task taken
+
+\retval TRUE if a task has been taken
+\retval FALSE if all the queues are empty
+*/
+static _BOOL take_task(scheduler_t *sched, const _UINT worker, task_t *task)
+{
+	_UINT i;
+	_BOOL taken;
+
+	taken = deque_take(&sched->deque[worker], task, FALSE);
+
+	for (i = 1; i < sched->workers && !taken; i++)
+		taken = deque_take(&sched->deque[(worker + i) % sched->workers], task, TRUE);
+
+	if (taken)
+	{
+		lock_acquire(&sched->lock);
+		sched->queued--;
+		lock_release(&sched->lock);
+	}
+
+	return taken;
+}
+
+
+/** \brief Records the end of a task.
+
+\param sched the scheduler
+\param group the group of the task
+\param err the error code returned by the task
+*/
+static void finish_task(scheduler_t *sched, task_group_t *group, const _ERR_CODE err)
+{
+	lock_acquire(&sched->lock);
+
+	if (err != err_none && group->err == err_none)
+		group->err = err;
+
+	// wake the threads waiting for the group
+	if (--group->pending == 0)
+		cond_broadcast(&sched->cond);
+
+	lock_release(&sched->lock);
+}
+
+
+/** \brief Start routine of the worker threads.
+
+\param pVoid a void pointer to the structure containing the parameters
+*/
+#ifdef _MSC_VER
+static unsigned int __stdcall worker_thread(void *pVoid)
+#else // _MSC_VER
+static void *worker_thread(void *pVoid)
+#endif // _MSC_VER
+{
+	task_t task;
+	_BOOL stop;
+	worker_params *params = (worker_params *)pVoid;
+	scheduler_t *sched = params->sched;
+
+	current_worker = params->index;
+
+	for (;;)
+	{
+		if (take_task(sched, params->index, &task))
+		{
+			finish_task(sched, task.group, task.routine(sched, params->index, task.arg));
+			continue;
+		}
+
+		// sleep until a task is queued
+		lock_acquire(&sched->lock);
+		while (sched->queued == 0 && !sched->stop)
+			cond_wait(&sched->cond, &sched->lock);
+		stop = (sched->queued == 0 && sched->stop);
+		lock_release(&sched->lock);
+
+		if (stop)
+			break;
+	}
+
+#ifdef _MSC_VER
+	return 0;
+#else // _MSC_VER
+	return NULL;
+#endif // _MSC_VER
+}
+
+
+/** \brief Starts the worker threads of a scheduler.
+
+\param sched the scheduler
+\param workers the number of worker threads (at most MAX_THREADS)
+
+\retval error code
+*/
+_ERR_CODE scheduler_init(scheduler_t *sched, const _UINT workers)
+{
+	_UINT i;
+
+	memset(sched, 0, sizeof(scheduler_t));
+	sched->workers = MIN(MAX(workers, 1), MAX_THREADS);
+
+	lock_init(&sched->lock);
+	cond_init(&sched->cond);
+	for (i = 0; i < MAX_THREADS; i++)
+		lock_init(&sched->deque[i].lock);
+
+	for (i = 0; i < sched->workers; i++)
+	{
+		sched->params[i].sched = sched;
+		sched->params[i].index = i;
+
+#ifdef _MSC_VER
+		// create and start the thread
+		sched->thread[i] = (HANDLE)_beginthreadex(NULL, 0U, worker_thread, &sched->params[i], 0, NULL);
+		if (sched->thread[i] == NULL)
+			break;
+#else // _MSC_VER
+		// create and start the thread
+		if (pthread_create(&sched->thread[i], NULL, worker_thread, &sched->params[i]) != 0)
+			break;
+#endif // _MSC_VER
+	}
+
+	if (i < sched->workers)
+	{
+		// stop the threads already started
+		sched->workers = i;
+		scheduler_free(sched);
+		return set_error(err_threads, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	return err_none;
+}
+
+
+/** \brief Submits a task.
+
+The task goes in the queue of the worker submitting it or, if it's submitted from outside the workers, in the queues of the workers in turn.
+
+\param sched the scheduler
+\param group the group of the task (initialized by task_group_init())
+\param routine the routine of the task
+\param arg the argument of the routine
+
+\retval error code
+*/
+_ERR_CODE scheduler_submit(scheduler_t *sched, task_group_t *group, const task_routine_t routine, void *arg)
+{
+	_UINT queue;
+	task_t task;
+
+	task.routine = routine;
+	task.arg = arg;
+	task.group = group;
+
+	// the task is pending before it can be taken, so that a wait can't end before it's done
+	lock_acquire(&sched->lock);
+	group->pending++;
+	queue = (current_worker < sched->workers) ? current_worker : (sched->next++ % sched->workers);
+	lock_release(&sched->lock);
+
+	if (!deque_push(&sched->deque[queue], task))
+	{
+		finish_task(sched, group, err_none);
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	// the condition variable is shared with the waits of the groups, so all the threads are woken
+	lock_acquire(&sched->lock);
+	sched->queued++;
+	cond_broadcast(&sched->cond);
+	lock_release(&sched->lock);
+
+	return err_none;
+}
+
+
+/** \brief Waits for all the tasks of a group, including the ones submitted to the group by its tasks, to finish.
+
+A worker waiting for a group runs the queued tasks meanwhile, so the tasks can wait for the groups they submit without blocking the workers.
+
+\param sched the scheduler
+\param group the group
+
+\retval the first error code returned by a task of the group
+*/
+_ERR_CODE scheduler_wait(scheduler_t *sched, task_group_t *group)
+{
+	task_t task;
+	_UINT worker = current_worker;
+	_ERR_CODE err;
+
+	lock_acquire(&sched->lock);
+	while (group->pending > 0)
+	{
+		if (worker < sched->workers && sched->queued > 0)
+		{
+			lock_release(&sched->lock);
+			if (take_task(sched, worker, &task))
+				finish_task(sched, task.group, task.routine(sched, worker, task.arg));
+			lock_acquire(&sched->lock);
+		}
+		else
+			cond_wait(&sched->cond, &sched->lock);
+	}
+	err = group->err;
+	lock_release(&sched->lock);
+
+	return err;
+}
+
+
+/** \brief Stops the worker threads of a scheduler and frees its memory.
+
+The tasks already spawned are run before the workers stop.
+
+\param sched the scheduler
+*/
+void scheduler_free(scheduler_t *sched)
+{
+	_UINT i;
+
+	lock_acquire(&sched->lock);
+	sched->stop = TRUE;
+	cond_broadcast(&sched->cond);
+	lock_release(&sched->lock);
+
+#ifdef _MSC_VER
+	if (sched->workers > 0)
+		WaitForMultipleObjects(sched->workers, sched->thread, TRUE, INFINITE);
+	for (i = 0; i < sched->workers; i++)
+		CloseHandle(sched->thread[i]);
+#else // _MSC_VER
+	for (i = 0; i < sched->workers; i++)
+		pthread_join(sched->thread[i], NULL);
+#endif // _MSC_VER
+
+	for (i = 0; i < MAX_THREADS; i++)
+	{
+		free(sched->deque[i].tasks);
+		lock_destroy(&sched->deque[i].lock);
+	}
+	cond_destroy(&sched->cond);
+	lock_destroy(&sched->lock);
+}
+
+
+/** \brief Initializes a group of tasks.
+
+\param group the group
+*/
+void task_group_init(task_group_t *group)
+{
+	group->pending = 0;
+	group->err = err_none;
+}
+
+
+/** \brief Returns the thread pool, starting its workers the first time.
+
+The pool has one worker for each thread of the run-time options.
+
+\retval the thread pool, or NULL if the workers couldn't be started
+*/
+scheduler_t *thread_pool()
+{
+	if (!pool_started)
+	{
+		if (scheduler_init(&pool, OPT_VAR.threads) != err_none)
+			return NULL;
+		pool_started = TRUE;
+	}
+
+	return &pool;
+}
+
+
+/** \brief Stops the workers of the thread pool.
+*/
+void thread_pool_free()
+{
+	if (pool_started)
+	{
+		scheduler_free(&pool);
+		pool_started = FALSE;
+	}
+}
+
+
+/** \brief Runs a routine on the thread pool as a group of tasks and waits for all of them to finish.
+
+\param routine the routine of the tasks
+\param params array of arguments, one for each task
+\param param_size the size of the arguments of a task
+\param count the number of tasks
+
+\retval error code
+*/
+_ERR_CODE run_tasks(const task_routine_t routine, void *params, const size_t param_size, const _UINT count)
+{
+	_UINT i;
+	task_group_t group;
+	scheduler_t *sched;
+	_ERR_CODE wait_err;
+	_ERR_CODE err = err_none;
+
+	sched = thread_pool();
+	if (sched == NULL)
+		return set_error(err_threads, __FILE__, __FUNCTION__, __LINE__);
+
+	task_group_init(&group);
+
+	for (i = 0; i < count && err == err_none; i++)
+		err = scheduler_submit(sched, &group, routine, (char *)params + i * param_size);
+
+	// the tasks already submitted must be waited for anyway, since they use the parameters
+	wait_err = scheduler_wait(sched, &group);
+
+	return (err != err_none) ? err : wait_err;
+}
@@ -22,6 +22,7 @@
 
 #include "../include/types.h"
 
+#include "../include/utils.h"
 #include "../include/error.h"
 
 #include <stdlib.h>
@@ -54,6 +55,9 @@ _ERR_CODE test_generator(match_data_t *out, const _UINT updates, const _UINT sub
 	if (dimensions > MAX_DIMENSIONS)
 		return set_error(err_too_many_dim, __FILE__, __FUNCTION__, __LINE__);
 
+	if ((uint64_t)updates + subscrs > MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
 	// set the number of dimensions
 	out->dimensions = dimensions;
 
@@ -125,8 +129,15 @@ _ERR_CODE test_generator_random(match_data_t *out, const _UINT updates, const _U
 	if (dimensions > MAX_DIMENSIONS)
 		return set_error(err_too_many_dim, __FILE__, __FUNCTION__, __LINE__);
 
+	if ((uint64_t)updates + subscrs > MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
+	// a seed given by the options generates the same data set at each run
+	if (OPT_VAR.seed > 0)
+		srand(OPT_VAR.seed);
 #ifdef __TRUERAND
-	srand((unsigned int)time(NULL));
+	else
+		srand((unsigned int)time(NULL));
 #endif // __TRUERAND
 
 	// set the number of dimensions
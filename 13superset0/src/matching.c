@@ -38,31 +38,26 @@
 
 This function performs the sort matching on a single dimension.
 
-\param ep_list the endpoints list
+\param ep_list the endpoints list, sorted with sort_list()
 \param out the matrix that is going to keep the result of the matching
+\param skip one bit for each update extent whose line isn't written (NULL to write all the lines)
 \param subscr_set_before the array to be used as the the set of "before" subscriptions
 \param subscr_set_after the array to be used as the the set of "after" subscriptions
 \param size_update the number of update extents
 \param size_subscr the number of subscription extents
 */
-void sort_matching_1D(const list_ptr ep_list, const bitmatrix out, const bitvector subscr_set_before, const bitvector subscr_set_after, const _UINT size_update, const _UINT size_subscr)
+void sort_matching_1D(const list_ptr ep_list, const bitmatrix out, const bitvector skip, const bitvector subscr_set_before, const bitvector subscr_set_after, const _UINT size_update, const _UINT size_subscr)
 {
 	_UINT i;
 	_UINT bit_pos;
 	_UINT line_width;
-	_UINT list_size;
 	_UINT update_ep_count;
 
-	// two endpoints for each extent
-	list_size = (size_update + size_subscr) * 2;
 	// number of elements on each line of the bit matrix
 	line_width = BIT_VEC_WIDTH(size_subscr);
 	// number of endpoints of update extents
 	update_ep_count = size_update * 2;
 
-	// sort the endpoints list
-	sort_list(ep_list, list_size);
-
 	// set no subscription extent to "before"
 	memset(subscr_set_before, 0x00, line_width * sizeof(bitvec_elem));
 	// set all the subscription extents to "after"
@@ -93,32 +88,462 @@ void sort_matching_1D(const list_ptr ep_list, const bitmatrix out, const bitvect
 		else // if it's the endpoint of an update extent
 		{
 			update_ep_count--;
+
+			// the line of an update extent without matches isn't written
+			if (skip != NULL && BITVEC_TEST(skip, ep_list[i].id - size_subscr))
+				continue;
+
 			// if it's the lower endpoint
 			if (ep_list[i].is_lower_point)
 			{
 #ifdef __LOWMEM
 				// bitwise OR (write all the subscription extents in the "before" set in the update extent's line in the bit matrix)
-				vector_bitwise_or(out[ep_list[i].id - size_subscr], subscr_set_before, line_width);
+				vector_bitwise_or(BITMATRIX_ROW(out, ep_list[i].id - size_subscr), subscr_set_before, line_width);
 #else // __LOWMEM
 				// the subscription extents in the "before" set don't match with this update extent
 				// (write the bits of the "before" set in the update extent's line in the bit matrix)
-				memcpy(out[ep_list[i].id - size_subscr], subscr_set_before, line_width * sizeof(bitvec_elem));
+				memcpy(BITMATRIX_ROW(out, ep_list[i].id - size_subscr), subscr_set_before, line_width * sizeof(bitvec_elem));
 #endif // __LOWMEM
 			}
 			else // if it's the upper endpoint
 			{
 				// bitwise OR (write all the subscription extents in the "after" set in the update extent's line in the bit matrix)
-				vector_bitwise_or(out[ep_list[i].id - size_subscr], subscr_set_after, line_width);
+				vector_bitwise_or(BITMATRIX_ROW(out, ep_list[i].id - size_subscr), subscr_set_after, line_width);
 			}
 		}
 	}
 }
 
 
-/** \brief Main algorithm function.
+/** \brief One-dimensional matching on tiles of columns.
+
+This function performs the sort matching on a single dimension like sort_matching_1D(), but the subscription columns are processed in tiles: for each tile the whole sorted list is replayed, applying only the events of the subscription extents of the tile and writing only the slice of the lines that belongs to the tile. In this way the slice of the two sets and of the lines being written stays in the cache, at the cost of scanning the list once for each tile.
+
+\param ep_list the endpoints list, sorted with sort_list()
+\param out the matrix that is going to keep the result of the matching
+\param skip one bit for each update extent whose line isn't written (NULL to write all the lines)
+\param subscr_set_before the array to be used as the the set of "before" subscriptions
+\param subscr_set_after the array to be used as the the set of "after" subscriptions
+\param size_update the number of update extents
+\param size_subscr the number of subscription extents
+\param tile_width the number of subscription extents (columns) in a tile, multiple of BITVEC_LANE_BITS
+*/
+void sort_matching_1D_tiled(const list_ptr ep_list, const bitmatrix out, const bitvector skip, const bitvector subscr_set_before, const bitvector subscr_set_after, const _UINT size_update, const _UINT size_subscr, const _UINT tile_width)
+{
+	_UINT i;
+	_UINT bit_pos;
+	_UINT line_width;
+	_UINT update_ep_count;
+	_UINT tile_first;
+	_UINT tile_size;
+	_UINT subscr_first;
+	_UINT subscr_last;
+
+	// number of elements on each line of the bit matrix
+	line_width = BIT_VEC_WIDTH(size_subscr);
+
+	// for each tile of columns
+	for (tile_first = 0; tile_first < line_width; tile_first += tile_size)
+	{
+		// number of elements of the tile (the last one can be narrower)
+		tile_size = MIN(BIT_VEC_WIDTH(tile_width), line_width - tile_first);
+		// subscription extents of the tile
+		subscr_first = tile_first * BITVEC_ELEM_BITS;
+		subscr_last = MIN((tile_first + tile_size) * BITVEC_ELEM_BITS, size_subscr);
+		// number of endpoints of update extents
+		update_ep_count = size_update * 2;
+
+		// set no subscription extent of the tile to "before"
+		memset(&subscr_set_before[tile_first], 0x00, tile_size * sizeof(bitvec_elem));
+		// set all the subscription extents of the tile to "after"
+		memset(&subscr_set_after[tile_first], 0xFF, tile_size * sizeof(bitvec_elem));
+
+		// for each endpoint in the list, but stops when all update extents endpoints are processed
+		for (i = 0; update_ep_count > 0; i++)
+		{
+			// if it's the endpoint of a subscription extent
+			if (ep_list[i].id < size_subscr)
+			{
+				// skip the subscription extents of the other tiles
+				if (ep_list[i].id < subscr_first || ep_list[i].id >= subscr_last)
+					continue;
+
+				// calculate the element in the bit vector that contains the bit
+				bit_pos = BIT_TO_POS(ep_list[i].id);
+
+				// if it's the lower endpoint remove the subscription extent from the "after" set, else add it to the "before" set
+				if (ep_list[i].is_lower_point)
+					BIT_CLEAR(subscr_set_after[bit_pos], DBIT(BIT_POS_IN_VEC(ep_list[i].id, bit_pos)));
+				else
+					BIT_SET(subscr_set_before[bit_pos], DBIT(BIT_POS_IN_VEC(ep_list[i].id, bit_pos)));
+			}
+			else // if it's the endpoint of an update extent
+			{
+				update_ep_count--;
+
+				// the line of an update extent without matches isn't written
+				if (skip != NULL && BITVEC_TEST(skip, ep_list[i].id - size_subscr))
+					continue;
+
+				// if it's the lower endpoint
+				if (ep_list[i].is_lower_point)
+				{
+#ifdef __LOWMEM
+					// write the "before" set in the tile of the update extent's line
+					vector_bitwise_or(&BITMATRIX_ROW(out, ep_list[i].id - size_subscr)[tile_first], &subscr_set_before[tile_first], tile_size);
+#else // __LOWMEM
+					// write the "before" set in the tile of the update extent's line
+					memcpy(&BITMATRIX_ROW(out, ep_list[i].id - size_subscr)[tile_first], &subscr_set_before[tile_first], tile_size * sizeof(bitvec_elem));
+#endif // __LOWMEM
+				}
+				else // if it's the upper endpoint
+				{
+					// write the "after" set in the tile of the update extent's line
+					vector_bitwise_or(&BITMATRIX_ROW(out, ep_list[i].id - size_subscr)[tile_first], &subscr_set_after[tile_first], tile_size);
+				}
+			}
+		}
+	}
+}
+
+
+/** \brief Builds the checkpointed result of the one-dimensional matching.
+
+The subscription endpoints of the sorted list are the events that change the "before" and "after" sets. The snapshot k contains the sets after the first k * interval events: each snapshot is built on a copy of the previous one by applying the following interval events, so each line of snapshots is written only once. Update endpoints only record the number of events that precede them.
+
+\param ep_list the sorted endpoints list
+\param rows the checkpointed result
+\param size_update the number of update extents
+\param size_subscr the number of subscription extents
+\param interval the number of events between two snapshots
+
+\retval error code
+*/
+_ERR_CODE lazy_rows_build(const list_ptr ep_list, lazy_rows_t *rows, const _UINT size_update, const _UINT size_subscr, const _UINT interval)
+{
+	_UINT i;
+	_UINT id;
+	_UINT bit_pos;
+	_UINT line_width;
+	_UINT list_size;
+	_UINT event;
+	_UINT snapshots;
+	bitvector before, after;
+
+	// two endpoints for each extent
+	list_size = (size_update + size_subscr) * 2;
+	// number of elements on each line of the bit matrix
+	line_width = BIT_VEC_WIDTH(size_subscr);
+	// one snapshot every interval events, plus the one being built after the last of them
+	snapshots = (size_subscr * 2) / interval + 2;
+
+	rows->size_update = size_update;
+	rows->size_subscr = size_subscr;
+	rows->interval = interval;
+	rows->event_subscr = (_UINT *)malloc(size_subscr * 2 * sizeof(_UINT));
+	rows->event_lower = (_BOOL *)malloc(size_subscr * 2 * sizeof(_BOOL));
+	rows->subscr_upper = (_UINT *)malloc(size_subscr * sizeof(_UINT));
+	rows->update_lower = (_UINT *)malloc(size_update * sizeof(_UINT));
+	rows->update_upper = (_UINT *)malloc(size_update * sizeof(_UINT));
+	rows->before = (bitvector)malloc((size_t)snapshots * line_width * sizeof(bitvec_elem));
+	rows->after = (bitvector)malloc((size_t)snapshots * line_width * sizeof(bitvec_elem));
+	if (rows->event_subscr == NULL || rows->event_lower == NULL || rows->subscr_upper == NULL || rows->update_lower == NULL
+		|| rows->update_upper == NULL || rows->before == NULL || rows->after == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	// first snapshot: no subscription extent "before", all the subscription extents "after"
+	memset(rows->before, 0x00, line_width * sizeof(bitvec_elem));
+	memset(rows->after, 0xFF, line_width * sizeof(bitvec_elem));
+
+	event = 0;
+	before = rows->before;
+	after = rows->after;
+
+	// for each endpoint in the list
+	for (i = 0; i < list_size; i++)
+	{
+		id = ep_list[i].id;
+
+		// if it's the endpoint of an update extent only record its position
+		if (id >= size_subscr)
+		{
+			if (ep_list[i].is_lower_point)
+				rows->update_lower[id - size_subscr] = event;
+			else
+				rows->update_upper[id - size_subscr] = event;
+			continue;
+		}
+
+		// the last snapshot is complete: continue on a copy of it
+		if (event % interval == 0)
+		{
+			memcpy(before + line_width, before, line_width * sizeof(bitvec_elem));
+			memcpy(after + line_width, after, line_width * sizeof(bitvec_elem));
+			before += line_width;
+			after += line_width;
+		}
+
+		rows->event_subscr[event] = id;
+		rows->event_lower[event] = ep_list[i].is_lower_point;
+
+		// calculate the element in the bit vector that contains the bit
+		bit_pos = BIT_TO_POS(id);
+
+		if (ep_list[i].is_lower_point)
+		{
+			// remove the subscription extent from the "after" set
+			BIT_CLEAR(after[bit_pos], DBIT(BIT_POS_IN_VEC(id, bit_pos)));
+		}
+		else
+		{
+			// add the subscription extent to the "before" set
+			BIT_SET(before[bit_pos], DBIT(BIT_POS_IN_VEC(id, bit_pos)));
+			rows->subscr_upper[id] = event;
+		}
+
+		event++;
+	}
+
+	return err_none;
+}
+
+
+/** \brief Builds the line of an update extent from the checkpointed result.
+
+The line is the "before" set at the lower endpoint of the update extent joined with the "after" set at its upper endpoint. It's computed in a single pass from the two nearest snapshots, then fixed by replaying the events between each snapshot and the endpoint: an upper endpoint adds its subscription extent to the "before" part, a lower endpoint removes its subscription extent from the "after" part (unless the extent is in the "before" part).
+
+\param rows the checkpointed result
+\param update the update extent
+\param line the line to be written (the non-matching subscription extents)
+*/
+void lazy_rows_materialize(const lazy_rows_t *rows, const _UINT update, const bitvector line)
+{
+	_UINT i;
+	_UINT id;
+	_UINT bit_pos;
+	_UINT line_width;
+	_UINT lower, upper;
+	bitvector before, after;
+
+	// number of elements on each line of the bit matrix
+	line_width = BIT_VEC_WIDTH(rows->size_subscr);
+
+	lower = rows->update_lower[update];
+	upper = rows->update_upper[update];
+
+	before = &rows->before[(size_t)(lower / rows->interval) * line_width];
+	after = &rows->after[(size_t)(upper / rows->interval) * line_width];
+
+	for (i = 0; i < line_width; i++)
+		line[i] = before[i] | after[i];
+
+	// subscription extents that end before the lower endpoint
+	for (i = lower - lower % rows->interval; i < lower; i++)
+	{
+		if (!rows->event_lower[i])
+		{
+			id = rows->event_subscr[i];
+			bit_pos = BIT_TO_POS(id);
+			BIT_SET(line[bit_pos], DBIT(BIT_POS_IN_VEC(id, bit_pos)));
+		}
+	}
+
+	// subscription extents that start before the upper endpoint
+	for (i = upper - upper % rows->interval; i < upper; i++)
+	{
+		id = rows->event_subscr[i];
+		if (rows->event_lower[i] && rows->subscr_upper[id] >= lower)
+		{
+			bit_pos = BIT_TO_POS(id);
+			BIT_CLEAR(line[bit_pos], DBIT(BIT_POS_IN_VEC(id, bit_pos)));
+		}
+	}
+}
+
+
+/** \brief Frees the memory of the checkpointed result.
+
+\param rows the checkpointed result
+*/
+void lazy_rows_free(lazy_rows_t *rows)
+{
+	free(rows->event_subscr);
+	free(rows->event_lower);
+	free(rows->subscr_upper);
+	free(rows->update_lower);
+	free(rows->update_upper);
+	free(rows->before);
+	free(rows->after);
+
+	memset(rows, 0, sizeof(lazy_rows_t));
+}
+
+
+/** \brief One-dimensional matching with checkpointed sets.
+
+This function performs the sort matching on a single dimension like sort_matching_1D(), but the lines of the matrix are built from the checkpointed result in row order, each one written only once, instead of in the order of the sweep.
+
+\param ep_list the endpoints list, sorted with sort_list()
+\param out the matrix that is going to keep the result of the matching
+\param skip one bit for each update extent whose line isn't written (NULL to write all the lines)
+\param size_update the number of update extents
+\param size_subscr the number of subscription extents
+\param interval the number of subscription endpoints between two snapshots
+
+\retval error code
+*/
+_ERR_CODE sort_matching_1D_lazy(const list_ptr ep_list, const bitmatrix out, const bitvector skip, const _UINT size_update, const _UINT size_subscr, const _UINT interval)
+{
+	_UINT i;
+	lazy_rows_t rows;
+	_ERR_CODE err;
+#ifdef __LOWMEM
+	bitvector line;
+#endif // __LOWMEM
+
+	err = lazy_rows_build(ep_list, &rows, size_update, size_subscr, interval);
+	if (err != err_none)
+		return err;
+
+#ifdef __LOWMEM
+	line = (bitvector)malloc(BIT_VEC_WIDTH(size_subscr) * sizeof(bitvec_elem));
+	if (line == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	// for each line, bitwise OR of the non-matching subscription extents
+	for (i = 0; i < size_update; i++)
+	{
+		if (skip != NULL && BITVEC_TEST(skip, i))
+			continue;
+
+		lazy_rows_materialize(&rows, i, line);
+		vector_bitwise_or(BITMATRIX_ROW(out, i), line, BIT_VEC_WIDTH(size_subscr));
+	}
+
+	free(line);
+#else // __LOWMEM
+	// for each line, write the non-matching subscription extents
+	for (i = 0; i < size_update; i++)
+	{
+		if (skip == NULL || !BITVEC_TEST(skip, i))
+			lazy_rows_materialize(&rows, i, BITMATRIX_ROW(out, i));
+	}
+#endif // __LOWMEM
+
+	lazy_rows_free(&rows);
+
+	return err_none;
+}
+
+
+/** \brief Matching on preallocated buffers.
 
 This function performs all the operations needed to feed the data one dimension at a time to the matching_1D function.
 
+\param data the data set
+\param out the output bit matrix (initialized to zero with __LOWMEM)
+\param ep_list the endpoints list (two endpoints for each extent)
+\param ep_scratch the scratch list of the radix sort, as long as the endpoints list (NULL to allocate it at each sort)
+\param subscr_set_before the array to be used as the the set of "before" subscriptions
+\param subscr_set_after the array to be used as the the set of "after" subscriptions
+\param result_tmp the bit matrix of the single dimensions results (not used with __LOWMEM or with one dimension)
+\param summary the occupancy summary of out, kept up to date to skip the lines without matches (NULL if not used)
+
+\retval error code
+*/
+static _ERR_CODE sort_matching_buffers(const match_data_t data, const bitmatrix out, const list_ptr ep_list, const list_ptr ep_scratch, const bitvector subscr_set_before, const bitvector subscr_set_after, const bitmatrix result_tmp, const bitmatrix_summary_t *summary)
+{
+	_UINT i;
+	size_t matrix_size;
+	bitvector skip;
+	_ERR_CODE err;
+
+	// whole matrix operations include the padding of the rows (out and result_tmp have the same geometry)
+	matrix_size = BITMATRIX_SIZE(out);
+
+	// no line can be skipped until the summary is built
+	skip = NULL;
+
+	// for each dimension
+	for (i = 0; i < data.dimensions; i++)
+	{
+		// fill the endpoints "list" with the data of the dimension to be processed and sort it
+		set_endpoints_list(data, ep_list, i);
+		sort_list_scratch(ep_list, (data.size_update + data.size_subscr) * 2, ep_scratch);
+
+#ifdef __LOWMEM
+		if (OPT_VAR.checkpoint > 0)
+		{
+			err = sort_matching_1D_lazy(ep_list, out, skip, data.size_update, data.size_subscr, OPT_VAR.checkpoint);
+			if (err != err_none)
+				return err;
+		}
+		else if (OPT_VAR.tile > 0)
+			sort_matching_1D_tiled(ep_list, out, skip, subscr_set_before, subscr_set_after, data.size_update, data.size_subscr, OPT_VAR.tile);
+		else
+			sort_matching_1D(ep_list, out, skip, subscr_set_before, subscr_set_after, data.size_update, data.size_subscr);
+
+		// the lines whose blocks are all ones (non-matching in a dimension) can't have matches anymore
+		if (summary != NULL)
+		{
+			bitmatrix_summarize(out, summary, TRUE);
+			skip = summary->empty;
+		}
+#else // __LOWMEM
+		// perform the sort matching on the actual dimension (directly on 'out' for the first dimension)
+		if (OPT_VAR.checkpoint > 0)
+		{
+			err = sort_matching_1D_lazy(ep_list, (i > 0) ? result_tmp : out, skip, data.size_update, data.size_subscr, OPT_VAR.checkpoint);
+			if (err != err_none)
+				return err;
+		}
+		else if (OPT_VAR.tile > 0)
+			sort_matching_1D_tiled(ep_list, (i > 0) ? result_tmp : out, skip, subscr_set_before, subscr_set_after, data.size_update, data.size_subscr, OPT_VAR.tile);
+		else
+			sort_matching_1D(ep_list, (i > 0) ? result_tmp : out, skip, subscr_set_before, subscr_set_after, data.size_update, data.size_subscr);
+
+		// bitwise NOT of the non-matching table to obtain the matching table of the first dimension
+		// (unless it's folded into the combine pass of the second dimension)
+		if (i == 0)
+		{
+			if (!OPT_VAR.fold_not || data.dimensions == 1)
+				vector_bitwise_not(out.base, matrix_size);
+		}
+		// combine in a single pass: out = ~out & ~result_tmp if the NOT of the first dimension is folded
+		else if (i == 1 && OPT_VAR.fold_not)
+			vector_bitwise_nor(out.base, result_tmp.base, matrix_size);
+		// combine in a single pass skipping the decided blocks: out = out & ~result_tmp
+		// (the lines skipped by the sweep are empty, so their garbage in result_tmp isn't read)
+		else if (skip != NULL)
+			bitmatrix_andnot_summary(out, result_tmp, summary);
+		// combine in a single pass: out = out & ~result_tmp
+		else
+			vector_bitwise_andnot(out.base, result_tmp.base, matrix_size);
+
+		// once out holds the matching table, its summary lets the next dimensions skip the lines without matches
+		if (summary != NULL && skip == NULL && (i > 0 || !OPT_VAR.fold_not || data.dimensions == 1))
+		{
+			bitmatrix_summarize(out, summary, FALSE);
+			skip = summary->empty;
+		}
+#endif // __LOWMEM
+	}
+
+#ifdef __LOWMEM
+	// bitwise NOT of the non-matching table to obtain the matching table (and of its summary)
+	vector_bitwise_not(out.base, matrix_size);
+	if (summary != NULL)
+		bitmatrix_summary_invert(summary);
+#endif // __LOWMEM
+
+	return err_none;
+}
+
+
+/** \brief Main algorithm function.
+
+This function allocates the buffers of the matching, performs it with sort_matching_buffers() and frees them. To match many times without allocating memory use a matching context and sort_matching_context().
+
 \param data the data set
 \param out the output bit matrix
 
@@ -126,20 +551,18 @@ This function performs all the operations needed to feed the data one dimension
 */
 _ERR_CODE sort_matching(const match_data_t data, const bitmatrix out)
 {
-	_UINT i;
 	_UINT list_size;
 	_UINT line_width;
-	_UINT matrix_size;
 	list_ptr ep_list;
 	bitvector subscr_set_before;
 	bitvector subscr_set_after;
-#ifndef __LOWMEM
 	bitmatrix result_tmp;
+	bitmatrix_summary_t summary;
 	_ERR_CODE err;
-#endif // __LOWMEM
 
+	result_tmp.base = NULL;
+	summary.zero = NULL;
 	line_width = BIT_VEC_WIDTH(data.size_subscr);
-	matrix_size = data.size_update * line_width;
 
 	if (data.dimensions < 1)
 		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
@@ -147,6 +570,9 @@ _ERR_CODE sort_matching(const match_data_t data, const bitmatrix out)
 	if (data.dimensions > MAX_DIMENSIONS)
 		return set_error(err_too_many_dim, __FILE__, __FUNCTION__, __LINE__);
 
+	if ((uint64_t)data.size_update + data.size_subscr > MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
 #ifndef __LOWMEM
 	if (data.dimensions > 1)
 	{
@@ -157,6 +583,13 @@ _ERR_CODE sort_matching(const match_data_t data, const bitmatrix out)
 	}
 #endif // __LOWMEM
 
+	if (OPT_VAR.summary)
+	{
+		err = create_bitmatrix_summary(&summary, out);
+		if (err != err_none)
+			return err;
+	}
+
 	// two endpoints for each extent
 	list_size = (data.size_update + data.size_subscr) * 2;
 
@@ -168,48 +601,1746 @@ _ERR_CODE sort_matching(const match_data_t data, const bitmatrix out)
 	subscr_set_after = (bitvector)malloc(line_width * sizeof(bitvec_elem));
 	
 	if (ep_list == NULL || subscr_set_before == NULL || subscr_set_after == NULL)
-		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
-	
-	// for each dimension
-	for (i = 0; i < data.dimensions; i++)
-	{
-		// fill the endpoints "list" with the data of the dimension to be processed
-		set_endpoints_list(data, ep_list, i);
-
-#ifdef __LOWMEM
-		sort_matching_1D(ep_list, out, subscr_set_before, subscr_set_after, data.size_update, data.size_subscr);
-#else // __LOWMEM
-		// perform the sort matching on the actual dimension (directly on 'out' for the first dimension)
-		sort_matching_1D(ep_list, (i > 0) ? result_tmp : out, subscr_set_before, subscr_set_after, data.size_update, data.size_subscr);
-
-		// bitwise NOT of the non-matching table to obtain the matching table
-		// directly on matrix 'out' for the first dimension, following times on 'result_tmp'
-		vector_bitwise_not((i > 0) ? result_tmp[0] : out[0], matrix_size);
-			
-		// if it's not the first dimension
-		if (i > 0)
-		{
-			// bitwise AND of the matching table
-			vector_bitwise_and(out[0], result_tmp[0], matrix_size);
-		}
-#endif // __LOWMEM
-	}
+		err = set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+	else
+		err = sort_matching_buffers(data, out, ep_list, NULL, subscr_set_before, subscr_set_after, result_tmp, OPT_VAR.summary ? &summary : NULL);
 
 #ifndef __NOFREE
 	// free memory
 	free(ep_list);
 	free(subscr_set_before);
 	free(subscr_set_after);
-#ifndef __LOWMEM
-	free(*result_tmp);
-	free(result_tmp);
-#endif // __LOWMEM
+	if (result_tmp.base != NULL)
+		free_bit_matrix(&result_tmp);
+	if (summary.zero != NULL)
+		free_bitmatrix_summary(&summary);
 #endif // __NOFREE
 
+	return err;
+}
+
+
+/** \brief One-dimensional self-matching.
+
+The extents are matched against themselves: each extent is listed once and each of its endpoints is processed in both roles. At the lower endpoint the line of the extent gets the "before" set, then the extent leaves the "after" set; at the upper endpoint the line gets the "after" set, then the extent joins the "before" set. Only the upper triangle of the lines is written, from the element of the extent itself, since the result is symmetric.
+
+\param ep_list the endpoints list (size * 2 elements)
+\param out the non-matching packed triangular bit matrix (in the __LOWMEM version the non-matching extents are added to the ones already in the matrix)
+\param set_before the "before" set (BIT_VEC_WIDTH(size) elements)
+\param set_after the "after" set (BIT_VEC_WIDTH(size) elements)
+\param size the number of extents
+*/
+void sort_matching_self_1D(const list_ptr ep_list, const bitmatrix_tri_t out, const bitvector set_before, const bitvector set_after, const _UINT size)
+{
+	_UINT i;
+	_UINT id;
+	_UINT bit_pos;
+	_UINT line_width;
+	bitvector row;
+
+	// number of elements on each full line of the bit matrix
+	line_width = BIT_VEC_WIDTH(size);
+
+	// sort the endpoints list (two endpoints for each extent)
+	sort_list(ep_list, size * 2);
+
+	// set no extent to "before" and all the extents to "after"
+	memset(set_before, 0x00, line_width * sizeof(bitvec_elem));
+	memset(set_after, 0xFF, line_width * sizeof(bitvec_elem));
+
+	// for each endpoint in the list
+	for (i = 0; i < size * 2; i++)
+	{
+		id = ep_list[i].id;
+		bit_pos = BIT_TO_POS(id);
+
+		// the row starts from the element of the extent
+		row = BITMATRIX_TRI_ROW(out, id);
+
+		if (ep_list[i].is_lower_point)
+		{
+			// as an update extent, the extents in the "before" set don't match with it
 #ifdef __LOWMEM
-	// bitwise NOT of the non-matching table to obtain the matching table
-	vector_bitwise_not(out[0], matrix_size);
+			vector_bitwise_or(row, &set_before[bit_pos], line_width - bit_pos);
+#else // __LOWMEM
+			memcpy(row, &set_before[bit_pos], (line_width - bit_pos) * sizeof(bitvec_elem));
 #endif // __LOWMEM
-	
-	return err_none;
+
+			// as a subscription extent, remove it from the "after" set
+			BIT_CLEAR(set_after[bit_pos], DBIT(BIT_POS_IN_VEC(id, bit_pos)));
+		}
+		else
+		{
+			// as an update extent, the extents in the "after" set don't match with it
+			vector_bitwise_or(row, &set_after[bit_pos], line_width - bit_pos);
+
+			// as a subscription extent, add it to the "before" set
+			BIT_SET(set_before[bit_pos], DBIT(BIT_POS_IN_VEC(id, bit_pos)));
+		}
+	}
+}
+
+
+/** \brief Self-matching of the update extents.
+
+The update extents of the data set are matched against themselves (the subscription extents aren't used). Compared to sort_matching() on the same extents as updates and subscriptions, the lists have half the endpoints and only the upper triangle of the result is written and stored; the other half is read from it with bitmatrix_tri_test() or bitmatrix_tri_line().
+
+\param data the data set
+\param out the packed triangular bit matrix of the result, allocated with create_bit_matrix_tri() (zeroed)
+
+\retval error code
+*/
+_ERR_CODE sort_matching_self(const match_data_t data, const bitmatrix_tri_t out)
+{
+	_UINT i;
+	_UINT line_width;
+	list_ptr ep_list;
+	bitvector set_before;
+	bitvector set_after;
+#ifndef __LOWMEM
+	bitmatrix_tri_t result_tmp;
+#endif // __LOWMEM
+	_ERR_CODE err = err_none;
+
+#ifndef __LOWMEM
+	result_tmp.base = NULL;
+#endif // __LOWMEM
+	line_width = BIT_VEC_WIDTH(data.size_update);
+
+	if (data.dimensions < 1)
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+
+	if (data.dimensions > MAX_DIMENSIONS)
+		return set_error(err_too_many_dim, __FILE__, __FUNCTION__, __LINE__);
+
+	if (data.size_update > MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
+#ifndef __LOWMEM
+	// if more than one dimension, a temporary triangle is needed to store the single dimensions results
+	if (data.dimensions > 1)
+	{
+		err = create_bit_matrix_tri(&result_tmp, data.size_update);
+		if (err != err_none)
+			return err;
+	}
+#endif // __LOWMEM
+
+	// allocate the "list" (two endpoints for each extent) and the two sets
+	ep_list = (list_ptr)malloc((size_t)data.size_update * 2 * sizeof(list_t));
+	set_before = (bitvector)malloc(line_width * sizeof(bitvec_elem));
+	set_after = (bitvector)malloc(line_width * sizeof(bitvec_elem));
+
+	if (ep_list == NULL || set_before == NULL || set_after == NULL)
+		err = set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	// for each dimension
+	for (i = 0; i < data.dimensions && err == err_none; i++)
+	{
+		set_self_endpoints_list(data, ep_list, i);
+
+#ifdef __LOWMEM
+		sort_matching_self_1D(ep_list, out, set_before, set_after, data.size_update);
+#else // __LOWMEM
+		if (i == 0)
+			sort_matching_self_1D(ep_list, out, set_before, set_after, data.size_update);
+		else
+		{
+			// the non-matching extents of the dimension are added to the ones of the dimensions before
+			sort_matching_self_1D(ep_list, result_tmp, set_before, set_after, data.size_update);
+			vector_bitwise_or(out.base, result_tmp.base, BITMATRIX_TRI_SIZE(out));
+		}
+#endif // __LOWMEM
+	}
+
+	// bitwise NOT of the non-matching triangle to obtain the matching triangle
+	if (err == err_none)
+		vector_bitwise_not(out.base, BITMATRIX_TRI_SIZE(out));
+
+#ifndef __NOFREE
+	// free memory
+	free(ep_list);
+	free(set_before);
+	free(set_after);
+#ifndef __LOWMEM
+	if (result_tmp.base != NULL)
+		free_bit_matrix_tri(&result_tmp);
+#endif // __LOWMEM
+#endif // __NOFREE
+
+	return err;
+}
+
+
+#ifdef __LOWMEM
+/** \brief Fingerprint of a data set, to recognize the data set of a backing file.
+
+It's the 64 bit FNV-1a hash of the endpoints of all the extents.
+
+\param data the data set
+
+\retval the fingerprint
+*/
+static uint64_t data_fingerprint(const match_data_t data)
+{
+	_UINT i, j;
+	size_t k;
+	uint64_t hash;
+	const unsigned char *bytes;
+
+	hash = 0xCBF29CE484222325ULL;
+
+	// for each dimension, the update extents then the subscription extents
+	for (i = 0; i < data.dimensions; i++)
+	{
+		for (j = 0; j < data.size_update + data.size_subscr; j++)
+		{
+			if (j < data.size_update)
+				bytes = (const unsigned char *)&data.update[j].endpoints[i];
+			else
+				bytes = (const unsigned char *)&data.subscr[j - data.size_update].endpoints[i];
+
+			for (k = 0; k < sizeof(endpoints_t); k++)
+			{
+				hash ^= bytes[k];
+				hash *= 0x100000001B3ULL;
+			}
+		}
+	}
+
+	return hash;
+}
+
+
+/** \brief Out-of-core matching on a result matrix mapped on a backing file.
+
+The update extents are matched in bands of rows. For each band the endpoints of every dimension are swept again, writing only the lines of the band (the other lines are skipped as the lines without matches of the summary), then the band is inverted, written back to the file and released, so that only a band of the matrix is resident at a time. The lists of all the dimensions are sorted once and kept, 2 * (N + M) * D * sizeof(list_t) bytes, so the cost is one sort of the lists and a sweep of them for each band, instead of one.
+After each band the header of the file records the bands complete, so if the header is of the same data set and band size the matching is resumed from the first band not complete.
+
+\param data the data set
+\param out the output bit matrix, allocated with create_bit_matrix_store()
+\param header the header of the backing file
+
+\retval error code
+*/
+_ERR_CODE sort_matching_store(const match_data_t data, const bitmatrix out, store_header_t *header)
+{
+	_UINT i, row;
+	_UINT band_rows, band;
+	_UINT first, last;
+	_UINT list_size;
+	_UINT line_width;
+	uint64_t fingerprint;
+	list_ptr ep_lists;
+	list_ptr ep_list;
+	bitvector subscr_set_before;
+	bitvector subscr_set_after;
+	bitvector skip;
+	_ERR_CODE err = err_none;
+
+	if (data.dimensions < 1)
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+
+	if (data.dimensions > MAX_DIMENSIONS)
+		return set_error(err_too_many_dim, __FILE__, __FUNCTION__, __LINE__);
+
+	if ((uint64_t)data.size_update + data.size_subscr > MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
+	// rows of a band
+	if (OPT_VAR.band > 0)
+		band_rows = OPT_VAR.band;
+	else
+		band_rows = (_UINT)MAX(STORE_BAND_SIZE / ((size_t)out.stride * sizeof(bitvec_elem)), 1);
+	band_rows = MIN(band_rows, data.size_update);
+
+	fingerprint = data_fingerprint(data);
+
+	// a header of another matching is replaced, and the matching starts from the first band
+	if (header->magic != STORE_MAGIC || header->size_update != data.size_update || header->size_subscr != data.size_subscr
+		|| header->dimensions != data.dimensions || header->band != band_rows || header->fingerprint != fingerprint)
+	{
+		header->magic = STORE_MAGIC;
+		header->size_update = data.size_update;
+		header->size_subscr = data.size_subscr;
+		header->dimensions = data.dimensions;
+		header->band = band_rows;
+		header->bands_done = 0;
+		header->fingerprint = fingerprint;
+
+		err = store_header_writeback(header);
+		if (err != err_none)
+			return err;
+	}
+
+	// two endpoints for each extent
+	list_size = (data.size_update + data.size_subscr) * 2;
+	line_width = BIT_VEC_WIDTH(data.size_subscr);
+
+	// allocate the "list" of each dimension, the two subscription extents sets and the lines outside of the band
+	ep_lists = (list_ptr)malloc((size_t)data.dimensions * list_size * sizeof(list_t));
+	subscr_set_before = (bitvector)malloc(line_width * sizeof(bitvec_elem));
+	subscr_set_after = (bitvector)malloc(line_width * sizeof(bitvec_elem));
+	skip = (bitvector)malloc(BIT_VEC_WIDTH(data.size_update) * sizeof(bitvec_elem));
+
+	if (ep_lists == NULL || subscr_set_before == NULL || subscr_set_after == NULL || skip == NULL)
+		err = set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	// fill and sort the endpoints "list" of each dimension once, if there are bands left: the bands only sweep them
+	for (i = 0; i < data.dimensions && err == err_none && header->bands_done * band_rows < data.size_update; i++)
+	{
+		ep_list = ep_lists + (size_t)i * list_size;
+		set_endpoints_list(data, ep_list, i);
+		sort_list(ep_list, list_size);
+	}
+
+	// for each band not complete yet
+	for (band = header->bands_done; err == err_none && band * band_rows < data.size_update; band++)
+	{
+		first = band * band_rows;
+		last = MIN(first + band_rows, data.size_update);
+
+		// only the lines of the band are written by the sweeps
+		memset(skip, 0xFF, BIT_VEC_WIDTH(data.size_update) * sizeof(bitvec_elem));
+		for (row = first; row < last; row++)
+			BITVEC_UNMARK(skip, row);
+
+		// the band starts empty, even if it was partially written before an interruption
+		memset(BITMATRIX_ROW(out, first), 0, (size_t)(last - first) * out.stride * sizeof(bitvec_elem));
+
+		// for each dimension, accumulate the non-matching subscription extents of the lines of the band
+		for (i = 0; i < data.dimensions && err == err_none; i++)
+		{
+			ep_list = ep_lists + (size_t)i * list_size;
+
+			if (OPT_VAR.checkpoint > 0)
+				err = sort_matching_1D_lazy(ep_list, out, skip, data.size_update, data.size_subscr, OPT_VAR.checkpoint);
+			else if (OPT_VAR.tile > 0)
+				sort_matching_1D_tiled(ep_list, out, skip, subscr_set_before, subscr_set_after, data.size_update, data.size_subscr, OPT_VAR.tile);
+			else
+				sort_matching_1D(ep_list, out, skip, subscr_set_before, subscr_set_after, data.size_update, data.size_subscr);
+		}
+
+		if (err != err_none)
+			break;
+
+		// bitwise NOT of the non-matching table of the band, which is then written to the file and released
+		vector_bitwise_not(BITMATRIX_ROW(out, first), (size_t)(last - first) * out.stride);
+		err = bitmatrix_band_writeback(out, first, last);
+
+		// the band is recorded as complete only once it's in the file
+		if (err == err_none)
+		{
+			header->bands_done = band + 1;
+			err = store_header_writeback(header);
+		}
+	}
+
+#ifndef __NOFREE
+	// free memory
+	free(ep_lists);
+	free(subscr_set_before);
+	free(subscr_set_after);
+	free(skip);
+#endif // __NOFREE
+
+	return err;
+}
+#endif // __LOWMEM
+
+
+/** \brief Initializes an empty matching context.
+
+\param ctx the matching context
+*/
+void match_context_init(match_context_t *ctx)
+{
+	memset(ctx, 0, sizeof(match_context_t));
+}
+
+
+/** \brief Size of a buffer of the arena, rounded up to ARENA_ALIGNMENT bytes.
+*/
+#define ARENA_SIZE(_bytes)			( ((size_t)(_bytes) + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1) )
+
+
+/** \brief Lays out the buffers of a matching context in a memory block.
+
+\param ctx the matching context (its pointers are set only if base isn't NULL)
+\param base the memory block (aligned to ARENA_ALIGNMENT bytes), or NULL to compute only its size
+\param size_update the number of update extents
+\param size_subscr the number of subscription extents
+\param dimensions the number of dimensions
+
+\retval the size of the memory block in bytes
+*/
+static size_t match_context_layout(match_context_t *ctx, char *base, const _UINT size_update, const _UINT size_subscr, const _UINT dimensions)
+{
+	size_t size;
+	size_t list_bytes, set_bytes, matrix_bytes, summary_bytes;
+	bitmatrix geometry;
+	_BOOL with_tmp;
+
+	list_bytes = ARENA_SIZE((size_t)(size_update + size_subscr) * 2 * sizeof(list_t));
+	set_bytes = ARENA_SIZE(BIT_VEC_WIDTH(size_subscr) * sizeof(bitvec_elem));
+	matrix_bytes = ARENA_SIZE(bitmatrix_layout(&geometry, NULL, size_update, size_subscr));
+	summary_bytes = ARENA_SIZE(bitmatrix_summary_layout(&ctx->summary, NULL, geometry));
+
+#ifdef __LOWMEM
+	with_tmp = FALSE;
+#else // __LOWMEM
+	with_tmp = (dimensions > 1);
+#endif // __LOWMEM
+
+	// the list and the scratch list of its sort, the two sets, the summary of the result, the result and, if needed, the temporary result
+	// (ARENA_ALIGNMENT is a multiple of BITMATRIX_ALIGNMENT, so the rows of the matrices stay aligned)
+	size = 2 * list_bytes + 2 * set_bytes + summary_bytes + matrix_bytes;
+	if (with_tmp)
+		size += matrix_bytes;
+
+	if (base == NULL)
+		return size;
+
+	ctx->ep_list = (list_ptr)base;
+	base += list_bytes;
+	ctx->ep_scratch = (list_ptr)base;
+	base += list_bytes;
+	ctx->subscr_set_before = (bitvector)base;
+	base += set_bytes;
+	ctx->subscr_set_after = (bitvector)base;
+	base += set_bytes;
+	bitmatrix_summary_layout(&ctx->summary, (bitvector)base, geometry);
+	base += summary_bytes;
+
+	bitmatrix_layout(&ctx->result, (bitvector)base, size_update, size_subscr);
+	base += matrix_bytes;
+
+	bitmatrix_layout(&ctx->result_tmp, with_tmp ? (bitvector)base : NULL, size_update, size_subscr);
+
+	ctx->size_update = size_update;
+	ctx->size_subscr = size_subscr;
+	ctx->dimensions = dimensions;
+
+	return size;
+}
+
+
+/** \brief Prepares the buffers of a matching context for a problem of the given size.
+
+The arena is enlarged only if it's too small, otherwise the buffers are laid out again in the memory already allocated. Reserving the biggest problem in advance avoids any allocation in the following matchings.
+
+\param ctx the matching context
+\param size_update the number of update extents
+\param size_subscr the number of subscription extents
+\param dimensions the number of dimensions
+
+\retval error code
+*/
+_ERR_CODE match_context_reserve(match_context_t *ctx, const _UINT size_update, const _UINT size_subscr, const _UINT dimensions)
+{
+	size_t size;
+	void *arena;
+
+	if (dimensions < 1)
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+
+	if (dimensions > MAX_DIMENSIONS)
+		return set_error(err_too_many_dim, __FILE__, __FUNCTION__, __LINE__);
+
+	if ((uint64_t)size_update + size_subscr > MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
+	// the layout is already the right one
+	if (ctx->arena != NULL && ctx->size_update == size_update && ctx->size_subscr == size_subscr && ctx->dimensions == dimensions)
+		return err_none;
+
+	size = match_context_layout(ctx, NULL, size_update, size_subscr, dimensions);
+
+	if (size > ctx->arena_size)
+	{
+		// the old content isn't needed, so the arena is allocated again instead of reallocated
+		// (memory_alloc() returns whole pages, so the arena is aligned to ARENA_ALIGNMENT)
+		arena = memory_alloc(size);
+		if (arena == NULL)
+			return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+		memory_free(ctx->arena, ctx->arena_size);
+		ctx->arena = arena;
+		ctx->arena_size = size;
+	}
+
+	match_context_layout(ctx, (char *)ctx->arena, size_update, size_subscr, dimensions);
+
+	return err_none;
+}
+
+
+/** \brief Main algorithm function on a matching context.
+
+The buffers of the context are reused, the radix sort included, so no memory is allocated unless the problem is bigger than all the previous ones (or than the one reserved with match_context_reserve()). The checkpointed sweep is the exception: it allocates its snapshots at each dimension.
+
+\param ctx the matching context
+\param data the data set
+
+\retval error code (the result is in ctx->result)
+*/
+_ERR_CODE sort_matching_context(match_context_t *ctx, const match_data_t data)
+{
+	_ERR_CODE err;
+
+	err = match_context_reserve(ctx, data.size_update, data.size_subscr, data.dimensions);
+	if (err != err_none)
+		return err;
+
+#ifdef __LOWMEM
+	// the non-matching bits of all the dimensions are accumulated in the result, so it must start empty
+	memset(ctx->result.base, 0, (size_t)BITMATRIX_SIZE(ctx->result) * sizeof(bitvec_elem));
+#endif // __LOWMEM
+
+	return sort_matching_buffers(data, ctx->result, ctx->ep_list, ctx->ep_scratch, ctx->subscr_set_before, ctx->subscr_set_after, ctx->result_tmp, OPT_VAR.summary ? &ctx->summary : NULL);
+}
+
+
+/** \brief Frees the arena of a matching context.
+
+\param ctx the matching context
+*/
+void match_context_free(match_context_t *ctx)
+{
+	memory_free(ctx->arena, ctx->arena_size);
+	match_context_init(ctx);
+}
+
+
+/** \brief Ordering rule of the persistent matching.
+
+It's the same ordering of compare_endpoints(), but the elements that compare equal are never swapped, so the insertion sort doesn't move them back and forth between ticks.
+
+\param a pointer to the first endpoint
+\param b pointer to the second endpoint
+
+\retval TRUE if a must be before b in the list
+\retval FALSE otherwise
+*/
+static INLINE _BOOL endpoint_before(const list_t *a, const list_t *b)
+{
+#ifdef __SUPERSET
+	return a->point < b->point;
+#else // __SUPERSET
+	return a->point < b->point || (a->point == b->point && a->is_lower_point && !b->is_lower_point);
+#endif // __SUPERSET
+}
+
+
+/** \brief Updates the matching state after two adjacent endpoints are swapped.
+
+Only the swap of an update and a subscription endpoint of different type changes the relation of the two extents: when the upper endpoint of one of them moves before the lower endpoint of the other the extents stop overlapping, when it moves after they start overlapping.
+
+\param state the state of the persistent matching
+\param dimension the dimension of the list
+\param out the output bit matrix
+\param moved the endpoint that has been moved before the other one
+\param passed the endpoint that is now after the moved one
+*/
+static void persistent_swap(const persistent_state_t *state, const _UINT dimension, const bitmatrix out, const list_t *moved, const list_t *passed)
+{
+	_UINT i;
+	_UINT line;
+	_UINT subscr;
+	_UINT bit_pos;
+	bitvec_elem bit;
+	_BOOL matching;
+
+	// both endpoints of subscriptions or updates, or endpoints of the same type
+	if ((moved->id < state->size_subscr) == (passed->id < state->size_subscr) || moved->is_lower_point == passed->is_lower_point)
+		return;
+
+	if (moved->id < state->size_subscr)
+	{
+		subscr = moved->id;
+		line = passed->id - state->size_subscr;
+	}
+	else
+	{
+		subscr = passed->id;
+		line = moved->id - state->size_subscr;
+	}
+
+	// calculate the element in the bit vector that contains the bit
+	bit_pos = BIT_TO_POS(subscr);
+	bit = DBIT(BIT_POS_IN_VEC(subscr, bit_pos));
+
+	// the extents don't overlap anymore if the upper endpoint has been moved before the lower one
+	if (moved->is_lower_point)
+		BIT_CLEAR(BITMATRIX_ROW(state->result[dimension], line)[bit_pos], bit);
+	else
+		BIT_SET(BITMATRIX_ROW(state->result[dimension], line)[bit_pos], bit);
+
+	// the extents match if they overlap in every dimension
+	matching = TRUE;
+	for (i = 0; i < state->dimensions && matching; i++)
+		matching = !(BITMATRIX_ROW(state->result[i], line)[bit_pos] & bit);
+
+	if (matching)
+		BIT_SET(BITMATRIX_ROW(out, line)[bit_pos], bit);
+	else
+		BIT_CLEAR(BITMATRIX_ROW(out, line)[bit_pos], bit);
+}
+
+
+/** \brief Builds the output matrix from the non-matching matrices of every dimension.
+
+\param state the state of the persistent matching
+\param out the output bit matrix
+*/
+static void persistent_combine(const persistent_state_t *state, const bitmatrix out)
+{
+	_UINT i;
+	size_t matrix_size;
+
+	// the matrices have the same geometry, padding of the rows included
+	matrix_size = BITMATRIX_SIZE(out);
+
+	memcpy(out.base, state->result[0].base, matrix_size * sizeof(bitvec_elem));
+	for (i = 1; i < state->dimensions; i++)
+		vector_bitwise_or(out.base, state->result[i].base, matrix_size);
+
+	// bitwise NOT of the non-matching table to obtain the matching table
+	vector_bitwise_not(out.base, matrix_size);
+}
+
+
+/** \brief Initializes the persistent matching.
+
+This function performs the sort matching of every dimension like sort_matching(), but keeps the sorted endpoints lists and the non-matching matrix of each dimension in the state, so that they can be updated by persistent_matching_update().
+
+\param state the state of the persistent matching
+\param data the data set
+\param out the output bit matrix
+
+\retval error code
+*/
+_ERR_CODE persistent_matching_init(persistent_state_t *state, const match_data_t data, const bitmatrix out)
+{
+	_UINT i;
+	_UINT list_size;
+	_UINT line_width;
+	bitvector subscr_set_before;
+	bitvector subscr_set_after;
+	_ERR_CODE err;
+
+	if (data.dimensions < 1)
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+
+	if (data.dimensions > MAX_DIMENSIONS)
+		return set_error(err_too_many_dim, __FILE__, __FUNCTION__, __LINE__);
+
+	if ((uint64_t)data.size_update + data.size_subscr > MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
+	memset(state, 0, sizeof(persistent_state_t));
+	state->dimensions = data.dimensions;
+	state->size_update = data.size_update;
+	state->size_subscr = data.size_subscr;
+
+	// two endpoints for each extent
+	list_size = (data.size_update + data.size_subscr) * 2;
+	line_width = BIT_VEC_WIDTH(data.size_subscr);
+
+	// allocate the two subscription extents sets
+	subscr_set_before = (bitvector)malloc(line_width * sizeof(bitvec_elem));
+	subscr_set_after = (bitvector)malloc(line_width * sizeof(bitvec_elem));
+	if (subscr_set_before == NULL || subscr_set_after == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	// for each dimension
+	for (i = 0; i < data.dimensions; i++)
+	{
+		// allocate the "list" and the non-matching matrix of the dimension
+		state->ep_list[i] = (list_ptr)malloc(list_size * sizeof(list_t));
+		if (state->ep_list[i] == NULL)
+			return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+		err = create_bit_matrix(&state->result[i], data.size_update, data.size_subscr);
+		if (err != err_none)
+			return err;
+
+		// fill the endpoints "list" with the data of the dimension to be processed and sort it
+		set_endpoints_list(data, state->ep_list[i], i);
+		sort_list(state->ep_list[i], list_size);
+
+		// perform the sort matching on the actual dimension (the list stays sorted)
+		sort_matching_1D(state->ep_list[i], state->result[i], NULL, subscr_set_before, subscr_set_after, data.size_update, data.size_subscr);
+	}
+
+	free(subscr_set_before);
+	free(subscr_set_after);
+
+	persistent_combine(state, out);
+
+	return err_none;
+}
+
+
+/** \brief Updates the persistent matching after the extents have moved.
+
+The endpoints lists are updated with the new positions of the extents and sorted again with an insertion sort. Every swap between an update and a subscription endpoint updates the non-matching matrix of the dimension and the output matrix, so the cost depends on how much the extents have moved rather than on the size of the matrix.
+
+\remarks The output matrix must be the same one passed to persistent_matching_init() or to the last call of this function.
+
+\param state the state of the persistent matching
+\param data the data set, with the same number of extents and dimensions used for the initialization
+\param out the output bit matrix
+
+\retval error code
+*/
+_ERR_CODE persistent_matching_update(persistent_state_t *state, const match_data_t data, const bitmatrix out)
+{
+	_UINT i, j, k;
+	_UINT list_size;
+	list_ptr ep_list;
+	list_t moving;
+
+	if (data.dimensions != state->dimensions || data.size_update != state->size_update || data.size_subscr != state->size_subscr)
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+
+	// two endpoints for each extent
+	list_size = (data.size_update + data.size_subscr) * 2;
+
+	// for each dimension
+	for (i = 0; i < data.dimensions; i++)
+	{
+		ep_list = state->ep_list[i];
+
+		// read the new positions of the endpoints
+		refresh_endpoints_list(data, ep_list, list_size, i);
+
+		// insertion sort (the list is almost sorted)
+		for (j = 1; j < list_size; j++)
+		{
+			moving = ep_list[j];
+
+			for (k = j; k > 0 && endpoint_before(&moving, &ep_list[k - 1]); k--)
+			{
+				persistent_swap(state, i, out, &moving, &ep_list[k - 1]);
+				ep_list[k] = ep_list[k - 1];
+			}
+
+			ep_list[k] = moving;
+		}
+	}
+
+	return err_none;
+}
+
+
+/** \brief Frees the memory of the persistent matching.
+
+\param state the state of the persistent matching
+*/
+void persistent_matching_free(persistent_state_t *state)
+{
+	_UINT i;
+
+	for (i = 0; i < state->dimensions; i++)
+	{
+		free(state->ep_list[i]);
+		if (state->result[i].base != NULL)
+			free_bit_matrix(&state->result[i]);
+	}
+
+	memset(state, 0, sizeof(persistent_state_t));
+}
+
+
+/** \brief Enlarges the endpoints of an extent like set_endpoints_list() when building a superset.
+
+\param ep the endpoints
+
+\retval the endpoints to be compared
+*/
+static INLINE endpoints_t enlarge_endpoints(endpoints_t ep)
+{
+#ifdef __SUPERSET
+	if (ep.lower > SPACE_TYPE_MIN)
+		ep.lower -= SPACE_TYPE_INC;
+	if (ep.upper < SPACE_TYPE_MAX)
+		ep.upper += SPACE_TYPE_INC;
+#endif // __SUPERSET
+
+	return ep;
+}
+
+
+/** \brief Overlap test of an update and a subscription extent in a dimension.
+
+The endpoints are enlarged like in set_endpoints_list() when building a superset.
+
+\param update the endpoints of the update extent
+\param subscr the endpoints of the subscription extent
+
+\retval TRUE if the extents overlap
+\retval FALSE otherwise
+*/
+static INLINE _BOOL extents_overlap(endpoints_t update, endpoints_t subscr)
+{
+	update = enlarge_endpoints(update);
+	subscr = enlarge_endpoints(subscr);
+
+	return !(subscr.upper < update.lower || subscr.lower > update.upper);
+}
+
+
+/** \brief Growing list of matching pairs, in the order they are found.
+*/
+typedef struct
+{
+	size_t		size;				///< number of pairs
+	size_t		capacity;			///< number of allocated pairs
+	_UINT		*update;			///< identifiers of the update extents
+	_UINT		*subscr;			///< identifiers of the subscription extents
+} pair_list_t;
+
+
+/** \brief Appends a pair to the list, doubling its capacity when needed.
+
+\param list the list of pairs
+\param update the identifier of the update extent
+\param subscr the identifier of the subscription extent
+
+\retval error code
+*/
+static _ERR_CODE push_pair(pair_list_t *list, const _UINT update, const _UINT subscr)
+{
+	_UINT *tmp;
+
+	if (list->size == list->capacity)
+	{
+		list->capacity = (list->capacity > 0) ? list->capacity * 2 : 1024;
+
+		tmp = (_UINT *)realloc(list->update, list->capacity * sizeof(_UINT));
+		if (tmp == NULL)
+			return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+		list->update = tmp;
+
+		tmp = (_UINT *)realloc(list->subscr, list->capacity * sizeof(_UINT));
+		if (tmp == NULL)
+			return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+		list->subscr = tmp;
+	}
+
+	list->update[list->size] = update;
+	list->subscr[list->size] = subscr;
+	list->size++;
+
+	return err_none;
+}
+
+
+/** \brief Checks a candidate pair in the dimensions after the first one and stores it if it matches.
+
+\param data the data set
+\param pairs the list of matching pairs
+\param update the identifier of the update extent
+\param subscr the identifier of the subscription extent
+
+\retval error code
+*/
+static INLINE _ERR_CODE check_pair(const match_data_t data, pair_list_t *pairs, const _UINT update, const _UINT subscr)
+{
+	_UINT i;
+
+	for (i = 1; i < data.dimensions; i++)
+	{
+		if (!extents_overlap(data.update[update].endpoints[i], data.subscr[subscr].endpoints[i]))
+			return err_none;
+	}
+
+	return push_pair(pairs, update, subscr);
+}
+
+
+/** \brief Output-sensitive matching.
+
+This function sweeps the sorted endpoints list of the first dimension keeping the sets of the active (open) update and subscription extents. When an extent opens it overlaps, in the first dimension, with all the active extents of the other kind; each of these candidate pairs is checked in the other dimensions and stored if it matches. The pairs are then grouped by update extent in compressed sparse rows, each row sorted by subscription extent.
+
+The cost is O((N + M) log(N + M) + K1 * D), where K1 is the number of pairs overlapping in the first dimension, instead of the O(N * M) of the bit matrix.
+
+\param data the data set
+\param out the list of matching pairs (allocated by the function, to be freed with free_match_csr())
+
+\retval error code
+*/
+_ERR_CODE sort_matching_pairs(const match_data_t data, match_csr_t *out)
+{
+	size_t i, j;
+	_UINT id;
+	_UINT list_size;
+	_UINT active_update_count, active_subscr_count;
+	_UINT *active_update, *active_subscr;
+	size_t *position;
+	size_t *order;
+	list_ptr ep_list;
+	pair_list_t pairs;
+	_ERR_CODE err = err_none;
+
+	if (data.dimensions < 1)
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+
+	if (data.dimensions > MAX_DIMENSIONS)
+		return set_error(err_too_many_dim, __FILE__, __FUNCTION__, __LINE__);
+
+	if ((uint64_t)data.size_update + data.size_subscr > MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
+	memset(&pairs, 0, sizeof(pair_list_t));
+
+	// two endpoints for each extent
+	list_size = (data.size_update + data.size_subscr) * 2;
+
+	// allocate the "list", the active sets and the position of each extent in its active set
+	ep_list = (list_ptr)malloc(list_size * sizeof(list_t));
+	active_update = (_UINT *)malloc(data.size_update * sizeof(_UINT));
+	active_subscr = (_UINT *)malloc(data.size_subscr * sizeof(_UINT));
+	position = (size_t *)malloc(((size_t)data.size_update + data.size_subscr) * sizeof(size_t));
+	out->first = (size_t *)calloc((size_t)data.size_update + 1, sizeof(size_t));
+	if (ep_list == NULL || active_update == NULL || active_subscr == NULL || position == NULL || out->first == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	// fill and sort the endpoints "list" of the first dimension
+	set_endpoints_list(data, ep_list, 0);
+	sort_list(ep_list, list_size);
+
+	active_update_count = 0;
+	active_subscr_count = 0;
+
+	// for each endpoint in the list
+	for (i = 0; i < list_size && err == err_none; i++)
+	{
+		id = ep_list[i].id;
+
+		// if it's the endpoint of a subscription extent
+		if (id < data.size_subscr)
+		{
+			if (ep_list[i].is_lower_point)
+			{
+				// the subscription extent overlaps with every active update extent
+				for (j = 0; j < active_update_count && err == err_none; j++)
+					err = check_pair(data, &pairs, active_update[j], id);
+
+				position[id] = active_subscr_count;
+				active_subscr[active_subscr_count++] = id;
+			}
+			else
+			{
+				// remove the subscription extent from the active set, moving the last one in its place
+				active_subscr[position[id]] = active_subscr[--active_subscr_count];
+				position[active_subscr[position[id]]] = position[id];
+			}
+		}
+		else // if it's the endpoint of an update extent
+		{
+			if (ep_list[i].is_lower_point)
+			{
+				// the update extent overlaps with every active subscription extent
+				for (j = 0; j < active_subscr_count && err == err_none; j++)
+					err = check_pair(data, &pairs, id - data.size_subscr, active_subscr[j]);
+
+				position[id] = active_update_count;
+				active_update[active_update_count++] = id - data.size_subscr;
+			}
+			else
+			{
+				// remove the update extent from the active set, moving the last one in its place
+				active_update[position[id]] = active_update[--active_update_count];
+				position[active_update[position[id]] + data.size_subscr] = position[id];
+			}
+		}
+	}
+
+	if (err == err_none)
+	{
+		out->size_update = data.size_update;
+		out->count = pairs.size;
+		out->subscr = (_UINT *)malloc(MAX(pairs.size, 1) * sizeof(_UINT));
+		order = (size_t *)malloc(MAX(pairs.size, 1) * sizeof(size_t));
+		if (out->subscr == NULL || order == NULL)
+			return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+		// two stable counting sorts (position[] is reused as the next free position of each bucket):
+		// the pairs are first ordered by subscription extent...
+		memset(position, 0, data.size_subscr * sizeof(size_t));
+		for (i = 0; i < pairs.size; i++)
+			position[pairs.subscr[i]]++;
+		for (i = 0, j = 0; i < data.size_subscr; i++)
+		{
+			id = (_UINT)position[i];
+			position[i] = j;
+			j += id;
+		}
+		for (i = 0; i < pairs.size; i++)
+			order[position[pairs.subscr[i]]++] = i;
+
+		// ...then grouped by update extent, so that each row is sorted
+		for (i = 0; i < pairs.size; i++)
+			out->first[pairs.update[i] + 1]++;
+		for (i = 0; i < data.size_update; i++)
+			out->first[i + 1] += out->first[i];
+		memcpy(position, out->first, data.size_update * sizeof(size_t));
+		for (i = 0; i < pairs.size; i++)
+			out->subscr[position[pairs.update[order[i]]]++] = pairs.subscr[order[i]];
+
+#ifndef __NOFREE
+		free(order);
+#endif // __NOFREE
+	}
+
+#ifndef __NOFREE
+	// free memory
+	free(ep_list);
+	free(active_update);
+	free(active_subscr);
+	free(position);
+	free(pairs.update);
+	free(pairs.subscr);
+#endif // __NOFREE
+
+	return err;
+}
+
+
+/** \brief Output-sensitive matching on compressed rows.
+
+This function builds the checkpointed result of every dimension (see lazy_rows_build()), then writes the lines of the update extents one at a time: the non-matching lines of the dimensions are built from the snapshots and combined, and the matching line is appended to the compressed result.
+
+The bit matrix is never allocated. The interval between two snapshots is at least 2M / SPARSE_MAX_SNAPSHOTS subscription endpoints, so each dimension keeps at most SPARSE_MAX_SNAPSHOTS + 2 pairs of lines: besides the result, the memory used is O(D * (N + M)), about D * (2 * (SPARSE_MAX_SNAPSHOTS + 2) * M / 8 + 14 * M + 8 * N) bytes, plus two lines. The price is the replay of at most 2 * interval endpoints for each line and dimension, O(D * N * M / SPARSE_MAX_SNAPSHOTS) in the worst case, like the sweep of the bit matrix.
+
+\param data the data set
+\param out the compressed result (allocated by the function, to be freed with free_match_sparse())
+
+\retval error code
+*/
+_ERR_CODE sort_matching_sparse(const match_data_t data, match_sparse_t *out)
+{
+	_UINT i, j;
+	_UINT list_size;
+	_UINT line_width;
+	_UINT interval;
+	list_ptr ep_list;
+	bitvector line;
+	bitvector line_tmp;
+	lazy_rows_t rows[MAX_DIMENSIONS];
+	_ERR_CODE err = err_none;
+
+	if (data.dimensions < 1)
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+
+	if (data.dimensions > MAX_DIMENSIONS)
+		return set_error(err_too_many_dim, __FILE__, __FUNCTION__, __LINE__);
+
+	if ((uint64_t)data.size_update + data.size_subscr > MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
+	memset(out, 0, sizeof(match_sparse_t));
+	memset(rows, 0, sizeof(rows));
+	out->size_update = data.size_update;
+	out->size_subscr = data.size_subscr;
+
+	// two endpoints for each extent
+	list_size = (data.size_update + data.size_subscr) * 2;
+	line_width = BIT_VEC_WIDTH(data.size_subscr);
+	// the snapshots of each dimension are bounded, so their memory is linear in M
+	interval = (OPT_VAR.checkpoint > 0) ? OPT_VAR.checkpoint : SPARSE_CHECKPOINT_INTERVAL;
+	interval = MAX(interval, (data.size_subscr * 2 + SPARSE_MAX_SNAPSHOTS - 1) / SPARSE_MAX_SNAPSHOTS);
+
+	// allocate the "list", the two lines and the first container of each row
+	ep_list = (list_ptr)malloc(list_size * sizeof(list_t));
+	line = (bitvector)malloc(line_width * sizeof(bitvec_elem));
+	line_tmp = (bitvector)malloc(line_width * sizeof(bitvec_elem));
+	out->first = (size_t *)calloc((size_t)data.size_update + 1, sizeof(size_t));
+	if (ep_list == NULL || line == NULL || line_tmp == NULL || out->first == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	// checkpointed result of each dimension (the list is reused)
+	for (i = 0; i < data.dimensions && err == err_none; i++)
+	{
+		set_endpoints_list(data, ep_list, i);
+		sort_list(ep_list, list_size);
+		err = lazy_rows_build(ep_list, &rows[i], data.size_update, data.size_subscr, interval);
+	}
+
+#ifndef __NOFREE
+	free(ep_list);
+#endif // __NOFREE
+
+	// for each line, combine the non-matching lines of the dimensions and compress the matching one
+	for (i = 0; i < data.size_update && err == err_none; i++)
+	{
+		lazy_rows_materialize(&rows[0], i, line);
+		for (j = 1; j < data.dimensions; j++)
+		{
+			lazy_rows_materialize(&rows[j], i, line_tmp);
+			vector_bitwise_or(line, line_tmp, line_width);
+		}
+
+		// bitwise NOT of the non-matching line to obtain the matching line
+		vector_bitwise_not(line, line_width);
+
+		err = match_sparse_append_row(out, i, line);
+	}
+
+#ifndef __NOFREE
+	// free memory
+	for (i = 0; i < data.dimensions; i++)
+		lazy_rows_free(&rows[i]);
+	free(line);
+	free(line_tmp);
+#endif // __NOFREE
+
+	return err;
+}
+
+
+/** \brief Changes the size of a buffer of the incremental index.
+
+\param buffer pointer to the buffer
+\param size the new size in bytes
+
+\retval error code
+*/
+static _ERR_CODE index_resize(void **buffer, const size_t size)
+{
+	void *tmp;
+
+	tmp = realloc(*buffer, size);
+	if (tmp == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	*buffer = tmp;
+
+	return err_none;
+}
+
+
+/** \brief Binary search of a position in a sorted list of endpoints.
+
+\param list the list, sorted by position
+\param size the number of endpoints in the list
+\param point the position searched
+\param after search the first endpoint after the position instead of the first one not before it
+
+\retval the index of the first endpoint whose position is greater (after) or greater or equal (not after) than the position searched
+*/
+static INLINE _UINT index_search(const list_ptr list, const _UINT size, const SPACE_TYPE point, const _BOOL after)
+{
+	_UINT first, last, middle;
+
+	first = 0;
+	last = size;
+	while (first < last)
+	{
+		middle = first + (last - first) / 2;
+		if (list[middle].point < point || (after && list[middle].point == point))
+			first = middle + 1;
+		else
+			last = middle;
+	}
+
+	return first;
+}
+
+
+/** \brief Inserts an endpoint in a sorted list, after the endpoints at the same position.
+
+\param list the list, with room for one more endpoint
+\param size the number of endpoints in the list
+\param ep the endpoint to be inserted
+*/
+static void index_list_insert(const list_ptr list, const _UINT size, const list_t ep)
+{
+	_UINT pos;
+
+	pos = index_search(list, size, ep.point, TRUE);
+	memmove(&list[pos + 1], &list[pos], (size - pos) * sizeof(list_t));
+	list[pos] = ep;
+}
+
+
+/** \brief Removes an endpoint from a sorted list.
+
+\param list the list
+\param size the number of endpoints in the list
+\param ep the endpoint to be removed
+
+\retval error code (err_invalid_input if the endpoint isn't found from its position on, e.g. if its coordinates aren't comparable)
+*/
+static _ERR_CODE index_list_remove(const list_ptr list, const _UINT size, const list_t ep)
+{
+	_UINT pos;
+
+	// the endpoint is among the ones at the same position
+	for (pos = index_search(list, size, ep.point, FALSE); pos < size && list[pos].id != ep.id; pos++);
+
+	if (pos == size)
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+
+	memmove(&list[pos], &list[pos + 1], (size - pos - 1) * sizeof(list_t));
+
+	return err_none;
+}
+
+
+/** \brief Inserts or removes the endpoints of an extent in the sorted lists of every dimension.
+
+\param side the extents of the index
+\param dimensions the number of dimensions
+\param id the identifier of the extent
+\param insert insert the endpoints instead of removing them
+
+\remarks If an endpoint to be removed isn't found, the lists already visited have lost the endpoints of the extent: the index can only be freed.
+
+\retval error code
+*/
+static _ERR_CODE index_endpoints(index_extents_t *side, const _UINT dimensions, const _UINT id, const _BOOL insert)
+{
+	_UINT i;
+	endpoints_t ep;
+	list_t lower, upper;
+	_ERR_CODE err;
+
+	for (i = 0; i < dimensions; i++)
+	{
+		// the lists hold the enlarged endpoints, like the endpoints list of the sweep
+		ep = enlarge_endpoints(side->extents[id].endpoints[i]);
+
+		lower.id = id;
+		lower.is_lower_point = TRUE;
+		lower.point = ep.lower;
+		upper.id = id;
+		upper.is_lower_point = FALSE;
+		upper.point = ep.upper;
+
+		if (insert)
+		{
+			index_list_insert(side->lower[i], side->size, lower);
+			index_list_insert(side->upper[i], side->size, upper);
+		}
+		else if ((err = index_list_remove(side->lower[i], side->size, lower)) != err_none
+			|| (err = index_list_remove(side->upper[i], side->size, upper)) != err_none)
+			return err;
+	}
+
+	if (insert)
+		side->size++;
+	else
+		side->size--;
+
+	return err_none;
+}
+
+
+/** \brief Finds the extents of the index overlapping an extent in every dimension.
+
+In each dimension the extents that don't overlap are the ones whose upper endpoint is before the lower endpoint of the extent and the ones whose lower endpoint is after its upper endpoint: they are a prefix of the sorted upper endpoints and a suffix of the sorted lower endpoints, found by binary search. The cheaper of two ways is then used: clearing the bits of the extents that don't overlap, or setting the bits of the ones that overlap in a temporary line and ANDing it.
+
+\param index the incremental index
+\param side the extents of the index to be matched (of the other type)
+\param extent the extent
+\param out the line of the extents overlapping the extent, BIT_VEC_WIDTH(side->capacity) elements
+*/
+static void index_overlap(const match_index_t *index, const index_extents_t *side, const extent_t *extent, const bitvector out)
+{
+	_UINT i, j;
+	_UINT id;
+	_UINT line_width;
+	_UINT before;
+	_UINT not_after;
+	_UINT bit_pos;
+	endpoints_t ep;
+	endpoints_t other;
+
+	line_width = BIT_VEC_WIDTH(side->capacity);
+
+	// only the extents in the index can overlap
+	memcpy(out, side->live, line_width * sizeof(bitvec_elem));
+
+	for (i = 0; i < index->dimensions; i++)
+	{
+		ep = enlarge_endpoints(extent->endpoints[i]);
+
+		// the extents in upper[0, before) end before the extent, the ones in lower[not_after, size) start after it
+		before = index_search(side->upper[i], side->size, ep.lower, FALSE);
+		not_after = index_search(side->lower[i], side->size, ep.upper, TRUE);
+
+		if (before + (side->size - not_after) <= MIN(not_after, side->size - before) + line_width)
+		{
+			// clear the extents that don't overlap
+			for (j = 0; j < before; j++)
+			{
+				id = side->upper[i][j].id;
+				bit_pos = BIT_TO_POS(id);
+				BIT_CLEAR(out[bit_pos], DBIT(BIT_POS_IN_VEC(id, bit_pos)));
+			}
+			for (j = not_after; j < side->size; j++)
+			{
+				id = side->lower[i][j].id;
+				bit_pos = BIT_TO_POS(id);
+				BIT_CLEAR(out[bit_pos], DBIT(BIT_POS_IN_VEC(id, bit_pos)));
+			}
+		}
+		else
+		{
+			// set the extents that overlap, checking the other endpoint of the shorter range
+			memset(index->line_tmp, 0, line_width * sizeof(bitvec_elem));
+			if (not_after <= side->size - before)
+			{
+				for (j = 0; j < not_after; j++)
+				{
+					id = side->lower[i][j].id;
+					other = enlarge_endpoints(side->extents[id].endpoints[i]);
+					bit_pos = BIT_TO_POS(id);
+					if (other.upper >= ep.lower)
+						BIT_SET(index->line_tmp[bit_pos], DBIT(BIT_POS_IN_VEC(id, bit_pos)));
+				}
+			}
+			else
+			{
+				for (j = before; j < side->size; j++)
+				{
+					id = side->upper[i][j].id;
+					other = enlarge_endpoints(side->extents[id].endpoints[i]);
+					bit_pos = BIT_TO_POS(id);
+					if (other.lower <= ep.upper)
+						BIT_SET(index->line_tmp[bit_pos], DBIT(BIT_POS_IN_VEC(id, bit_pos)));
+				}
+			}
+
+			vector_bitwise_and(out, index->line_tmp, line_width);
+		}
+	}
+}
+
+
+/** \brief Matches an update extent of the index again, writing its row of the result.
+
+\param index the incremental index
+\param id the identifier of the update extent
+*/
+static void index_match_update(const match_index_t *index, const _UINT id)
+{
+	index_overlap(index, &index->subscr, &index->update.extents[id], BITMATRIX_ROW(index->result, id));
+}
+
+
+/** \brief Matches a subscription extent of the index again, writing its column of the result.
+
+\param index the incremental index
+\param id the identifier of the subscription extent
+\param cleared is the column zero (the extent has just been added)? Then only the matching rows are written
+*/
+static void index_match_subscr(const match_index_t *index, const _UINT id, const _BOOL cleared)
+{
+	_UINT i;
+	_UINT bit_pos;
+	_UINT line_pos;
+	bitvec_elem bit;
+
+	index_overlap(index, &index->update, &index->subscr.extents[id], index->line);
+
+	bit_pos = BIT_TO_POS(id);
+	bit = DBIT(BIT_POS_IN_VEC(id, bit_pos));
+
+	// the column crosses every row given so far
+	for (i = 0; i < index->update.used; i++)
+	{
+		line_pos = BIT_TO_POS(i);
+
+		// skip the rows of an element without matches
+		if (cleared && index->line[line_pos] == 0)
+		{
+			i = (line_pos + 1) * BITVEC_ELEM_BITS - 1;
+			continue;
+		}
+
+		if (index->line[line_pos] & DBIT(BIT_POS_IN_VEC(i, line_pos)))
+			BIT_SET(BITMATRIX_ROW(index->result, i)[bit_pos], bit);
+		else if (!cleared)
+			BIT_CLEAR(BITMATRIX_ROW(index->result, i)[bit_pos], bit);
+	}
+}
+
+
+/** \brief Doubles the identifiers of the update or of the subscription extents of the index.
+
+The result is allocated again with the new number of rows or columns, and the old one is copied in it.
+
+\param index the incremental index
+\param side the extents to be enlarged (the update or the subscription extents of the index)
+
+\retval error code
+*/
+static _ERR_CODE index_grow(match_index_t *index, index_extents_t *side)
+{
+	_UINT i;
+	_UINT capacity;
+	_UINT old_width;
+	_UINT line_width;
+	bitmatrix result;
+	_ERR_CODE err;
+
+	capacity = (side->capacity > MAX_EXTENTS / 2) ? MAX_EXTENTS : side->capacity * 2;
+	old_width = BIT_VEC_WIDTH(side->capacity);
+	line_width = BIT_VEC_WIDTH(capacity);
+
+	if ((err = index_resize((void **)&side->recycled, (size_t)capacity * sizeof(_UINT))) != err_none
+		|| (err = index_resize((void **)&side->extents, (size_t)capacity * sizeof(extent_t))) != err_none
+		|| (err = index_resize((void **)&side->live, (size_t)line_width * sizeof(bitvec_elem))) != err_none)
+		return err;
+
+	memset(&side->live[old_width], 0, (line_width - old_width) * sizeof(bitvec_elem));
+
+	for (i = 0; i < index->dimensions; i++)
+	{
+		if ((err = index_resize((void **)&side->lower[i], (size_t)capacity * sizeof(list_t))) != err_none
+			|| (err = index_resize((void **)&side->upper[i], (size_t)capacity * sizeof(list_t))) != err_none)
+			return err;
+	}
+
+	side->capacity = capacity;
+
+	// the lines are as wide as the widest side
+	line_width = BIT_VEC_WIDTH(MAX(index->update.capacity, index->subscr.capacity));
+	if ((err = index_resize((void **)&index->line, (size_t)line_width * sizeof(bitvec_elem))) != err_none
+		|| (err = index_resize((void **)&index->line_tmp, (size_t)line_width * sizeof(bitvec_elem))) != err_none)
+		return err;
+
+	// copy the rows given so far in the new result (the new rows and columns are zero)
+	err = create_bit_matrix(&result, index->update.capacity, index->subscr.capacity);
+	if (err != err_none)
+		return err;
+
+	for (i = 0; i < index->update.used; i++)
+		memcpy(BITMATRIX_ROW(result, i), BITMATRIX_ROW(index->result, i), MIN(result.stride, index->result.stride) * sizeof(bitvec_elem));
+
+	free_bit_matrix(&index->result);
+	index->result = result;
+
+	return err_none;
+}
+
+
+/** \brief Adds an extent to the index, without matching it.
+
+\param index the incremental index
+\param side the extents of the index of the same type
+\param extent the extent
+\param id pointer to the identifier given to the extent
+
+\retval error code
+*/
+static _ERR_CODE index_add(match_index_t *index, index_extents_t *side, const extent_t *extent, _UINT *id)
+{
+	_UINT bit_pos;
+	_ERR_CODE err;
+
+	if ((uint64_t)index->update.size + index->subscr.size >= MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
+	// recycle the identifier of a removed extent, or take a new one
+	if (side->recycled_count > 0)
+		*id = side->recycled[--side->recycled_count];
+	else
+	{
+		if (side->used == side->capacity && (err = index_grow(index, side)) != err_none)
+			return err;
+
+		*id = side->used++;
+	}
+
+	side->extents[*id] = *extent;
+
+	bit_pos = BIT_TO_POS((*id));
+	BIT_SET(side->live[bit_pos], DBIT(BIT_POS_IN_VEC((*id), bit_pos)));
+
+	return index_endpoints(side, index->dimensions, *id, TRUE);
+}
+
+
+/** \brief Removes an extent from the index, without clearing its row or column of the result.
+
+\param index the incremental index
+\param side the extents of the index of the same type
+\param id the identifier of the extent
+
+\retval error code
+*/
+static _ERR_CODE index_remove(match_index_t *index, index_extents_t *side, const _UINT id)
+{
+	_UINT bit_pos;
+	bitvec_elem bit;
+	_ERR_CODE err;
+
+	bit_pos = BIT_TO_POS(id);
+	bit = DBIT(BIT_POS_IN_VEC(id, bit_pos));
+
+	if (id >= side->used || !(side->live[bit_pos] & bit))
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+
+	err = index_endpoints(side, index->dimensions, id, FALSE);
+	if (err != err_none)
+		return err;
+
+	BIT_CLEAR(side->live[bit_pos], bit);
+	side->recycled[side->recycled_count++] = id;
+
+	return err_none;
+}
+
+
+/** \brief Initializes the extents of one type of the incremental index.
+
+\param side the extents
+\param dimensions the number of dimensions
+\param capacity the number of identifiers to be allocated
+
+\retval error code
+*/
+static _ERR_CODE index_extents_init(index_extents_t *side, const _UINT dimensions, const _UINT capacity)
+{
+	_UINT i;
+
+	side->capacity = capacity;
+	side->recycled = (_UINT *)malloc((size_t)capacity * sizeof(_UINT));
+	side->extents = (extent_t *)malloc((size_t)capacity * sizeof(extent_t));
+	side->live = (bitvector)calloc(BIT_VEC_WIDTH(capacity), sizeof(bitvec_elem));
+	if (side->recycled == NULL || side->extents == NULL || side->live == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	for (i = 0; i < dimensions; i++)
+	{
+		side->lower[i] = (list_ptr)malloc((size_t)capacity * sizeof(list_t));
+		side->upper[i] = (list_ptr)malloc((size_t)capacity * sizeof(list_t));
+		if (side->lower[i] == NULL || side->upper[i] == NULL)
+			return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+	}
+
+	return err_none;
+}
+
+
+/** \brief Initializes an empty incremental index.
+
+The identifiers are allocated for the given number of extents of each type, and doubled when they are all used; the identifiers of the removed extents are reused first.
+
+\param index the incremental index
+\param dimensions the number of dimensions
+\param capacity_update the number of update extents expected
+\param capacity_subscr the number of subscription extents expected
+
+\retval error code
+*/
+_ERR_CODE match_index_init(match_index_t *index, const _UINT dimensions, const _UINT capacity_update, const _UINT capacity_subscr)
+{
+	_UINT line_width;
+	_ERR_CODE err;
+
+	if (dimensions < 1)
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+
+	if (dimensions > MAX_DIMENSIONS)
+		return set_error(err_too_many_dim, __FILE__, __FUNCTION__, __LINE__);
+
+	if ((uint64_t)capacity_update + capacity_subscr > MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
+	memset(index, 0, sizeof(match_index_t));
+	index->dimensions = dimensions;
+
+	if ((err = index_extents_init(&index->update, dimensions, MAX(capacity_update, 1))) != err_none
+		|| (err = index_extents_init(&index->subscr, dimensions, MAX(capacity_subscr, 1))) != err_none)
+		return err;
+
+	line_width = BIT_VEC_WIDTH(MAX(index->update.capacity, index->subscr.capacity));
+	index->line = (bitvector)malloc(line_width * sizeof(bitvec_elem));
+	index->line_tmp = (bitvector)malloc(line_width * sizeof(bitvec_elem));
+	if (index->line == NULL || index->line_tmp == NULL)
+		return set_error(err_alloc, __FILE__, __FUNCTION__, __LINE__);
+
+	return create_bit_matrix(&index->result, index->update.capacity, index->subscr.capacity);
+}
+
+
+/** \brief Adds an update extent to the index and matches it.
+
+Only the row of the extent is written: in each dimension the subscription extents that don't overlap it are found by binary search on the sorted endpoints.
+
+\param index the incremental index
+\param extent the update extent
+\param id pointer to the identifier given to the extent (its row of the result)
+
+\retval error code
+*/
+_ERR_CODE match_index_add_update(match_index_t *index, const extent_t *extent, _UINT *id)
+{
+	_ERR_CODE err;
+
+	err = index_add(index, &index->update, extent, id);
+	if (err != err_none)
+		return err;
+
+	index_match_update(index, *id);
+
+	return err_none;
+}
+
+
+/** \brief Removes an update extent from the index.
+
+Its row of the result is cleared and its identifier is given to the next update extent added.
+
+\param index the incremental index
+\param id the identifier of the update extent
+
+\retval error code
+*/
+_ERR_CODE match_index_remove_update(match_index_t *index, const _UINT id)
+{
+	_ERR_CODE err;
+
+	err = index_remove(index, &index->update, id);
+	if (err != err_none)
+		return err;
+
+	memset(BITMATRIX_ROW(index->result, id), 0, BIT_VEC_WIDTH(index->subscr.capacity) * sizeof(bitvec_elem));
+
+	return err_none;
+}
+
+
+/** \brief Adds a subscription extent to the index and matches it.
+
+Only the column of the extent is written: in each dimension the update extents that don't overlap it are found by binary search on the sorted endpoints.
+
+\param index the incremental index
+\param extent the subscription extent
+\param id pointer to the identifier given to the extent (its column of the result)
+
+\retval error code
+*/
+_ERR_CODE match_index_add_subscr(match_index_t *index, const extent_t *extent, _UINT *id)
+{
+	_ERR_CODE err;
+
+	err = index_add(index, &index->subscr, extent, id);
+	if (err != err_none)
+		return err;
+
+	index_match_subscr(index, *id, TRUE);
+
+	return err_none;
+}
+
+
+/** \brief Removes a subscription extent from the index.
+
+Its column of the result is cleared and its identifier is given to the next subscription extent added.
+
+\param index the incremental index
+\param id the identifier of the subscription extent
+
+\retval error code
+*/
+_ERR_CODE match_index_remove_subscr(match_index_t *index, const _UINT id)
+{
+	_UINT i;
+	_UINT bit_pos;
+	bitvec_elem bit;
+	_ERR_CODE err;
+
+	err = index_remove(index, &index->subscr, id);
+	if (err != err_none)
+		return err;
+
+	bit_pos = BIT_TO_POS(id);
+	bit = DBIT(BIT_POS_IN_VEC(id, bit_pos));
+	for (i = 0; i < index->update.used; i++)
+		BIT_CLEAR(BITMATRIX_ROW(index->result, i)[bit_pos], bit);
+
+	return err_none;
+}
+
+
+/** \brief Moves or resizes an extent of the index and matches it again.
+
+The extent keeps its identifier: its endpoints are moved in the sorted lists and only its row or column of the result is written again.
+
+\param index the incremental index
+\param is_update is the extent an update extent (or a subscription extent)?
+\param id the identifier of the extent
+\param extent the new extent
+
+\retval error code
+*/
+_ERR_CODE match_index_modify_extent(match_index_t *index, const _BOOL is_update, const _UINT id, const extent_t *extent)
+{
+	_UINT bit_pos;
+	index_extents_t *side;
+	_ERR_CODE err;
+
+	side = is_update ? &index->update : &index->subscr;
+
+	bit_pos = BIT_TO_POS(id);
+	if (id >= side->used || !(side->live[bit_pos] & DBIT(BIT_POS_IN_VEC(id, bit_pos))))
+		return set_error(err_invalid_input, __FILE__, __FUNCTION__, __LINE__);
+
+	if ((err = index_endpoints(side, index->dimensions, id, FALSE)) != err_none)
+		return err;
+
+	side->extents[id] = *extent;
+	if ((err = index_endpoints(side, index->dimensions, id, TRUE)) != err_none)
+		return err;
+
+	if (is_update)
+		index_match_update(index, id);
+	else
+		index_match_subscr(index, id, FALSE);
+
+	return err_none;
+}
+
+
+/** \brief Frees the extents of one type of the incremental index.
+
+\param side the extents
+\param dimensions the number of dimensions
+*/
+static void index_extents_free(index_extents_t *side, const _UINT dimensions)
+{
+	_UINT i;
+
+	free(side->recycled);
+	free(side->extents);
+	free(side->live);
+	for (i = 0; i < dimensions; i++)
+	{
+		free(side->lower[i]);
+		free(side->upper[i]);
+	}
+}
+
+
+/** \brief Frees the memory of the incremental index.
+
+\param index the incremental index
+*/
+void match_index_free(match_index_t *index)
+{
+	index_extents_free(&index->update, index->dimensions);
+	index_extents_free(&index->subscr, index->dimensions);
+	free(index->line);
+	free(index->line_tmp);
+	if (index->result.base != NULL)
+		free_bit_matrix(&index->result);
+
+	memset(index, 0, sizeof(match_index_t));
 }
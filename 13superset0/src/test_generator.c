@@ -22,6 +22,7 @@
 
 #include "../include/types.h"
 
+#include "../include/utils.h"
 #include "../include/error.h"
 
 #include <stdlib.h>
@@ -35,6 +36,27 @@ This file contains all the functions needed to build test data sets.
 */
 
 
+/** \brief Moves the endpoints of an extent in a dimension.
+
+\param ep pointer to the endpoints to be moved
+*/
+static void move_endpoints(endpoints_t *ep)
+{
+	SPACE_TYPE shift;
+
+	shift = (SPACE_TYPE)((((double)ep->upper - ep->lower) / MOVE_FRACTION) * (2 * ((double)rand() / RAND_MAX) - 1));
+
+	// don't move the extent outside the space (the checks are written so that they can't overflow)
+	if (shift < 0 && ep->lower < SPACE_TYPE_MIN - shift)
+		shift = SPACE_TYPE_MIN - ep->lower;
+	if (shift > 0 && ep->upper > SPACE_TYPE_MAX - shift)
+		shift = SPACE_TYPE_MAX - ep->upper;
+
+	ep->lower += shift;
+	ep->upper += shift;
+}
+
+
 /** \brief Generates a data set.
 
 \param out pointer to the structure that is going to store the data set
@@ -54,6 +76,9 @@ _ERR_CODE test_generator(match_data_t *out, const _UINT updates, const _UINT sub
 	if (dimensions > MAX_DIMENSIONS)
 		return set_error(err_too_many_dim, __FILE__, __FUNCTION__, __LINE__);
 
+	if ((uint64_t)updates + subscrs > MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
 	// set the number of dimensions
 	out->dimensions = dimensions;
 
@@ -125,8 +150,15 @@ _ERR_CODE test_generator_random(match_data_t *out, const _UINT updates, const _U
 	if (dimensions > MAX_DIMENSIONS)
 		return set_error(err_too_many_dim, __FILE__, __FUNCTION__, __LINE__);
 
+	if ((uint64_t)updates + subscrs > MAX_EXTENTS)
+		return set_error(err_too_many_ext, __FILE__, __FUNCTION__, __LINE__);
+
+	// a seed given by the options generates the same data set at each run
+	if (OPT_VAR.seed > 0)
+		srand(OPT_VAR.seed);
 #ifdef __TRUERAND
-	srand((unsigned int)time(NULL));
+	else
+		srand((unsigned int)time(NULL));
 #endif // __TRUERAND
 
 	// set the number of dimensions
@@ -170,3 +202,51 @@ _ERR_CODE test_generator_random(match_data_t *out, const _UINT updates, const _U
 
 	return err_none;
 }
+
+
+/** \brief Moves the extents of a data set.
+
+Each extent is shifted in every dimension by a random amount of at most 1/MOVE_FRACTION of its width, keeping its width and staying inside the space. It's used to simulate the movement of the extents between two ticks of the persistent matching.
+
+\param data pointer to the data set to be modified
+
+\retval error code
+*/
+_ERR_CODE test_generator_move(match_data_t *data)
+{
+	_UINT i, j;
+
+	// for each dimension
+	for (i = 0; i < data->dimensions; i++)
+	{
+		// for each update extent
+		for (j = 0; j < data->size_update; j++)
+			move_endpoints(&data->update[j].endpoints[i]);
+
+		// for each subscription extent
+		for (j = 0; j < data->size_subscr; j++)
+			move_endpoints(&data->subscr[j].endpoints[i]);
+	}
+
+	return err_none;
+}
+
+
+/** \brief Moves an extent.
+
+The extent is shifted in every dimension like in test_generator_move(). It's used to simulate the change of a single extent in the incremental matching.
+
+\param extent pointer to the extent to be moved
+\param dimensions number of dimensions of the problem
+
+\retval error code
+*/
+_ERR_CODE test_generator_move_extent(extent_t *extent, const _UINT dimensions)
+{
+	_UINT i;
+
+	for (i = 0; i < dimensions; i++)
+		move_endpoints(&extent->endpoints[i]);
+
+	return err_none;
+}
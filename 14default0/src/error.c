@@ -47,7 +47,8 @@ static const char *err_strings[] =
 	"An error occurred while handling threads",
 	"An error occurred in one of the OpenCL routines",
 	TOSTR(No platform/device from VIDEO_CARD_VENDOR found),
-	"An error occurred while processing the file containing the OpenCL program"
+	"An error occurred while processing the file containing the OpenCL program",
+	TOSTR(The problem cant have more than MAX_EXTENTS extents)
 };
 
 
@@ -24,6 +24,7 @@
 #define __TYPES_H
 
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "defines.h"
@@ -82,7 +83,11 @@ This file contains all the data types definitions. The simple types are to avoid
 
 /** \brief An element of the bit vector used for storing the matches.
 */
+#if BITVEC_ELEM_BITS == 64
+typedef uint64_t		bitvec_elem;
+#else // BITVEC_ELEM_BITS
 typedef uint32_t		bitvec_elem;
+#endif // BITVEC_ELEM_BITS
 
 
 /** \brief The bit vector used for storing the matches.
@@ -94,9 +99,58 @@ typedef bitvec_elem*	bitvector;
 
 /** \brief The bit matrix used for storing the matches.
 
-The lines of the bit matrix correspond to the update extents, while the single bits on each line represent the subscription extents.
+The lines of the bit matrix correspond to the update extents, while the single bits on each line represent the subscription extents. The rows are stored in a single block, each one stride elements after the previous one, so that a row is reached without loading a pointer; the rows are aligned to BITMATRIX_ALIGNMENT bytes and the stride is padded to avoid BITMATRIX_ALIAS_STRIDE.
 */
-typedef bitvector*		bitmatrix;
+typedef struct
+{
+	bitvector	base;				///< first element of the first row
+	_UINT		rows;				///< number of rows
+	_UINT		width;				///< number of elements of each row holding bits (BIT_VEC_WIDTH() of the columns)
+	_UINT		stride;				///< number of elements between the starts of two consecutive rows
+	_UINT		alignment;			///< alignment of the rows in bytes
+} bitmatrix;
+
+
+/** \brief Upper triangle of a square bit matrix in packed storage, for the result of the self-matching.
+
+The row i holds the columns from the element of the column i to the end of the row, so it's BIT_TO_POS(i) elements shorter than a full row, and the rows are packed one after the other. The columns of the row before its element are found on the rows before it, since the matrix is symmetric.
+*/
+typedef struct
+{
+	bitvector	base;				///< pointer to the first row
+	_UINT		rows;				///< number of rows (and columns)
+	_UINT		width;				///< number of elements of a full row (BIT_VEC_WIDTH() of the columns)
+} bitmatrix_tri_t;
+
+
+/** \brief Occupancy summary of a bit matrix.
+
+Each row is split in blocks of BITMATRIX_SUMMARY_ELEMS elements: a block whose elements are all zero or all ones is decided, so the passes on the matrix can skip it. A row is empty when it can't have matches anymore, that is when all its blocks are zero (or all ones while the matrix holds the non-matching subscription extents).
+*/
+typedef struct
+{
+	_UINT		rows;				///< number of rows of the matrix
+	_UINT		blocks;				///< number of blocks of each row
+	bitvector	zero;				///< one bit for each block (row after row): all the elements are zero
+	bitvector	one;				///< one bit for each block (row after row): all the elements are all ones
+	bitvector	empty;				///< one bit for each row: the row has no matches
+} bitmatrix_summary_t;
+
+
+/** \brief Header of the backing file of an out-of-core result matrix.
+
+The header is kept in the first STORE_HEADER_SIZE bytes of the file, before the rows. It records the problem and the bands of rows already complete, so that an interrupted matching can be resumed from the first band not complete.
+*/
+typedef struct
+{
+	uint32_t	magic;				///< STORE_MAGIC if the header is valid
+	_UINT		size_update;		///< number of update extents (rows)
+	_UINT		size_subscr;		///< number of subscription extents (columns)
+	_UINT		dimensions;			///< number of dimensions
+	_UINT		band;				///< number of rows of a band
+	_UINT		bands_done;			///< number of bands complete, from the first one
+	uint64_t	fingerprint;		///< fingerprint of the data set
+} store_header_t;
 
 
 /** \brief The endpoints of an extent in a given dimension.
@@ -138,6 +192,8 @@ typedef struct
 /** \brief An element of the list of endpoints.
 
 The identifier goes from 0 to size_subscr - 1 for subscriptions and from size_subscr to size_subscr + size_update - 1 for updates.
+
+\remarks The identifiers are kept on 32 bits, so that an endpoint still takes 16 bytes at most for the sort; the data sets are limited to MAX_EXTENTS extents accordingly.
 */
 typedef struct
 {
@@ -152,6 +208,247 @@ typedef struct
 typedef list_t* list_ptr;
 
 
+/** \brief The matching pairs stored as compressed sparse rows.
+
+The subscription extents matching the update extent i are subscr[first[i]] ... subscr[first[i + 1] - 1].
+*/
+typedef struct
+{
+	_UINT		size_update;		///< number of update extents (rows)
+	size_t		count;				///< number of matching pairs
+	size_t		*first;				///< position in subscr of the first match of each update extent (size_update + 1 elements)
+	_UINT		*subscr;			///< identifiers of the matching subscription extents, row after row
+} match_csr_t;
+
+
+/** \brief Iterator on the matching subscription extents of an update extent.
+
+The subscription extents are visited in ascending order, one set bit of the row at a time.
+*/
+typedef struct
+{
+	bitvector	line;				///< row of the update extent
+	_UINT		size_subscr;		///< number of subscription extents (columns of the row)
+	_UINT		last;				///< one past the last element of the row holding columns
+	_UINT		elem;				///< element of the row holding the bits of val
+	bitvec_elem	val;				///< bits of the element not visited yet
+} match_iter_t;
+
+
+/** \brief Enum for the kinds of containers of the compressed result.
+*/
+typedef enum
+{
+	container_array				= 0,
+	container_run				= 1,
+	container_bitmap			= 2
+} container_t;
+
+
+/** \brief A container of the compressed result: the matches of an update extent in a chunk of SPARSE_CHUNK_BITS subscription extents.
+
+An array container holds the sorted low bits of the identifiers, a run container holds pairs of (first, length - 1) low bits, a bitmap container holds the elements of the chunk of the line of the bit matrix.
+*/
+typedef struct
+{
+	_UINT		chunk;				///< number of the chunk (the high bits of the identifiers)
+	container_t	kind;				///< kind of container
+	_UINT		cardinality;		///< number of matching subscription extents in the container
+	_UINT		size;				///< number of values (array), of words (run, two for each run) or of elements (bitmap)
+	size_t		offset;				///< position of the content in words (array, run) or in bitmaps (bitmap)
+} match_container_t;
+
+
+/** \brief The matching pairs stored as compressed sparse rows of containers (Roaring-style).
+
+The containers of the update extent i are containers[first[i]] ... containers[first[i + 1] - 1], sorted by chunk; the chunks without matches have no container. Each container picks the smallest of the three representations, so the memory used depends on the number of matches and on how they are clustered, not on the size of the bit matrix.
+*/
+typedef struct
+{
+	_UINT				size_update;			///< number of update extents (rows)
+	_UINT				size_subscr;			///< number of subscription extents (columns)
+	size_t				count;					///< number of matching pairs
+	size_t				*first;					///< position in containers of the first container of each update extent (size_update + 1 elements)
+	match_container_t	*containers;			///< containers, row after row
+	size_t				containers_count;		///< number of containers
+	size_t				containers_capacity;	///< number of allocated containers
+	uint16_t			*words;					///< content of the array and run containers
+	size_t				words_count;			///< number of words used
+	size_t				words_capacity;			///< number of allocated words
+	bitvector			bitmaps;				///< content of the bitmap containers
+	size_t				bitmaps_count;			///< number of elements used
+	size_t				bitmaps_capacity;		///< number of allocated elements
+} match_sparse_t;
+
+
+/** \brief Checkpointed result of the one-dimensional matching.
+
+Instead of writing the line of each update extent during the sweep, the sweep records how many subscription endpoints precede each endpoint of the update extents (the event position) and saves a snapshot of the "before" and "after" sets every interval subscription endpoints. The line of an update extent is then built when needed from the snapshots nearest to its two event positions and a replay of at most interval subscription endpoints each.
+*/
+typedef struct
+{
+	_UINT		size_update;		///< number of update extents
+	_UINT		size_subscr;		///< number of subscription extents
+	_UINT		interval;			///< number of subscription endpoints between two snapshots
+	_UINT		*event_subscr;		///< subscription extent of each subscription endpoint, in sorted order
+	_BOOL		*event_lower;		///< is each subscription endpoint a lower bound point?
+	_UINT		*subscr_upper;		///< event position of the upper endpoint of each subscription extent
+	_UINT		*update_lower;		///< event position of the lower endpoint of each update extent
+	_UINT		*update_upper;		///< event position of the upper endpoint of each update extent
+	bitvector	before;				///< snapshots of the "before" set, one line every interval events
+	bitvector	after;				///< snapshots of the "after" set, one line every interval events
+} lazy_rows_t;
+
+
+/** \brief State of the persistent matching.
+
+The sorted endpoints lists and the non-matching bit matrices of each dimension are kept between calls, so that the extents can be matched again after a small movement by only re-sorting the lists.
+*/
+typedef struct
+{
+	_UINT		dimensions;							///< number of dimensions
+	_UINT		size_update;						///< number of update extents
+	_UINT		size_subscr;						///< number of subscription extents
+	list_ptr	ep_list[MAX_DIMENSIONS];			///< sorted endpoints list of each dimension
+	bitmatrix	result[MAX_DIMENSIONS];				///< non-matching bit matrix of each dimension
+} persistent_state_t;
+
+
+/** \brief Extents of one type (update or subscription) in the incremental index.
+
+The identifiers of the removed extents are recycled before new ones are used, so the rows and the columns of the result are reused.
+*/
+typedef struct
+{
+	_UINT		size;								///< number of extents in the index
+	_UINT		capacity;							///< number of identifiers allocated
+	_UINT		used;								///< number of identifiers given at least once
+	_UINT		recycled_count;						///< number of recycled identifiers
+	_UINT		*recycled;							///< identifiers of the removed extents, reused last in first out
+	extent_t	*extents;							///< extent of each identifier
+	bitvector	live;								///< identifiers of the extents in the index
+	list_ptr	lower[MAX_DIMENSIONS];				///< lower endpoints of the extents in each dimension, sorted by position
+	list_ptr	upper[MAX_DIMENSIONS];				///< upper endpoints of the extents in each dimension, sorted by position
+} index_extents_t;
+
+
+/** \brief Incremental matching index.
+
+The sorted endpoints of every dimension and the result are kept, so that adding, removing or changing an extent updates only its row (update extent) or its column (subscription extent) of the result.
+*/
+typedef struct
+{
+	_UINT			dimensions;						///< number of dimensions
+	index_extents_t	update;							///< update extents (rows of the result)
+	index_extents_t	subscr;							///< subscription extents (columns of the result)
+	bitvector		line;							///< extents overlapping the changed one
+	bitvector		line_tmp;						///< extents overlapping the changed one in a dimension
+	bitmatrix		result;							///< result bit matrix, capacity of the update extents by capacity of the subscription extents
+} match_index_t;
+
+
+/** \brief Matching context.
+
+All the buffers of the matching are carved from a single arena, which is kept between calls and enlarged only when a bigger problem is matched, so that repeated matchings don't allocate memory.
+
+\remarks Only the standard and the tiled sweeps are free of allocations: the checkpointed sweep still allocates its snapshots at each dimension of each matching.
+*/
+typedef struct
+{
+	void		*arena;				///< memory block containing all the buffers
+	size_t		arena_size;			///< size of the arena in bytes
+	_UINT		size_update;		///< number of update extents of the current layout of the buffers
+	_UINT		size_subscr;		///< number of subscription extents of the current layout of the buffers
+	_UINT		dimensions;			///< number of dimensions of the current layout of the buffers
+	list_ptr	ep_list;			///< endpoints list
+	list_ptr	ep_scratch;			///< scratch list of the radix sort of the endpoints list
+	bitvector	subscr_set_before;	///< set of the "before" subscriptions
+	bitvector	subscr_set_after;	///< set of the "after" subscriptions
+	bitmatrix	result;				///< result bit matrix
+	bitmatrix	result_tmp;			///< bit matrix of the single dimensions results (base NULL if not needed)
+	bitmatrix_summary_t	summary;	///< occupancy summary of the result (up to date only with the summary option)
+} match_context_t;
+
+
+/** \brief Enum for the algorithms used to sort the list of endpoints.
+*/
+typedef enum
+{
+	sort_qsort					= 0,
+	sort_radix					= 1
+} sort_algo_t;
+
+
+/** \brief Enum for the instruction sets of the bitwise kernels.
+*/
+typedef enum
+{
+	simd_auto					= 0,
+	simd_scalar					= 1,
+	simd_sse2					= 2,
+	simd_avx2					= 3,
+	simd_avx512					= 4
+} simd_t;
+
+
+/** \brief Enum for the matching engines.
+*/
+typedef enum
+{
+	engine_matrix				= 0,
+	engine_pairs				= 1,
+	engine_sparse				= 2
+} engine_t;
+
+
+/** \brief Enum for the pages of the big allocations.
+*/
+typedef enum
+{
+	pages_default				= 0,
+	pages_thp					= 1,
+	pages_huge					= 2
+} pages_t;
+
+
+/** \brief Enum for the NUMA placement of the big allocations.
+*/
+typedef enum
+{
+	numa_default				= 0,
+	numa_interleave				= 1
+} numa_t;
+
+
+/** \brief Structure containing the run-time options.
+
+The options are set once by the main function and read by the algorithm.
+*/
+typedef struct
+{
+	sort_algo_t	sort_algo;			///< algorithm used to sort the list of endpoints
+	engine_t	engine;				///< matching engine (bit matrix, list of matching pairs or compressed rows)
+	_BOOL		fold_not;			///< fold the NOT of the first dimension into the combine pass of the second one
+	_BOOL		summary;			///< keep the occupancy summary of the result to skip the decided blocks and rows
+	_BOOL		transpose;			///< also build the subscription-major matrix of the result
+	_BOOL		csr;				///< also export the result as compressed sparse rows
+	simd_t		simd;				///< instruction set of the bitwise kernels (simd_auto for the best one supported by the processor)
+	_UINT		tile;				///< subscription extents in a tile of the tiled sweep, multiple of BITVEC_LANE_BITS (0 for the standard sweep)
+	_UINT		checkpoint;			///< subscription endpoints between two snapshots of the checkpointed sweep (0 for the standard sweep)
+	_UINT		ticks;				///< number of times the extents are moved and matched again in persistent mode (0 for a single matching)
+	pages_t		pages;				///< pages of the big allocations (default, transparent huge pages or explicit huge pages)
+	_BOOL		prefault;			///< touch all the pages of the big allocations when they are allocated
+	numa_t		numa;				///< NUMA placement of the big allocations
+	const char	*store;				///< backing file of the out-of-core result matrix (NULL to keep the result in memory)
+	_UINT		band;				///< number of rows of a band of the out-of-core matching (0 for STORE_BAND_SIZE bytes of rows)
+	_BOOL		resume;				///< resume the out-of-core matching after the last band complete in the backing file
+	_BOOL		self;				///< match the update extents against themselves, on the upper triangle of the result
+	_UINT		changes;			///< number of extents changed one at a time in the incremental index (0 for a single matching)
+	_UINT		removes;			///< number of extents of each type removed from the incremental index and added back (0 for none)
+	_UINT		seed;				///< seed of the random data set (0 for the default one)
+} _opt_t;
+
+
 /** \brief Enum for error codes.
 */
 typedef enum 
@@ -166,7 +463,8 @@ typedef enum
 	err_threads					= 7,
 	err_opencl					= 8,
 	err_opencl_device_not_found	= 9,
-	err_opencl_file				= 10
+	err_opencl_file				= 10,
+	err_too_many_ext			= 11
 } _ERR_CODE;
 
 
@@ -2,26 +2,70 @@
 
 DEFAULT=correctness_default
 LOWMEM=correctness_lowmem
+THREAD=correctness_thread
 
 DEFOUT=correctness_default.out
-LOWOUT=correctness_lowmem.out
+ALTOUT=correctness_alternative.out
 
 SIZE=10000
 DIM=3
+# the same data set for every run
+SEED=1
+
+# alternative paths of the default build, which must give the same solution
+# (the incremental index removes extents and adds them back, with their identifiers)
+OPTIONS=("--sort=qsort" "--fold-not" "--summary" "--tile=256" "--checkpoint=1000" "--simd=scalar" "--simd=sse2" "--simd=avx2" "--simd=avx512"
+	"--removes=100")
+
+# splits of the sweep of the threaded build, each one with a few numbers of threads (more or less than the dimensions)
+SWEEPS=("dimensions" "columns" "segments" "tasks")
+THREADS=(1 2 3 8)
+
+DIFFERENT=0
+
+# compares the solution of a run with the default one (the arguments are the build and its options)
+compare()
+{
+	./$1 $SIZE $SIZE $DIM --seed=$SEED ${@:2} > $ALTOUT || exit 1
+
+	if diff -q $DEFOUT $ALTOUT > /dev/null; then
+		echo "$*": the solutions are identical.
+	else
+		echo "$*": the solutions are different.
+		DIFFERENT=1
+	fi
+
+	rm -f $ALTOUT
+}
 
 echo Removing previous files...
-rm -f $DEFOUT $LOWOUT
+rm -f $DEFOUT $ALTOUT
 echo done.
 echo Checking correctness...
 
-./$DEFAULT $SIZE $SIZE $DIM > $DEFOUT && ./$LOWMEM $SIZE $SIZE $DIM > $LOWOUT && DIFFCOUNT=$(diff $DEFOUT $LOWOUT | wc -c) && rm $DEFOUT $LOWOUT &&
+./$DEFAULT $SIZE $SIZE $DIM --seed=$SEED > $DEFOUT || exit 1
 
-if [ $DIFFCOUNT -eq 0 ]; then
+compare $LOWMEM
+
+for OPTION in "${OPTIONS[@]}"
+do
+	compare $DEFAULT $OPTION
+done
+
+for SWEEP in "${SWEEPS[@]}"
+do
+	for COUNT in "${THREADS[@]}"
+	do
+		compare $THREAD --sweep=$SWEEP --threads=$COUNT
+	done
+done
+
+rm -f $DEFOUT
+
+if [ $DIFFERENT -eq 0 ]; then
 	echo The solutions are identical.
 	exit 0
 else
 	echo The solutions are different.
-	exit 0
-fi 
-
-exit 1
+	exit 1
+fi
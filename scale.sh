@@ -0,0 +1,26 @@
+#!/bin/bash
+
+# sizes past the memory: the result is kept in a file mapped in bands (about N * N / 8 bytes of disk)
+FILE=lowbig
+DIM=3
+TIMES=1
+STORE=$FILE.bin
+
+echo Starting test $FILE beyond the memory:
+
+for SIZE in 500000 750000 1000000
+do
+	echo $SIZE updates and $SIZE subscriptions: $TIMES iterations...
+	for ((i=1; i <= TIMES; i++))
+	do
+		echo -ne "\riteration ${i}...\033[0K"
+		./$FILE $SIZE $SIZE $DIM --store=$STORE
+	done
+
+	rm -f $STORE
+	echo -e "\rdone.\033[0K"
+done
+
+echo Test $FILE beyond the memory completed.
+
+exit 0